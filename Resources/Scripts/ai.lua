@@ -12,10 +12,45 @@ All StateMachines must have a "default" state.  This is their initial state.
 States transition by returning a string of the new State's name.
 States that do not return new state names will stay in the same state.
 
+An AI does not run its State on every tick.  ThinkIntervals sets the number of
+ticks between runs for each State name; States that are not listed run on every
+tick.  A State may also return a second value, the ticks until it should run
+again, which overrides ThinkIntervals once.  In between, the ship keeps
+accelerating if it accelerated and finishes the last turn it asked for.
+Ships that are under attack or near the player run on every tick regardless.
+
+A StateMachine may also have a Batch table of states:
+
+StateMachine.Batch = {
+	State = function(id,x,y,angle,speed,vector,cmd) ... end,
+	...
+}
+
+The engine runs the Batch version of a State for every ship of the
+StateMachine that is due, with one call to AIBatch per tick.  Rather than
+calling back into the engine through Epiar.getSprite(id), a Batch state fills
+in cmd: cmd.rotate (degrees, like Ship:Rotate), cmd.accelerate (after
+rotating), cmd.fire (AI_FIRE_PRIMARY and AI_FIRE_SECONDARY added together)
+and cmd.target.  It returns the new State and interval like any other State.
+Each Batch state must also be a normal State, usually Unbatched(...) of itself,
+which is used when "options/simulation/ai-batch" is off.
+
 --]]
 
 AIData = {}
 
+AI_FIRE_PRIMARY = 1
+AI_FIRE_SECONDARY = 2
+
+ThinkIntervals = {
+	Travelling = 8,
+	GateTravelling = 4,
+	Orbiting = 8,
+	TooClose = 4,
+	TooFar = 4,
+	Docking = 4,
+}
+
 function FindADestination(id,x,y,angle,speed,vector)
 	-- Choose a planet
 	local cur_ship = Epiar.getSprite(id)
@@ -31,6 +66,64 @@ function FindADestination(id,x,y,angle,speed,vector)
 	return "Travelling"
 end
 
+-- The turn, in degrees, that points a ship at x,y facing angle towards tx,ty.
+-- This is Ship:directionTowards(tx,ty) without asking the engine.
+function directionTowards(x,y,angle,tx,ty)
+	local turn = math.deg( math.atan2( y - ty, tx - x ) ) - angle
+	turn = turn - math.floor( turn / 360 ) * 360
+	if turn > 180 then turn = turn - 360 end
+	return turn
+end
+
+-- Planets and Gates do not move, so their positions are only looked up once.
+local staticPositions = {}
+function staticPosition(id)
+	if id == nil then return nil end
+	local pos = staticPositions[id]
+	if pos == nil then
+		local sprite = Epiar.getSprite(id)
+		if sprite == nil then return nil end
+		pos = { sprite:GetPosition() }
+		staticPositions[id] = pos
+	end
+	return pos[1], pos[2]
+end
+
+-- Runs the Batch states of the ships of one StateMachine that are due.
+-- ships holds 7 values per ship: id, x, y, angle, speed, vector and State.
+-- commands gets 6 values per ship: accelerate, rotate, fire, target, the new
+-- State (or false) and the interval.  Both arrays are reused between calls.
+function AIBatch(machine, ships, count, commands)
+	local batch = machine.Batch
+	local cmd = {}
+	for i = 0, count - 1 do
+		local s = i * 7
+		local c = i * 6
+		cmd.accelerate, cmd.rotate, cmd.fire, cmd.target = false, 0, 0, -1
+		local newState, interval = batch[ ships[s+7] ](ships[s+1], ships[s+2], ships[s+3], ships[s+4], ships[s+5], ships[s+6], cmd)
+		commands[c+1] = cmd.accelerate
+		commands[c+2] = cmd.rotate
+		commands[c+3] = cmd.fire
+		commands[c+4] = cmd.target
+		commands[c+5] = newState or false
+		commands[c+6] = interval or 0
+	end
+end
+
+-- Makes a normal State out of a Batch state, carrying out its cmd right away.
+function Unbatched(batchState)
+	return function(id,x,y,angle,speed,vector)
+		local cmd = { accelerate = false, rotate = 0, fire = 0, target = -1 }
+		local newState, interval = batchState(id,x,y,angle,speed,vector,cmd)
+		local cur_ship = Epiar.getSprite(id)
+		if cmd.rotate ~= 0 then cur_ship:Rotate( cmd.rotate ) end
+		if cmd.accelerate then cur_ship:Accelerate() end
+		if cmd.fire % 2 == 1 then cur_ship:FirePrimary( cmd.target ) end
+		if cmd.fire >= AI_FIRE_SECONDARY then cur_ship:FireSecondary( cmd.target ) end
+		return newState, interval
+	end
+end
+
 function okayTarget(cur_ship, ship)
 	-- if friendly (merciful) mode is on and the nearest target is the player, forbid this target
 	if PLAYER ~= nil and PLAYER:GetID() == ship:GetID() then
@@ -84,6 +177,56 @@ function setHuntHostile(id, tid)
 	end
 end
 
+--- Batch states shared by the State Machines
+BatchStates = {
+	TraderTravelling = function(id,x,y,angle,speed,vector,cmd)
+		if AIData[id].hostile == 1 then return "Hunting" end
+		-- Get to the planet
+		local px,py = staticPosition( AIData[id].destination )
+		if px == nil then return "New_Planet" end
+		cmd.rotate = directionTowards(x,y,angle,px,py)
+		cmd.accelerate = true
+		local dist = distfrom(px,py,x,y)
+		if dist < 800 then
+			return "New_Planet"
+		end
+		-- Far from the planet there is little to decide
+		if dist > 8000 then
+			return "Travelling", 25
+		end
+	end,
+	PatrolTravelling = function(id,x,y,angle,speed,vector,cmd)
+		if AIData[id].hostile == 1 then return "Hunting" end
+		local px,py = staticPosition( AIData[id].destination )
+		if px == nil then return "default" end
+		cmd.rotate = directionTowards(x,y,angle,px,py)
+		cmd.accelerate = true
+		if distfrom(px,py,x,y) < 1000 then
+			return "Orbiting"
+		end
+	end,
+	PatrolTooClose = function(id,x,y,angle,speed,vector,cmd)
+		if AIData[id].hostile == 1 then return "Hunting" end
+		local px,py = staticPosition( AIData[id].destination )
+		if px == nil then return "default" end
+		cmd.rotate = - directionTowards(x,y,angle,px,py)
+		cmd.accelerate = true
+		if distfrom(px,py,x,y) > 800 then
+			return "Orbiting"
+		end
+	end,
+	PatrolTooFar = function(id,x,y,angle,speed,vector,cmd)
+		if AIData[id].hostile == 1 then return "Hunting" end
+		local px,py = staticPosition( AIData[id].destination )
+		if px == nil then return "default" end
+		cmd.rotate = directionTowards(x,y,angle,px,py)
+		cmd.accelerate = true
+		if distfrom(px,py,x,y) < 1300 then
+			return "Orbiting"
+		end
+	end,
+}
+
 -- Gate Traveler AI to be used by others
 GateTraveler = {
 	default = function(id,x,y,angle,speed,vector)
@@ -96,16 +239,12 @@ GateTraveler = {
 		if AIData[id].Autopilot == nil then
 			AIData[id].Autopilot = APInit( "AI", id )
 		end
-		if AIData[id].Autopilot.spcr == nil then
-			AIData[id].Autopilot:compute( AIData[id].destinationName )
-		else
-			local finished = AIData[id].Autopilot.spcrTick()
-			if finished then 
-				return "GateTravelling"
-			else
-				return "ComputingRoute"
-			end
+		if AIData[id].Autopilot:compute( AIData[id].destinationName ) then
+			return "GateTravelling"
 		end
+		-- There is no such destination, so pick another one
+		AIData[id].destinationName = nil
+		return "New_Planet"
 	end,
 	GateTravelling = function(id,x,y,angle,speed,vector)
 		local cur_ship = Epiar.getSprite(id)
@@ -262,20 +401,7 @@ Trader = {
 	end,
 	ComputingRoute = GateTraveler.ComputingRoute,
 	GateTravelling = GateTraveler.GateTravelling,
-	Travelling = function(id,x,y,angle,speed,vector)
-		if AIData[id].hostile == 1 then return "Hunting" end
-		-- Get to the planet
-		local cur_ship = Epiar.getSprite(id)
-
-		local p = Epiar.getSprite( AIData[id].destination )
-		if p == nil then return "New_Planet" end
-		local px,py = p:GetPosition()
-		cur_ship:Rotate( cur_ship:directionTowards(px,py) )
-		cur_ship:Accelerate()
-		if distfrom(px,py,x,y) < 800 then
-			return "New_Planet"
-		end
-	end,
+	Travelling = Unbatched(BatchStates.TraderTravelling),
 	New_Planet = FindADestination,
 	default = function(id,x,y,angle,speed,vector,state)
 		if AIData[id] == nil then AIData[id] = { } end
@@ -292,6 +418,9 @@ Trader = {
 
 		return "New_Planet"
 	end,
+	Batch = {
+		Travelling = BatchStates.TraderTravelling,
+	},
 }
 
 Patrol = {
@@ -310,18 +439,7 @@ Patrol = {
 	Killing = Hunter.Killing,
 	ComputingRoute = GateTraveler.ComputingRoute,
 	GateTravelling = GateTraveler.GateTravelling,
-	Travelling = function(id,x,y,angle,speed,vector)
-		if AIData[id].hostile == 1 then return "Hunting" end
-		local cur_ship = Epiar.getSprite(id)
-		local p = Epiar.getSprite( AIData[id].destination )
-		if p == nil then return "default" end
-		local px,py = p:GetPosition()
-		cur_ship:Rotate( cur_ship:directionTowards(px,py) )
-		cur_ship:Accelerate()
-		if distfrom(px,py,x,y) < 1000 then
-			return "Orbiting"
-		end
-	end,
+	Travelling = Unbatched(BatchStates.PatrolTravelling),
 	Orbiting = function(id,x,y,angle,speed,vector)
 		if AIData[id].hostile == 1 then return "Hunting" end
 		local cur_ship = Epiar.getSprite(id)
@@ -354,28 +472,13 @@ Patrol = {
 			end
 		end
 	end,
-	TooClose = function(id,x,y,angle,speed,vector)
-		if AIData[id].hostile == 1 then return "Hunting" end
-		local cur_ship = Epiar.getSprite(id)
-		local p = Epiar.getSprite( AIData[id].destination )
-		local px,py = p:GetPosition()
-		cur_ship:Rotate( - cur_ship:directionTowards(px,py) )
-		cur_ship:Accelerate()
-		if distfrom(px,py,x,y) > 800 then
-			return "Orbiting"
-		end
-	end,
-	TooFar = function(id,x,y,angle,speed,vector)
-		if AIData[id].hostile == 1 then return "Hunting" end
-		local cur_ship = Epiar.getSprite(id)
-		local p = Epiar.getSprite( AIData[id].destination )
-		local px,py = p:GetPosition()
-		cur_ship:Rotate( cur_ship:directionTowards(px,py) )
-		cur_ship:Accelerate()
-		if distfrom(px,py,x,y) < 1300 then
-			return "Orbiting"
-		end
-	end,
+	TooClose = Unbatched(BatchStates.PatrolTooClose),
+	TooFar = Unbatched(BatchStates.PatrolTooFar),
+	Batch = {
+		Travelling = BatchStates.PatrolTravelling,
+		TooClose = BatchStates.PatrolTooClose,
+		TooFar = BatchStates.PatrolTooFar,
+	},
 }
 
 
@@ -389,6 +492,7 @@ Bully = {
 	TooFar = Patrol.TooFar,
 	Hunting = Hunter.Hunting,
 	Killing = Hunter.Killing,
+	Batch = Patrol.Batch,
 
 	Orbiting = function(id,x,y,angle,speed,vector)
 		if AIData[id].hostile == 1 then return "Hunting" end
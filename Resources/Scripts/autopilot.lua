@@ -12,9 +12,8 @@
 --     - Increase OO-ishness and make generic enough for AIs to use (finished?)
 --
 --     - Use coroutines for calculateSpatialDistances() and/or shortestPath() to smooth it
---       out across multiple ticks rather than hogging the processor (especially important if
---       AIs will be using it). This may be a bit tricky, since they access and edit some
---       shared data, but not as bad as threading.
+--       out across multiple ticks rather than hogging the processor (done: routes are now
+--       planned by the engine with Epiar.route(), which is quick enough for AIs to use)
 --
 --     - Modularize / make autoAngle() mimic a state machine
 --
@@ -35,11 +34,6 @@ Autopilot = nil		-- this is the player's autopilot (volatile)
 -- but you're allowed to call it again if you really want to! (For example, if the universe changes.)
 function APHardInit()
 	APPersistent = { }
-	APPersistent.Objects = { }
-	APPersistent.numObjectsVal = 0
-	APPersistent.numObjects = function() return APPersistent.numObjectsVal end
-	APPersistent.numObjectsIncr = function() APPersistent.numObjectsVal = APPersistent.numObjectsVal + 1 end
-	APPersistent.SpatialDistStatic = { }
 	APPersistent.gateInfoCache = { }
 	APPersistent.planetInfoCache = { }
 end
@@ -52,26 +46,17 @@ function APInit( _name, _id )
 		return nil
 	end
 	local self = {
-		numObjects	= APFuncs.numObjects,
-		spatialDistance	= APFuncs.spatialDistance, 
 		showGateRoute	= APFuncs.showGateRoute, 
-		graphEdge	= APFuncs.graphEdge, 
 		hasAutopilot	= APFuncs.hasAutopilot, 
 		showAlert	= APFuncs.showAlert,
-		shortestPath	= APFuncs.shortestPath,
-		calculateSpatialDistances
-				= APFuncs.calculateSpatialDistances,
 		compute		= APFuncs.compute,
 		autoAngle	= APFuncs.autoAngle
 	}
-	self.SpatialDistDynamic = { }
 	self.GateRoute = { }
 	self.control = false
 	self.AllowAccel = false
 	self.name = _name
 	self.id = _id
-	self.spcr = nil -- shortestPath() coroutine
-	self.spcrConclude = nil
 	return self
 end
 
@@ -79,16 +64,6 @@ end
 -- Begin OO functions --
 ------------------------
 
--- Grab object count from persistent data, but include this instance in the total
-APFuncs.numObjects = function(self) return APPersistent.numObjects() + 1 end
-
--- If the specified edge exists in either the persistent or dynamic spatial distances, return the value
-APFuncs.spatialDistance = function(self, edge)
-	if APPersistent.SpatialDistStatic[edge] ~= nil then return APPersistent.SpatialDistStatic[edge] end
-	if self.SpatialDistDynamic[edge] ~= nil then return self.SpatialDistDynamic[edge] end
-	return nil
-end
-
 -- Mainly useful for debugging
 APFuncs.showGateRoute = function(self)
 	print ""
@@ -97,15 +72,6 @@ APFuncs.showGateRoute = function(self)
 	end
 end
 
--- Return a string to be used as a table key representing an edge in the graph
-APFuncs.graphEdge = function(self, u, v)
-	if u == nil or v == nil then
-		print "APFuncs.graphEdge() received one or both values nil."
-		return nil
-	end
-	return (string.format("%s to %s", u, v))
-end
-
 -- Does the specified ship have the necessary outfit? (Note: You must pass the sprite itself)
 APFuncs.hasAutopilot = function(self, ship)
 	for n,po in pairs( ship:GetOutfits() ) do
@@ -122,206 +88,21 @@ APFuncs.showAlert = function(self)
 	HUD.newAlert( (string.format("Autopilot: engaged, en route to %s, next object is %s", dest, next) ) )
 end
 
--- Calculate the shortest path from the current location to the specified destination
-function APFuncs.shortestPath(self, dest)
-
-	-- Sorry; these obfuscated-looking variables are to best match the algorithm description from my CS textbook!
-
-	self.d = { }  -- shortest path distances from s; e.g., d["Ves"] is the length of the shortest known route to from s to Ves.
-	self.pred = { } -- predecessor list; e.g., pred["Ves"] is the gate (if any -- else origin) that the player exits before reaching Ves
-	self.s = (self.name .. self.id) -- starting point (most likely "player")
-	self.V = APPersistent.Objects -- names of planets, stations, and gates
-	self.S = { }
-	self.l = function(edge) return self:spatialDistance(edge) end
-
-	-- relax distances between edges based on newly discovered routes
-	self.relax = function ( u, v )
-		if u == v then return end
-		local e_uv = self:graphEdge(u, v)
-		local luv = self.l(e_uv)
-		-- if luv is nil, then this may be a planet-planet edge; we don't care about those
-		if luv == nil then return end
-		-- for this algorithm, d[x] == nil shall be taken to mean d(x) = infinity (unexplored); not to be confused with d(x) = 0
-		if self.d[u] == nil then return end
-		-- if d(v) is infinite or longer than d(u) + l(u,v), then set d(v) = d(u) = l(u,v), and set predecessor(v) = u
-		if self.d[v] == nil or self.d[v] > self.d[u] + luv then
-			self.d[v] = self.d[u] + luv
-			self.pred[v] = u
-		end
-	end
-
-	-- initialize with values for starting point
-	self.d    [self.s] = 0		-- distance to s is 0
-	self.S    [self.s] = true	-- s is the only node that has been explored
-	self.pred [self.s] = nil	-- s has no predecessor
-
-	local relaxations = 0
-	local cycles = 0
-
-	-- My original plan was to implement Dijkstra's algorithm, but I don't know of a priority queue
-	-- structure in Lua, and I seem to have better luck with Bellman-Ford. Running time of O(nm)
-	-- for n = objs and m = edges is worse than Dijkstra. Ways the running time could be reduced:
-	--     - switch to Dijkstra
-	--     - only iterate through Gate-Gate and Gate-Planet pairs; Planet-Planet is ignored anyway by the luv == nil test in relax(), but the loop still happens.
-	--     - find a faster way of achieving "choose v from V such that v not in S" (choose v from V - S) rather than just testing for existence in S of each object
-
-	-- Fortunately, this only has to run each time the player chooses to calculate a new route, which is rare.
-
-	self.spcr = coroutine.create(function()
-		local spcr_finished = false
-
-		for i =1,self:numObjects()-1 do -- <--- repeat (numObjects - 1) times
-			for i1,u in pairs(self.V) do -- <----------\_______________ for each
-				for i2,v in pairs(self.V) do -- <--/                edge (u,v)
-					if self.S[v] == nil then -- such that v not in S
-						if( u ~= v ) then self.relax( u, v ) end
-						relaxations = relaxations + 1
-					end
-				end
-				-- since the moving object is no longer listed, need to do this relax individually
-				-- note: the fact that we are considering that u (rather than v) may be unexplored deviates
-				-- from the algorithm spec a bit, but with the way things are implemented here it does not
-				-- cause a problem
-				if(self.S[u] == nil) then self.relax( (self.name .. self.id), u) end
-				if i1 % 7 == 1 then coroutine.yield() end
-			end
-			coroutine.yield()
-		end
-
-		spcr_finished = true
-
-		return spcr_finished
-	end)
-
-	self.spcrConclude = function()
-		self.spcr = nil
-		if self.name == "player" then PLAYER:SetLuaControlFunc("") end
-
-		--print ("relaxations: "..relaxations)
-
-		if dest == self.s then
-			-- this should not happen unless the player asks the for a route to "player"
-		else
-			self.GateRoute = { }
-
-			self.buildRoute = function(obj)
-				table.insert(self.GateRoute, 0, obj)
-				if obj == (self.name .. self.id) or obj == nil then return true end
-				return self.buildRoute(self.pred[obj])
-			end
-
-			self.buildRoute(dest)
-		end
-		--self:showGateRoute()
-
-		if self.name == "player" then
-			HUD.newAlert( string.format("Computed a route to %s: %d gate pair(s).", dest, math.floor(#self.GateRoute/2) ) )
-		end
-
-		return true
-	end
-
-	self.spcrTick = function()
-		--print "SPCR TICK"
-		coroutine.resume(self.spcr)
-		local status, spcr_finished = coroutine.resume(self.spcr)
-		if spcr_finished then
-			--print "coroutine finished"
-			return self.spcrConclude()
-		else
-			--print "coroutine did not finish yet"
-			return false
-		end
-	end
-
-	if self.name == "player" then
-		PLAYER:SetLuaControlFunc("Autopilot.spcrTick()")
-		HUD.newAlert("Working...")
-	end
-end
-
-function APFuncs.calculateSpatialDistances (self, moving_type, moving_id)
-	local movingX, movingY, moving_object
-	if moving_type == "player" then
-		movingX, movingY = PLAYER:GetPosition()
-	elseif moving_type == "AI" then
-		movingX, movingY = Epiar.getSprite(moving_id):GetPosition()
+-- Cache the positions of the gates and planets that autoAngle() steers towards
+function APCacheInfo()
+	if APPersistent.doneCaching == true then return end
+	for num,gate in pairs(Epiar.gates()) do
+		local gi = Epiar.getGateInfo(gate:GetID())
+		APPersistent.gateInfoCache[gi.Name] = gi
 	end
-	moving_object = (moving_type .. moving_id)
-
-	local updateOnly = true
-	if self:numObjects() == 1 then updateOnly = false end
-
-	if APPersistent.doneCaching ~= true then
-		local theGates = Epiar.gates()
-		local thePlanets = Epiar.planets()
-		for num,gate in pairs(theGates) do
-			local gi = Epiar.getGateInfo(gate:GetID())
-			APPersistent.gateInfoCache[gi.Name] = gi
-		end
-		for num,planet in pairs(thePlanets) do
-			local pi = Epiar.getPlanetInfo(planet:GetID())
-			APPersistent.planetInfoCache[pi.Name] = pi
-		end
-		APPersistent.doneCaching = true
+	for num,planet in pairs(Epiar.planets()) do
+		local pi = Epiar.getPlanetInfo(planet:GetID())
+		APPersistent.planetInfoCache[pi.Name] = pi
 	end
-
-	for gname1,gi1 in pairs(APPersistent.gateInfoCache) do
-
-		-- loop to calculate spatial distances between all gate pairs (including partners, which are recorded as zero distance)
-		for gname2,gi2 in pairs(APPersistent.gateInfoCache) do
-			if updateOnly then break end
-			local edge = self:graphEdge(gi1.Name, gi2.Name)
-			APPersistent.SpatialDistStatic[edge] = distfrom( gi1.X, gi1.Y, gi2.X, gi2.Y )
-			if gi1.Exit == gi2.Name then 
-				APPersistent.SpatialDistStatic[edge] = 0
-			end
-		end
-
-		-- calculate distance from moving object to this gate
-		local edge = self:graphEdge(moving_object, gi1.Name)
-		self.SpatialDistDynamic[edge] = distfrom( movingX, movingY, gi1.X, gi1.Y )
-		edge = self:graphEdge(gi1.Name, moving_object)
-		self.SpatialDistDynamic[edge] = distfrom( gi1.X, gi1.Y, movingX, movingY )
-
-		-- loop to calculate distances Gate-Planet and moving_object-Planet
-		for pname,pi in pairs(APPersistent.planetInfoCache) do
-			if updateOnly == false then
-				local edge = self:graphEdge(gi1.Name, pi.Name)
-				APPersistent.SpatialDistStatic[edge] = distfrom( gi1.X, gi1.Y, pi.X, pi.Y )
-				edge = self:graphEdge(pi.Name, gi1.Name)
-				APPersistent.SpatialDistStatic[edge] = distfrom( pi.X, pi.Y, gi1.X, gi1.Y )
-			end
-	
-			edge = self:graphEdge(moving_object, pi.Name)
-			self.SpatialDistDynamic[edge] = distfrom( movingX, movingY, pi.X, pi.Y )
-			edge = self:graphEdge(pi.Name, moving_object)
-			self.SpatialDistDynamic[edge] = distfrom( pi.X, pi.Y, movingX, movingY )
-		end
-
-		if updateOnly == false then
-			-- include this gate in the list of objects
-			table.insert(APPersistent.Objects, gi1.Name)
-			APPersistent.numObjectsIncr()
-		end
-	end
-
-	-- once the gate loop is finished, run through the planets
-	-- one time and insert them into the list of objects
-	for pname,pi in pairs(APPersistent.planetInfoCache) do
-		if updateOnly then break end
-		table.insert(APPersistent.Objects, pi.Name)
-		APPersistent.numObjectsIncr()
-	end
-
-	-- don't do this anymore
-	--if APPersistent.Objects[moving_object] == nil then
-	--	table.insert(APPersistent.Objects, moving_object)
-	--	APPersistent.numObjectsIncr()
-	--end
-
+	APPersistent.doneCaching = true
 end
 
+-- Plan the shortest route from the ship to the specified destination. Returns true if there is one.
 function APFuncs.compute (self, dest)
 	if self.ConfigDialog ~= nil then
 		self.ConfigDialog:close()
@@ -330,29 +111,28 @@ function APFuncs.compute (self, dest)
 		Epiar.unpause()
 	end
 
-	-- This has to be done each time, but only because the ship's position changes.
-	-- Distances between stationary objects are computed once and then kept for
-	-- future use (shared between instances). However, different instances need to
-	-- have their own distance data isolated from one another to avoid clogging
-	-- up other computations.
+	APCacheInfo()
 
-	self:calculateSpatialDistances(self.name, self.id) 
-
-	local exists = function(obj)
-		for n,o in pairs(APPersistent.Objects) do
-			if o == obj then return true end
-		end
-		return false
+	-- The engine plans the route (and shares it with nearby ships heading the same way)
+	local route = nil
+	if dest ~= nil and dest ~= "" then
+		route = Epiar.route(self.id, dest)
 	end
 
-	if dest == nil or dest == "" or exists(dest) == false then
+	if route == nil then
 		if self.name == "player" then
 			HUD.newAlert("Please specify a real destination.")
 		end
-		return
+		return false
 	end
 
-	self:shortestPath(dest)
+	self.GateRoute = route
+	--self:showGateRoute()
+
+	if self.name == "player" then
+		HUD.newAlert( string.format("Computed a route to %s: %d gate pair(s).", dest, math.floor(#self.GateRoute/2) ) )
+	end
+	return true
 end
 
 -- Function to handle ship rotation and thrust suggestions. Returns true until arrival at the destination. then false.
@@ -372,6 +152,7 @@ function APFuncs.autoAngle (self)
 		-- neither should this
 	elseif #self.GateRoute == 1 then
 		local pi = APPersistent.planetInfoCache[theObj]
+		if pi == nil then pi = APPersistent.gateInfoCache[theObj] end
 		local movingX, movingY = mySprite:GetPosition()
 		local speed = mySprite:GetMomentumSpeed()
 		self.AllowAccel = false
@@ -504,7 +285,7 @@ function showAPConfigDialog()
 	-- This instruction text may seem superfluous, but it does serve the purpose
 	-- of occupying the extra space needed to accommodate the dropdown.
 	local instructionsLabel = UI.newParagraph(20, 160, width, height, 
-[[Select a destination from the menu, compute the gate route (takes several seconds), then
+[[Select a destination from the menu, compute the gate route, then
 hit Left Alt to engage or disengage the autopilot. The route will be shared with any escorts,
 who will continue to accompany you.
 
@@ -173,9 +173,10 @@ function Fleet.getLeader(self, id)
 end
 
 function Fleet.getLeaderRoute(self)
-	if self:getLeader() == PLAYER:GetID() and Autopilot.spcr == nil then
-		return Autopilot.GateRoute
-	elseif AIData[self:getLeader()].Autopilot.spcr == nil then
+	if self:getLeader() == PLAYER:GetID() then
+		if Autopilot ~= nil then return Autopilot.GateRoute end
+		return nil
+	elseif AIData[self:getLeader()] ~= nil and AIData[self:getLeader()].Autopilot ~= nil then
 		return AIData[self:getLeader()].Autopilot.GateRoute
 	else
 		return nil
@@ -17,6 +17,7 @@
 #include "Sprites/spritemanager.h"
 #include "UI/ui_map.h"
 #include "Utilities/log.h"
+#include "Utilities/profiler.h"
 #include "Utilities/timer.h"
 #include "Engine/camera.h"
 
@@ -285,9 +286,28 @@ void Hud::Draw( int flags, float fps, Camera* camera, SpriteManager* sprites ) {
 	if(flags & HUD_Messages)   Hud::DrawMessages();
 	if(flags & HUD_FPS)        Hud::DrawFPS(fps, sprites);
 	if(flags & HUD_StatusBars) Hud::DrawStatusBars();
+	if(flags & HUD_Profile)    Hud::DrawProfile();
 }
 
 
+/**\brief Remembers the visited Sprite that is closest to a point.
+ */
+class ClosestSpriteVisitor : public SpriteVisitor {
+	public:
+		ClosestSpriteVisitor( Coordinate _point ) :closest( NULL ), point( _point ), distance( 0 ) {}
+		void Visit( Sprite *sprite ) {
+			float d = (point - sprite->GetWorldPosition()).GetMagnitudeSquared();
+			if( closest == NULL || d < distance ) {
+				closest = sprite;
+				distance = d;
+			}
+		}
+		Sprite *closest;
+	private:
+		Coordinate point;
+		float distance;
+};
+
 /**\brief Handles Hud related User Input
  * \param events User entered Keyboard and mouse clicks
  */
@@ -306,11 +326,11 @@ void Hud::HandleInput( list<InputEvent> & events, Camera* camera, SpriteManager*
 				Coordinate screenPos(i->mx, i->my), worldPos;
 				camera->TranslateScreenToWorld( screenPos, worldPos );
 				// Target any clicked Sprite
-				list<Sprite*> *impacts = sprites->GetSpritesNear( worldPos, 5 );
-				if( impacts->size() > 0) {
-					Target( (*(impacts->begin()))->GetID());
+				ClosestSpriteVisitor impacts( worldPos );
+				sprites->ForEachSpriteNear( worldPos, 5, DRAW_ORDER_ALL, impacts );
+				if( impacts.closest != NULL ) {
+					Target( impacts.closest->GetID() );
 				}
-				delete impacts;
 			}
 		}
 	}
@@ -352,6 +372,32 @@ void Hud::DrawFPS( float fps, SpriteManager* sprites ) {
 
 	snprintf(frameRate, sizeof(frameRate), "%d Sprites", sprites->GetNumSprites());
 	BitType->Render( Video::GetWidth()-100, Video::GetHeight() - 45, frameRate );
+
+	snprintf(frameRate, sizeof(frameRate), "%u Drawn", sprites->GetNumDrawn());
+	BitType->Render( Video::GetWidth()-100, Video::GetHeight() - 60, frameRate );
+
+	snprintf(frameRate, sizeof(frameRate), "%u Culled", sprites->GetNumCulled());
+	BitType->Render( Video::GetWidth()-100, Video::GetHeight() - 75, frameRate );
+}
+
+/**\brief Draws the time taken by each phase of the recent frames.
+ * \details This is only drawn while the Profiler is enabled.
+ * \see Profiler
+ */
+void Hud::DrawProfile() {
+	if( !Profiler::IsEnabled() ) {
+		return;
+	}
+	int x = Video::GetWidth() - 360;
+	int y = Video::GetHeight() - 90 - 15 * PROFILE_PHASES;
+	char header[40];
+	BitType->SetColor( WHITE );
+	snprintf(header, sizeof(header), "Last %u frames", Profiler::GetNumFrames() );
+	BitType->Render( x, y, header );
+	for( int phase = 0; phase < PROFILE_PHASES; phase++ ) {
+		y += 15;
+		BitType->Render( x, y, Profiler::Describe( phase ) );
+	}
 }
 
 /**\brief Draws the status bar.
@@ -698,12 +744,19 @@ void Radar::StopLargeMode() {
 	largeMode = false;
 }
 
+/**\brief Draws a radar blip for each visited Sprite.
+ */
+class Radar::BlipVisitor : public SpriteVisitor {
+	public:
+		BlipVisitor( Coordinate _focus ) :focus( _focus ) {}
+		void Visit( Sprite *sprite ) { Radar::DrawBlip( focus, sprite ); }
+	private:
+		Coordinate focus;
+};
+
 /**\brief Draws the radar.
  */
 void Radar::Draw( Camera* camera, SpriteManager* sprites ) {
-	short int radar_mid_x = RADAR_MIDDLE_X + Video::GetWidth() - 129;
-	short int radar_mid_y = RADAR_MIDDLE_Y + 5;
-	int radarSize;
 	Coordinate focus = camera->GetFocusCoordinate();
 
 	if(largeMode) {
@@ -719,39 +772,56 @@ void Radar::Draw( Camera* camera, SpriteManager* sprites ) {
 		return;
 	}
 
-	list<Sprite*> *spriteList = sprites->GetSpritesNear(camera->GetFocusCoordinate(), (float)visibility);
-	for( list<Sprite*>::const_iterator iter = spriteList->begin(); iter != spriteList->end(); iter++)
-	{
+	BlipVisitor blips( focus );
+	sprites->ForEachSpriteNear( focus, (float)visibility, DRAW_ORDER_ALL, blips );
+
+	// Projectiles are not Sprites, and are always too small for more than a point
+	static vector<Coordinate> projectiles;
+	short int radar_mid_x = RADAR_MIDDLE_X + Video::GetWidth() - 129;
+	short int radar_mid_y = RADAR_MIDDLE_Y + 5;
+	sprites->GetProjectiles()->GetPositionsNear( focus, (float)visibility, &projectiles );
+	for( vector<Coordinate>::iterator p = projectiles.begin(); p != projectiles.end(); ++p ) {
 		Coordinate blip;
-		Sprite *sprite = *iter;
-		
-		//if( sprite->GetDrawOrder() == DRAW_ORDER_PLAYER ) continue;
-		
-		// Calculate the blip coordinate for this sprite
-		Coordinate wpos = sprite->GetWorldPosition();
-		WorldToBlip( focus, wpos, blip );
-		
-		// Use the OpenGL Crop Rectangle to ensure that the blip is on the radar
-		
-		/* Convert to screen coords */
+		WorldToBlip( focus, *p, blip );
 		blip.SetX( blip.GetX() + radar_mid_x );
 		blip.SetY( blip.GetY() + radar_mid_y );
-		
-		radarSize = int((sprite->GetRadarSize() / float(visibility)) * (RADAR_HEIGHT/4.0));
-		
-		if( radarSize >= 1 ) {
-			if(sprite->GetID() == Hud::GetTarget() && Timer::GetTicks() % 1000 < 100)
-				Video::DrawCircle( blip, radarSize, 2, WHITE );
-			else
-				Video::DrawCircle( blip, radarSize, 1, sprite->GetRadarColor() );
-		} else {
-			if(sprite->GetID() == Hud::GetTarget() && Timer::GetTicks() % 1000 < 100)
-				Video::DrawCircle( blip, 1, 2, WHITE );
-			else
-				Video::DrawPoint( blip, sprite->GetRadarColor() );
-		}
+		Video::DrawPoint( blip, Color(0x55,0x55,0x55) );
+	}
+}
+
+/**\brief Draws one Sprite on the radar.
+ */
+void Radar::DrawBlip( Coordinate focus, Sprite *sprite ) {
+	short int radar_mid_x = RADAR_MIDDLE_X + Video::GetWidth() - 129;
+	short int radar_mid_y = RADAR_MIDDLE_Y + 5;
+	int radarSize;
+	Coordinate blip;
+
+	//if( sprite->GetDrawOrder() == DRAW_ORDER_PLAYER ) return;
+
+	// Calculate the blip coordinate for this sprite
+	Coordinate wpos = sprite->GetWorldPosition();
+	WorldToBlip( focus, wpos, blip );
+
+	// Use the OpenGL Crop Rectangle to ensure that the blip is on the radar
+
+	/* Convert to screen coords */
+	blip.SetX( blip.GetX() + radar_mid_x );
+	blip.SetY( blip.GetY() + radar_mid_y );
+
+	radarSize = int((sprite->GetRadarSize() / float(visibility)) * (RADAR_HEIGHT/4.0));
+
+	if( radarSize >= 1 ) {
+		if(sprite->GetID() == Hud::GetTarget() && Timer::GetTicks() % 1000 < 100)
+			Video::DrawCircle( blip, radarSize, 2, WHITE );
+		else
+			Video::DrawCircle( blip, radarSize, 1, sprite->GetRadarColor() );
+	} else {
+		if(sprite->GetID() == Hud::GetTarget() && Timer::GetTicks() % 1000 < 100)
+			Video::DrawCircle( blip, 1, 2, WHITE );
+		else
+			Video::DrawPoint( blip, sprite->GetRadarColor() );
 	}
-	delete spriteList;
 }
 
 /**\brief Gets the radar position based on world coordinate
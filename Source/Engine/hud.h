@@ -32,6 +32,7 @@
 #define HUD_FPS         0x0010
 #define HUD_StatusBars  0x0020
 #define HUD_Map         0x0040
+#define HUD_Profile     0x0080
 #define HUD_ALL         0xFFFF
 
 
@@ -115,6 +116,7 @@ class Hud {
 		static void DrawRadarNav( Camera* camera, SpriteManager* sprites );
 		static void DrawMessages();
 		static void DrawFPS( float fps, SpriteManager* sprites );
+		static void DrawProfile();
 		static void DrawStatusBars();
 		static void DrawTarget(SpriteManager* sprites);
 		static void DrawMap( Camera* camera, SpriteManager* sprites );
@@ -141,7 +143,10 @@ class Radar {
 		static int GetHeight();
 	
 	private:
+		class BlipVisitor;
+
 		static void WorldToBlip( Coordinate focus, Coordinate &w, Coordinate &b );
+		static void DrawBlip( Coordinate focus, Sprite *sprite );
 		static void StopLargeMode();
 	
 		static int visibility;
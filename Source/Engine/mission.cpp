@@ -11,6 +11,7 @@
 #include "Utilities/lua.h"
 #include "Utilities/log.h"
 #include "Utilities/components.h"
+#include "Utilities/scriptprofiler.h"
 
 /**\class Mission
  * \brief A Goal for the Player to complete for rewards.
@@ -287,7 +288,10 @@ bool Mission::RunFunction(string functionName, bool checkCompletion)
 	lua_rawgeti(L, LUA_REGISTRYINDEX, tableReference);
 	
 	// Call the function
-	if( lua_pcall(L, 1, LUA_MULTRET, 0) != 0)
+	ScriptTimer timer( L );
+	int failed = lua_pcall(L, 1, LUA_MULTRET, 0);
+	timer.Stop( type, functionName );
+	if( failed != 0 )
 	{
 		LogMsg(ERR,"Failed to run %s.%s: %s\n", type.c_str(), functionName.c_str(), lua_tostring(L, -1));
 		lua_settop(L,initialStackTop);
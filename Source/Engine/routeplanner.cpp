@@ -0,0 +1,239 @@
+/**\file			routeplanner.cpp
+ * \author			agent (agent@local)
+ * \date			Created: Sunday, October 18, 2026
+ * \date			Modified: Sunday, October 18, 2026
+ * \brief			Plans the shortest way to a Planet or Gate through the Gates.
+ * \details
+ */
+
+#include "includes.h"
+#include "Engine/routeplanner.h"
+#include "Sprites/gate.h"
+#include "Sprites/planets.h"
+#include "Utilities/log.h"
+
+/** \addtogroup Engine
+ * @{
+ */
+
+#define ROUTE_REGION_SIZE 2048.0f ///< Ships within the same square of this size share their routes.
+#define ROUTE_CACHE_SIZE  512      ///< The most routes kept at once.
+
+bool RoutePlanner::dirty = true;
+vector<RouteGate> RoutePlanner::gates;
+map< pair< pair<int,int>, string >, RoutePlanner::CachedRoute > RoutePlanner::routes;
+list< pair< pair<int,int>, string > > RoutePlanner::recent;
+
+typedef pair<float,int> RouteStep; ///< The estimated length of a route through a node, and the node.
+
+/**\brief Find the shortest way to a Planet or Gate, through the Gates.
+ * \param from Where the route starts.
+ * \param destination The name of a Planet or a Gate.
+ * \param waypoints Set to the names of each Gate to fly into, followed by
+ *        the Gate that it leads to, and then the destination.
+ * \details The route is planned from the middle of the region that contains
+ *          from, and is kept for the next Ship to ask from that region.  Once
+ *          ROUTE_CACHE_SIZE routes are kept, the one used longest ago is
+ *          forgotten.
+ * \return false if there is no such destination.
+ */
+bool RoutePlanner::Route( Coordinate from, const string& destination, vector<string> *waypoints ) {
+	if( dirty ) {
+		Build();
+	}
+
+	int regionX = static_cast<int>( floor( from.GetX() / ROUTE_REGION_SIZE ) );
+	int regionY = static_cast<int>( floor( from.GetY() / ROUTE_REGION_SIZE ) );
+	RouteKey key = make_pair( make_pair( regionX, regionY ), destination );
+
+	map<RouteKey,CachedRoute>::iterator cached = routes.find( key );
+	if( cached != routes.end() ) {
+		recent.splice( recent.begin(), recent, cached->second.second );
+		*waypoints = cached->second.first;
+		return true;
+	}
+
+	Coordinate to;
+	if( !FindDestination( destination, &to ) ) {
+		LogMsg(WARN, "Cannot plan a route to '%s'.  There is no Planet or Gate with that name.", destination.c_str() );
+		return false;
+	}
+
+	Coordinate center( (regionX + 0.5f) * ROUTE_REGION_SIZE, (regionY + 0.5f) * ROUTE_REGION_SIZE );
+	vector<int> through;
+	FindRoute( gates, center, to, &through );
+
+	if( routes.size() >= ROUTE_CACHE_SIZE ) {
+		routes.erase( recent.back() );
+		recent.pop_back();
+	}
+	recent.push_front( key );
+	CachedRoute& cache = routes[key];
+	cache.second = recent.begin();
+
+	vector<string>& route = cache.first;
+	for( unsigned int g = 0; g < through.size(); g++ ) {
+		route.push_back( gates[ through[g] ].name );
+		route.push_back( gates[ through[g] ].exitName );
+	}
+	route.push_back( destination );
+	*waypoints = route;
+	return true;
+}
+
+/**\brief Work out how far each Gate exit is from the nearest other Gate.
+ * \details Gates that lead straight back to where the Ship came in are left
+ *          out.  Flying into one of them can't shorten a route, since the
+ *          Ship could have flown on from where it came in instead.
+ */
+void RoutePlanner::MeasureGates( vector<RouteGate> *gates ) {
+	vector<RouteGate>& all = *gates;
+	for( unsigned int g = 0; g < all.size(); g++ ) {
+		all[g].toNearestGate = -1.0f;
+		for( unsigned int other = 0; other < all.size(); other++ ) {
+			if( all[other].exit == all[g].position ) {
+				continue;
+			}
+			float distance = (all[other].position - all[g].exit).GetMagnitude();
+			if( all[g].toNearestGate < 0.0f || distance < all[g].toNearestGate ) {
+				all[g].toNearestGate = distance;
+			}
+		}
+	}
+}
+
+/**\brief Find the shortest way from one point to another with A*.
+ * \param gates The Gates that may be flown through, after MeasureGates.
+ * \param through The Gates to fly into, in order, are appended here.
+ * \details Each node of the search is where a Gate lets the Ship out, plus
+ *          the start and the destination.  From a Gate exit, the rest of the
+ *          way is either the straight flight to the destination, or the
+ *          flight to another Gate and, eventually, the flight from some Gate
+ *          exit to the destination.  The estimate is the shorter of the
+ *          straight flight and the flight to the nearest other Gate plus the
+ *          flight from the Gate exit nearest the destination, which never
+ *          overestimates.  Gates that lead straight back are skipped, as
+ *          in MeasureGates.
+ * \return The distance flown.
+ */
+float RoutePlanner::FindRoute( const vector<RouteGate>& gates, Coordinate from, Coordinate to, vector<int> *through ) {
+	const int numGates = gates.size();
+	const int destination = numGates;
+	const int start = numGates + 1;
+
+	float exitToDestination = -1.0f; // Flying from the Gate exit nearest the destination
+	for( int g = 0; g < numGates; g++ ) {
+		Coordinate exit = gates[g].exit;
+		float distance = (to - exit).GetMagnitude();
+		if( exitToDestination < 0.0f || distance < exitToDestination ) {
+			exitToDestination = distance;
+		}
+	}
+
+	vector<float> cost( numGates + 2, -1.0f ); // Negative until the node is reached
+	vector<int> previous( numGates + 2, -1 );
+	vector<bool> closed( numGates + 2, false );
+	vector<RouteStep> open;
+
+	cost[start] = 0.0f;
+	open.push_back( RouteStep( 0.0f, start ) );
+	while( !open.empty() ) {
+		pop_heap( open.begin(), open.end(), greater<RouteStep>() );
+		int node = open.back().second;
+		open.pop_back();
+		if( closed[node] ) {
+			continue;
+		}
+		closed[node] = true;
+		if( node == destination ) {
+			break;
+		}
+
+		Coordinate here = ( node == start ) ? from : gates[node].exit;
+		for( int next = 0; next <= numGates; next++ ) {
+			if( closed[next] ) {
+				continue;
+			}
+			if( next != destination && node != start && gates[next].exit == gates[node].position ) {
+				continue; // Straight back to where this node came in
+			}
+			Coordinate there = ( next == destination ) ? to : gates[next].position;
+			float reached = cost[node] + (there - here).GetMagnitude();
+			if( cost[next] >= 0.0f && cost[next] <= reached ) {
+				continue;
+			}
+			cost[next] = reached;
+			previous[next] = node;
+
+			float estimate = 0.0f;
+			if( next != destination ) {
+				Coordinate exit = gates[next].exit;
+				estimate = (to - exit).GetMagnitude();
+				if( gates[next].toNearestGate >= 0.0f ) {
+					estimate = min( estimate, gates[next].toNearestGate + exitToDestination );
+				}
+			}
+			open.push_back( RouteStep( reached + estimate, next ) );
+			push_heap( open.begin(), open.end(), greater<RouteStep>() );
+		}
+	}
+
+	unsigned int first = through->size();
+	for( int node = previous[destination]; node != start && node >= 0; node = previous[node] ) {
+		through->push_back( node );
+	}
+	reverse( through->begin() + first, through->end() );
+	return cost[destination];
+}
+
+/**\brief Collect the Gates again, and forget every route.
+ * \details Gates that lead nowhere in particular are left out, since a
+ *          route cannot count on them.
+ */
+void RoutePlanner::Build() {
+	gates.clear();
+	routes.clear();
+	recent.clear();
+
+	Gates *allGates = Gates::Instance();
+	list<string>* names = allGates->GetNames();
+	for( list<string>::iterator name = names->begin(); name != names->end(); ++name ) {
+		Gate *gate = allGates->GetGate( *name );
+		if( gate == NULL ) {
+			continue;
+		}
+		Sprite *exit = gate->GetExit();
+		if( exit == NULL || !( exit->GetDrawOrder() & (DRAW_ORDER_GATE_TOP|DRAW_ORDER_GATE_BOTTOM) ) ) {
+			continue;
+		}
+		RouteGate routeGate;
+		routeGate.name = gate->GetName();
+		routeGate.exitName = ((Gate*)exit)->GetName();
+		routeGate.position = gate->GetWorldPosition();
+		routeGate.exit = exit->GetWorldPosition();
+		gates.push_back( routeGate );
+	}
+	MeasureGates( &gates );
+	dirty = false;
+	LogMsg(INFO, "Planning routes through %d Gates.", static_cast<int>( gates.size() ) );
+}
+
+/**\brief Where a Planet or Gate is.
+ * \return false if there is no Planet or Gate with that name.
+ */
+bool RoutePlanner::FindDestination( const string& destination, Coordinate *position ) {
+	string name = destination;
+	Planet *planet = Planets::Instance()->GetPlanet( name );
+	if( planet != NULL ) {
+		*position = planet->GetWorldPosition();
+		return true;
+	}
+	Gate *gate = Gates::Instance()->GetGate( name );
+	if( gate != NULL ) {
+		*position = gate->GetWorldPosition();
+		return true;
+	}
+	return false;
+}
+
+/** @} */
@@ -0,0 +1,64 @@
+/**\file			routeplanner.h
+ * \author			agent (agent@local)
+ * \date			Created: Sunday, October 18, 2026
+ * \date			Modified: Sunday, October 18, 2026
+ * \brief			Plans the shortest way to a Planet or Gate through the Gates.
+ * \details
+ */
+
+#ifndef __h_routeplanner__
+#define __h_routeplanner__
+
+#include "includes.h"
+#include "Utilities/coordinate.h"
+
+/**\brief A Gate as the RoutePlanner sees it.
+ */
+struct RouteGate {
+	string name;          ///< The name of the Gate.
+	string exitName;      ///< The name of the Gate that it sends Ships to.
+	Coordinate position;  ///< Where to fly into the Gate.
+	Coordinate exit;      ///< Where the Ships come out.
+	float toNearestGate;  ///< From the exit to the nearest Gate that doesn't lead straight back, or -1 if there is none.
+};
+
+/**\class RoutePlanner
+ * \brief Finds the shortest way to a Planet or Gate, through the Gates.
+ *
+ * \details
+ * Flying into a Gate costs nothing more, so a route is some number of Gates to
+ * fly into, each followed by the Gate that it leads to, and then the
+ * destination.  FindRoute searches them with A*.  From each Gate exit, the
+ * rest of the way is estimated from how far that exit is from the other
+ * Gates and from the destination, so the exits that are far from both are
+ * looked at last, if at all.
+ *
+ * Routes are kept for each region of space and destination, so the Ships in
+ * the same region share one route.  Only the most recently used routes are
+ * kept.  The Gates are only collected when they have changed, which also
+ * forgets every route.
+ *
+ * \see Gate
+ */
+class RoutePlanner {
+	public:
+		static bool Route( Coordinate from, const string& destination, vector<string> *waypoints );
+		static void Invalidate() { dirty = true; }
+
+		static void MeasureGates( vector<RouteGate> *gates );
+		static float FindRoute( const vector<RouteGate>& gates, Coordinate from, Coordinate to, vector<int> *through );
+
+	private:
+		static void Build();
+		static bool FindDestination( const string& destination, Coordinate *position );
+
+		typedef pair< pair<int,int>, string > RouteKey; ///< The region of the start and the name of the destination.
+		typedef pair< vector<string>, list<RouteKey>::iterator > CachedRoute; ///< A route and its place in recent.
+
+		static bool dirty;                         ///< Whether the Gates have changed since they were collected.
+		static vector<RouteGate> gates;            ///< Every Gate that leads to another Gate.
+		static map< RouteKey, CachedRoute > routes; ///< The routes kept, by where they start and end.
+		static list<RouteKey> recent;              ///< The keys of the routes kept, most recently used first.
+};
+
+#endif // __h_routeplanner__
@@ -27,10 +27,13 @@
 #include "Sprites/planets_lua.h"
 #include "Sprites/gate.h"
 #include "Sprites/spritemanager.h"
+#include "Sprites/statemachine.h"
 #include "UI/ui.h"
 #include "UI/widgets.h"
 #include "Utilities/file.h"
 #include "Utilities/log.h"
+#include "Utilities/profiler.h"
+#include "Utilities/scriptprofiler.h"
 #include "Utilities/timer.h"
 #include "Utilities/lua.h"
 
@@ -197,6 +200,9 @@ bool Simulation::SetupToRun(){
 		return false;
 	}
 
+	// The State Machines of an earlier Simulation refer to the old scripts
+	StateMachine::Reload(L);
+
 	if( OPTION(int, "options/simulation/random-universe") ) {
 		if( OPTION(int, "options/simulation/random-seed") ) {
 			Lua::Call("createSystems", "i", OPTION(int, "options/simulation/random-seed") );
@@ -240,6 +246,9 @@ bool Simulation::SetupToRun(){
 	// Randomize the Lua Seed
 	Lua::Call("randomizeseed");
 
+	ScriptProfiler::Enable( OPTION(int, "options/development/ai-profiler") != 0 );
+	AI::LoadThinkOptions();
+
 	LogMsg(INFO, "Simulation Setup Complete");
 
 	return true;
@@ -306,11 +315,17 @@ bool Simulation::Run() {
 	if(bgmusic && OPTION(int, "options/sound/background"))
 		bgmusic->Play();
 
+	Profiler::Enable( OPTION(int, "options/development/profiler") != 0 );
+
 	// main game loop
-	bool lowFps = false;
-	int lowFpsFrameCount = 0;
 	while( !quit ) {
-		HandleInput();
+		Profiler::StartFrame();
+		ProfileTimer frameTimer( PROFILE_FRAME );
+
+		{
+			ProfileTimer timer( PROFILE_INPUT );
+			HandleInput();
+		}
 
 		//_ASSERTE(_CrtCheckMemory());
 
@@ -323,12 +338,11 @@ bool Simulation::Run() {
 				LogMsg(WARN, "Running %d logic loops. Capping to 1", logicLoops);
 				logicLoops = 1;
 			}
+			ProfileTimer timer( PROFILE_UPDATE );
 			while(logicLoops--) {
-				if (lowFps)
-					lowFpsFrameCount --;
 				Timer::IncrementFrameCount();
 				// Logical update cycle
-				sprites->Update( L, lowFps );
+				sprites->Update( L );
         
         calendar->Update();
 			}
@@ -346,13 +360,28 @@ bool Simulation::Run() {
 
 		// Draw cycle
 		Video::PreDraw();
-		starfield.Draw();
-		sprites->Draw( camera->GetFocusCoordinate() );
-		Hud::Draw( HUD_ALL, currentFPS, camera, sprites );
-		UI::Draw();
-		console->Draw();
+		{
+			ProfileTimer timer( PROFILE_STARFIELD );
+			starfield.Draw();
+		}
+		{
+			ProfileTimer timer( PROFILE_SPRITES );
+			sprites->Draw( camera->GetFocusCoordinate() );
+		}
+		{
+			ProfileTimer timer( PROFILE_HUD );
+			Hud::Draw( HUD_ALL, currentFPS, camera, sprites );
+		}
+		{
+			ProfileTimer timer( PROFILE_UI );
+			UI::Draw();
+			console->Draw();
+		}
 		Video::PostDraw();
-		Video::Update();
+		{
+			ProfileTimer timer( PROFILE_VIDEO );
+			Video::Update();
+		}
 
 		// Don't kill the CPU (play nice)
 		if( paused ) {
@@ -380,30 +409,6 @@ bool Simulation::Run() {
 				quit = true;
 			}
 
-			/**************************
-			 * Low FPS calculation
-			 *  - if fps goes below 15, set lowFps to true for 600 logical frames
-			 *  - after 600 frames, either turn it off or leave it on for another 600
-			 **************************/
-			if (lowFps)
-			{
-				if (lowFpsFrameCount <= 0)
-				{
-					LogMsg (DEBUG4, "Turning off wave-updates for sprites as 600 frames have passed");
-					lowFps = false;
-				}
-			}
-
-			if (!lowFps && currentFPS < 15)
-			{
-				LogMsg (DEBUG4, "Turning on wave-updates for sprites as FPS has gone below 15");
-				lowFps = true;			//if FPS has dropped below 15 then switch to wave-update method for 600 frames
-				lowFpsFrameCount = 600;
-			}
-				/************************
-				 * End Low FPS calculation
-				 ************************/
-
 			if( OPTION(int, "options/log/ui") )
 			{
 				UI::Save();
@@ -433,12 +438,70 @@ bool Simulation::Run() {
 	}
 	
 	Hud::Close();
+	Profiler::Enable( false );
 
 	LogMsg(INFO,"Simulation Stopped: Average Framerate: %f Frames/Second", 1000.0 *((float)fpsTotal / Timer::GetTicks() ) );
 
 	return (player->GetHullIntegrityPct() > 0);
 }
 
+/**\brief Run the universe as fast as possible without drawing it.
+ * \param ticks The number of logical frames to run.
+ * \details Every tick is one fixed step of the Timer, no matter how long it
+ *          took, so that runs can be compared with each other.  The speed of
+ *          the run and the time spent in each part of the Update are printed
+ *          at the end.
+ * \return true if every tick was run
+ */
+bool Simulation::RunHeadless( Uint32 ticks ) {
+	LogMsg(INFO, "Headless Simulation Started");
+
+	// The AI scripts expect a player to be in the universe
+	if( player == NULL ) {
+		CreateDefaultPlayer( "Headless" );
+	}
+	Lua::Run( "PLAYER = Epiar.player()" );
+
+	sprites->ResetPhaseTimes();
+	Uint64 calendarTime = 0;
+	Uint64 started = Timer::GetMicroseconds();
+	for( Uint32 tick = 0; tick < ticks; tick++ ) {
+		Timer::Step();
+		Timer::IncrementFrameCount();
+		sprites->Update( L );
+
+		Uint64 calendarStarted = Timer::GetMicroseconds();
+		calendar->Update();
+		calendarTime += Timer::GetMicroseconds() - calendarStarted;
+	}
+	Uint64 elapsed = Timer::GetMicroseconds() - started;
+	if( elapsed == 0 ) {
+		elapsed = 1;
+	}
+
+	list<Sprite*> *ships = sprites->GetSprites( DRAW_ORDER_SHIP | DRAW_ORDER_PLAYER );
+	unsigned int numShips = ships->size();
+	delete ships;
+
+	printf( "Ran %u ticks in %.3f seconds: %.1f ticks/second\n", ticks, elapsed / 1000000.0, ticks * 1000000.0 / elapsed );
+	printf( "%-12s %12s %12s %7s\n", "Phase", "Total (ms)", "Tick (us)", "Share" );
+	for( int phase = 0; phase < UPDATE_PHASES; phase++ ) {
+		Uint64 phaseTime = sprites->GetPhaseTime( phase );
+		printf( "%-12s %12.3f %12.2f %6.1f%%\n", SpriteManager::GetPhaseName( phase ),
+			phaseTime / 1000.0, ticks ? double( phaseTime ) / ticks : 0.0, 100.0 * phaseTime / elapsed );
+	}
+	printf( "%-12s %12.3f %12.2f %6.1f%%\n", "Calendar",
+		calendarTime / 1000.0, ticks ? double( calendarTime ) / ticks : 0.0, 100.0 * calendarTime / elapsed );
+	printf( "Sprites: %d (%u ships), Projectiles: %u, Particles: %u\n",
+		sprites->GetNumSprites(), numShips,
+		sprites->GetProjectiles()->GetCount(), sprites->GetParticles()->GetCount() );
+	printf( "Calendar: %s\n", calendar->Now().c_str() );
+
+	LogMsg(INFO, "Headless Simulation Stopped after %u ticks", ticks );
+
+	return true;
+}
+
 bool Simulation::SetupToEdit() {
 	bool luaLoad = true;
 
@@ -496,7 +559,7 @@ bool Simulation::Edit() {
 
 		Timer::Update();
 		starfield.Update( camera );
-		sprites->Update( L, true );
+		sprites->Update( L );
 		camera->Update( sprites );
 		Hud::Update( L );
 
@@ -35,6 +35,7 @@ class Simulation : public XMLFile {
 		bool SetupToEdit();
 
 		bool Run();
+		bool RunHeadless( Uint32 ticks );
 		bool Edit();
 
 		void CreateDefaultPlayer(string name);
@@ -16,6 +16,7 @@
 #include "Engine/simulation_lua.h"
 #include "Engine/models.h"
 #include "Engine/alliances.h"
+#include "Engine/routeplanner.h"
 #include "Utilities/log.h"
 #include "Utilities/lua.h"
 #include "UI/ui_lua.h"
@@ -27,13 +28,17 @@
 #include "Sprites/ai_lua.h"
 #include "Sprites/player.h"
 #include "Sprites/sprite.h"
+#include "Sprites/statemachine.h"
 #include "Sprites/planets.h"
 #include "Sprites/planets_lua.h"
 #include "Sprites/gate.h"
+#include "Sprites/effects.h"
 #include "Engine/camera.h"
 #include "Input/input.h"
 #include "Utilities/file.h"
 #include "Utilities/filesystem.h"
+#include "Utilities/profiler.h"
+#include "Utilities/scriptprofiler.h"
 
 #include "Engine/hud.h"
 
@@ -102,8 +107,19 @@ void Simulation_Lua::RegisterSimulation(lua_State *L) {
 		{"ships", &Simulation_Lua::GetShips},
 		{"planets", &Simulation_Lua::GetPlanets},
 		{"gates", &Simulation_Lua::GetGates},
+		{"route", &Simulation_Lua::GetRoute},
+		{"nearestSprites", &Simulation_Lua::GetNearestSprites},
 		{"nearestShip", &Simulation_Lua::GetNearestShip},
 		{"nearestPlanet", &Simulation_Lua::GetNearestPlanet},
+		{"setInteresting", &Simulation_Lua::SetInteresting},
+		{"poolStats", &Simulation_Lua::GetPoolStats},
+
+		// Profiling Functions
+		{"profiler", &Simulation_Lua::SetProfiler},
+		{"profile", &Simulation_Lua::GetProfile},
+		{"scriptProfiler", &Simulation_Lua::SetScriptProfiler},
+		{"scriptProfile", &Simulation_Lua::GetScriptProfile},
+		{"reloadAI", &Simulation_Lua::ReloadAI},
 
 		// Keyboard Command Functions
 		{"RegisterKey", &Simulation_Lua::RegisterKey},
@@ -594,6 +610,163 @@ int Simulation_Lua::GetSpriteByID(lua_State *L){
 	return 1;
 }
 
+/** \brief Update the universe around a Sprite as often as around the player.
+ *  \details Use this for mission targets, escorts and anything else that the
+ *  player will care about even when it is far away.
+ *  \param id The Sprite ID.
+ *  \param flag Optional; false stops treating the Sprite as interesting.
+ */
+int Simulation_Lua::SetInteresting(lua_State *L){
+	int n = lua_gettop(L);  // Number of arguments
+	if( n!=1 && n!=2 )
+		return luaL_error(L, "Got %d arguments expected 1 (SpriteID) or 2 (SpriteID, flag)", n);
+
+	int id = (int)(luaL_checkint(L,1));
+	bool flag = (n==2) ? (lua_toboolean(L,2) != 0) : true;
+	GetSimulation(L)->GetSpriteManager()->SetInteresting( id, flag );
+	return 0;
+}
+
+/** \brief Describe how a Pool is being used, for the console.
+ */
+template<class T>
+static void PushPoolStats( lua_State *L, const char *name, const Pool<T>& pool ) {
+	char buff[128];
+	snprintf(buff, sizeof(buff), "%s: %u in use, at most %u, %u allocated",
+		name, pool.GetInUse(), pool.GetHighWater(), pool.GetCapacity() );
+	lua_pushstring(L, buff);
+}
+
+/** \brief Get the statistics of the Projectiles, the particles and the Sprite Pools
+ *  \details Each is described by one string, so that the console prints
+ *  one line for each.  The high water mark is the most objects that were
+ *  ever held at once.
+ *  \returns A string for the Projectiles, the particles and each Pool
+ */
+int Simulation_Lua::GetPoolStats(lua_State *L){
+	ProjectileSystem *projectiles = GetSimulation(L)->GetSpriteManager()->GetProjectiles();
+	char buff[128];
+	snprintf(buff, sizeof(buff), "Projectiles: %u in flight, at most %u, %u allocated",
+		projectiles->GetCount(), projectiles->GetHighWater(), projectiles->GetCapacity() );
+	lua_pushstring(L, buff);
+	ParticleSystem *particles = GetSimulation(L)->GetSpriteManager()->GetParticles();
+	snprintf(buff, sizeof(buff), "Particles: %u playing, at most %u, %u allocated",
+		particles->GetCount(), particles->GetHighWater(), particles->GetCapacity() );
+	lua_pushstring(L, buff);
+	PushPoolStats( L, "Effects", Effect::GetPool() );
+	return 3;
+}
+
+/** \brief Start or stop timing each phase of the frames.
+ *  \details While the Profiler runs, the Hud shows the fastest, average and
+ *  99th percentile time of each phase over the recent frames.
+ *  \param on Optional; true starts and false stops the Profiler.  Without it
+ *  the Profiler is toggled.
+ *  \returns Whether the Profiler is now running
+ */
+int Simulation_Lua::SetProfiler(lua_State *L){
+	int n = lua_gettop(L);  // Number of arguments
+	if( n > 1 )
+		return luaL_error(L, "Got %d arguments expected 0 or 1 (on)", n);
+
+	bool on = (n==1) ? (lua_toboolean(L,1) != 0) : !Profiler::IsEnabled();
+	Profiler::Enable( on );
+	lua_pushboolean(L, on );
+	return 1;
+}
+
+/** \brief Get the time taken by each phase of the recent frames.
+ *  \details Each phase is described by one string, so that the console prints
+ *  one line for each.  The table is logged as well, since the console only
+ *  shows its last few lines.
+ *  \returns A string for each phase, or a note that the Profiler is stopped
+ */
+int Simulation_Lua::GetProfile(lua_State *L){
+	if( !Profiler::IsEnabled() ) {
+		lua_pushstring(L, "The profiler is stopped.  Start it with Epiar.profiler(true)." );
+		return 1;
+	}
+	char buff[40];
+	snprintf(buff, sizeof(buff), "Last %u frames:", Profiler::GetNumFrames() );
+	lua_pushstring(L, buff);
+	LogMsg(INFO, "%s", buff );
+	for( int phase = 0; phase < PROFILE_PHASES; phase++ ) {
+		string line = Profiler::Describe( phase );
+		lua_pushstring(L, line.c_str() );
+		LogMsg(INFO, "%s", line.c_str() );
+	}
+	return 1 + PROFILE_PHASES;
+}
+
+/** \brief Start or stop measuring the AI states and Mission functions.
+ *  \details The costs are kept while the profiler is stopped.  They are saved
+ *  to "options/development/ai-profile-file" when Epiar quits.
+ *  \param on Optional; true starts and false stops the profiler.  Without it
+ *  the profiler is toggled.
+ *  \param reset Optional; true forgets the costs measured so far.
+ *  \returns Whether the profiler is now running
+ */
+int Simulation_Lua::SetScriptProfiler(lua_State *L){
+	int n = lua_gettop(L);  // Number of arguments
+	if( n > 2 )
+		return luaL_error(L, "Got %d arguments expected 0, 1 (on) or 2 (on, reset)", n);
+
+	bool on = (n>=1) ? (lua_toboolean(L,1) != 0) : !ScriptProfiler::IsEnabled();
+	if( n==2 && lua_toboolean(L,2) ) {
+		ScriptProfiler::Reset();
+	}
+	ScriptProfiler::Enable( on );
+	lua_pushboolean(L, on );
+	return 1;
+}
+
+/** \brief Get the AI states and Mission functions that have cost the most.
+ *  \details Each function is described by one string, so that the console
+ *  prints one line for each.
+ *  \param count Optional; the number of functions to describe.  Defaults to 5.
+ *  \returns A string for each function
+ */
+int Simulation_Lua::GetScriptProfile(lua_State *L){
+	int n = lua_gettop(L);  // Number of arguments
+	if( n > 1 )
+		return luaL_error(L, "Got %d arguments expected 0 or 1 (count)", n);
+
+	int count = (n==1) ? luaL_checkint(L,1) : 5;
+	if( count < 1 ) {
+		return luaL_error(L, "Cannot describe %d functions", count);
+	}
+	vector<string> lines;
+	ScriptProfiler::Describe( &lines, count );
+	if( lines.empty() ) {
+		lua_pushstring(L, ScriptProfiler::IsEnabled() ? "Nothing has been measured yet." : "The script profiler is stopped.  Start it with Epiar.scriptProfiler(true)." );
+		return 1;
+	}
+	for( unsigned int i = 0; i < lines.size(); i++ ) {
+		lua_pushstring(L, lines[i].c_str() );
+	}
+	return lines.size();
+}
+
+/** \brief Run ai.lua again and pick up the changes to its State Machines.
+ *  \details The AIs keep their states, and the data in AIData is kept.
+ *  \returns Whether ai.lua was loaded
+ */
+int Simulation_Lua::ReloadAI(lua_State *L){
+	int n = lua_gettop(L);  // Number of arguments
+	if( n != 0 )
+		return luaL_error(L, "Got %d arguments expected 0", n);
+
+	// ai.lua starts AIData over, but the AIs are still using it
+	lua_getglobal(L, "AIData");
+	bool loaded = Lua::Load("Resources/Scripts/ai.lua");
+	if( loaded ) {
+		lua_setglobal(L, "AIData");
+		StateMachine::Reload(L);
+	}
+	lua_pushboolean(L, loaded );
+	return 1;
+}
+
 /** \brief Get list of Sprites
  *  \details Optionally accepts an X,Y Coordinate and radius to limit which sprites are returned
  *  \returns list of sprites
@@ -601,29 +774,33 @@ int Simulation_Lua::GetSpriteByID(lua_State *L){
 int Simulation_Lua::GetSprites(lua_State *L, int kind){
 	int n = lua_gettop(L);  // Number of arguments
 
-	list<Sprite *> *sprites = NULL;
+	static vector<Sprite *> sprites;
+
 	if( n==3 ){
 		double x = luaL_checknumber (L, 1);
 		double y = luaL_checknumber (L, 2);
 		double r = luaL_checknumber (L, 3);
-		sprites = GetSimulation(L)->GetSpriteManager()->GetSpritesNear(Coordinate(x,y),static_cast<float>(r),kind);
+		GetSimulation(L)->GetSpriteManager()->GetSpritesNear(Coordinate(x,y),static_cast<float>(r),&sprites,kind);
+		SpriteManager::SortByDistance(Coordinate(x,y),&sprites);
 	} else {
-		sprites = GetSimulation(L)->GetSpriteManager()->GetSprites(kind);
+		list<Sprite *> *all = GetSimulation(L)->GetSpriteManager()->GetSprites(kind);
+		sprites.assign( all->begin(), all->end() );
+		delete all;
 	}
 
 	// Populate a Lua table with Sprites
-	lua_createtable(L, sprites->size(), 0);
+	lua_createtable(L, sprites.size(), 0);
 	int newTable = lua_gettop(L);
 	int index = 1;
-	list<Sprite *>::const_iterator iter = sprites->begin();
-	while(iter != sprites->end()) {
+	vector<Sprite *>::const_iterator iter = sprites.begin();
+	while(iter != sprites.end()) {
 		// push userdata
 		PushSprite(L,(*iter));
 		lua_rawseti(L, newTable, index);
 		++iter;
 		++index;
 	}
-	delete sprites;
+	sprites.clear();
 	return 1;
 }
 
@@ -702,6 +879,84 @@ int Simulation_Lua::GetGates(lua_State *L){
 	return 1;
 }
 
+/** Plan the shortest route from a Sprite to a Planet or Gate
+ * \details The route is planned by the RoutePlanner, so nearby Sprites share it.
+ * \param id The Sprite ID.
+ * \param destination The name of a Planet or Gate.
+ * \returns The names of each Gate to fly into, followed by the Gate that it
+ *          leads to, and then the destination.  Nil if the Sprite or the
+ *          destination doesn't exist.
+ */
+int Simulation_Lua::GetRoute(lua_State *L){
+	int n = lua_gettop(L);  // Number of arguments
+	if( n!=2 )
+		return luaL_error(L, "Got %d arguments expected 2 (SpriteID, destination)", n);
+
+	int id = (int)(luaL_checkint(L,1));
+	string destination = luaL_checkstring(L,2);
+	Sprite* sprite = GetSimulation(L)->GetSpriteManager()->GetSpriteByID(id);
+	if(sprite==NULL){
+		return 0;
+	}
+
+	vector<string> waypoints;
+	if( !RoutePlanner::Route( sprite->GetWorldPosition(), destination, &waypoints ) ){
+		return 0;
+	}
+
+	lua_createtable(L, waypoints.size(), 0);
+	int newTable = lua_gettop(L);
+	for( unsigned int w = 0; w < waypoints.size(); ++w ){
+		lua_pushstring(L, waypoints[w].c_str());
+		lua_rawseti(L, newTable, w+1);
+	}
+	return 1;
+}
+
+/** Search for the Sprites nearest to a Ship or a position
+ * \details
+ * The Lua arguments start either with a Ship (which is ignored while
+ * searching) or with an x,y position.  They may be followed by a range,
+ * and when countAndKind is set, by a count and a Sprite type mask.
+ * \returns The Sprites, nearest first, or NULL if the Ship doesn't exist.
+ *          The vector is reused by the next search.
+ */
+static vector<Sprite*>* NearestSpritesFromArgs(lua_State *L, int kind, bool countAndKind) {
+	static vector<Sprite*> sprites;
+	int arg;
+	float r = QUADRANTSIZE;
+	unsigned int count = 1;
+	Coordinate position;
+	Sprite* exclude = NULL;
+
+	// Get the target position
+	if( lua_isnumber(L,1) && lua_isnumber(L,2) ){
+		position = Coordinate( luaL_checknumber(L, 1), luaL_checknumber(L, 2) );
+		arg = 3;
+	} else {
+		exclude = (Sprite*)AI_Lua::checkShip(L,1);
+		if( exclude == NULL ) {
+			return NULL;
+		}
+		position = exclude->GetWorldPosition();
+		arg = 2;
+	}
+
+	if( lua_isnumber(L,arg) )
+		r = static_cast<float>( luaL_checknumber(L,arg) );
+	arg++;
+	if( countAndKind ) {
+		if( lua_isnumber(L,arg) )
+			count = static_cast<unsigned int>( luaL_checkinteger(L,arg) );
+		arg++;
+		if( lua_isnumber(L,arg) )
+			kind = luaL_checkinteger(L,arg);
+	}
+
+	Simulation_Lua::GetSimulation(L)->GetSpriteManager()->GetNearestSprites( position, r, count, &sprites, kind, exclude );
+	return &sprites;
+}
+
 /** Get the nearest Sprite to another sprite
  * \details 
  * This takes 2 lua arguments:
@@ -709,6 +964,7 @@ int Simulation_Lua::GetGates(lua_State *L){
 *             This sprite will be ignored while searching.
 *  - A Range: the max distance from the sprite.
  * \returns The nearest Sprite
+ * \see Simulation_Lua::GetNearestSprites
  */
 int Simulation_Lua::GetNearestSprite(lua_State *L,int kind) {
 	int n = lua_gettop(L);  // Number of arguments
@@ -716,27 +972,13 @@ int Simulation_Lua::GetNearestSprite(lua_State *L,int kind) {
 		return luaL_error(L, "Got %d arguments expected 1,2 ( ship, [range] ) or 2,3 (x,y,[range])", n);
 	}
 
-	Sprite *closest;
-	float r = QUADRANTSIZE;
-	SpriteManager* sprites = GetSimulation(L)->GetSpriteManager();
-
-	// Get the target position
-	if( lua_isnumber(L,1) && lua_isnumber(L,2) ){
-		Coordinate position( luaL_checknumber(L, 1), luaL_checknumber(L, 2) );
-		if( lua_isnumber(L,3) )
-			r = luaL_checknumber(L,3);
-		closest = sprites->GetNearestSprite( position, r, kind );
-
-	} else {
-		Sprite* target = (Sprite*)AI_Lua::checkShip(L,1);
-		if( target == NULL ) {
-			return 0;
-		}
-		if( lua_isnumber(L,2) )
-			r = luaL_checknumber(L,2);
-		closest = sprites->GetNearestSprite( target, r, kind );
+	vector<Sprite*> *sprites = NearestSpritesFromArgs(L, kind, false);
+	if( sprites == NULL ) {
+		return 0;
 	}
 
+	Sprite *closest = sprites->empty() ? NULL : sprites->front();
+
 	if(closest!=NULL){
 		assert(closest->GetDrawOrder() & (kind));
 		PushSprite(L,(closest));
@@ -746,6 +988,42 @@ int Simulation_Lua::GetNearestSprite(lua_State *L,int kind) {
 	}
 }
 
+/** Get the Sprites nearest to another sprite or a position
+ * \details
+ * This takes up to 5 lua arguments:
+ *  - A Sprite, or an x and y position: the center of the search.
+ *             A Sprite will be ignored while searching.
+ *  - A Range: the max distance from the center (optional).
+ *  - A Count: the max number of Sprites to return (optional, default 1).
+ *  - A Kind: the SPRITE_* types to search for, added together (optional, default all).
+ * \returns A list of Sprites, nearest first
+ */
+int Simulation_Lua::GetNearestSprites(lua_State *L) {
+	int n = lua_gettop(L);  // Number of arguments
+	if( n<1 || n>5 ){
+		return luaL_error(L, "Got %d arguments expected 1-4 ( ship, [range], [count], [kind] ) or 2-5 (x,y,[range],[count],[kind])", n);
+	}
+
+	vector<Sprite*> *sprites = NearestSpritesFromArgs(L, DRAW_ORDER_ALL, true);
+	if( sprites == NULL ) {
+		lua_newtable(L);
+		return 1;
+	}
+
+	// Populate a Lua table with Sprites
+	lua_createtable(L, sprites->size(), 0);
+	int newTable = lua_gettop(L);
+	int index = 1;
+	vector<Sprite *>::const_iterator iter = sprites->begin();
+	while(iter != sprites->end()) {
+		PushSprite(L,(*iter));
+		lua_rawseti(L, newTable, index);
+		++iter;
+		++index;
+	}
+	return 1;
+}
+
 /** Get the nearest Ship to another sprite
  * \param[in] A Sprite to use as the base location for the search.  This sprite will be ignored while searching.
  * \returns The nearest Ship
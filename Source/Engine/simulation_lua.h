@@ -53,11 +53,20 @@ class Simulation_Lua{
 		static int GetSpriteByID(lua_State *L);
 		static int GetSprites(lua_State *L, int type);
 		static int GetNearestSprite(lua_State *L, int type=DRAW_ORDER_ALL);
+		static int GetNearestSprites(lua_State *L);
 		static int GetNearestShip(lua_State *L);
 		static int GetNearestPlanet(lua_State *L);
+		static int SetInteresting(lua_State *L);
+		static int GetPoolStats(lua_State *L);
+		static int SetProfiler(lua_State *L);
+		static int GetProfile(lua_State *L);
+		static int SetScriptProfiler(lua_State *L);
+		static int GetScriptProfile(lua_State *L);
+		static int ReloadAI(lua_State *L);
 		static int GetShips(lua_State *L);
 		static int GetPlanets(lua_State *L);
 		static int GetGates(lua_State *L);
+		static int GetRoute(lua_State *L);
 
 		// Game Components
 		static int GetCommodityNames(lua_State *L);
@@ -239,6 +239,10 @@ void Animation::Draw( int x, int y, float ang ) {
 }
 
 
+/**\fn Animation::GetCurrentFrame( void )
+ *  \brief Returns the Image that Draw would draw right now.
+ */
+
 /**\brief Resets animation data back to the first frame.
  */
 void Animation::Reset( void ) {
@@ -39,6 +39,7 @@ class Animation {
 		Animation( string filename );
 		bool Update( void );
 		void Draw( int x, int y, float ang );
+		Image* GetCurrentFrame( void ) { return ani->GetFrame( fnum ); }
 		void SetLoopPercent( float loopPercent );
 		float GetLoopPercent( void ) { return loopPercent; };
 		void Reset( void );
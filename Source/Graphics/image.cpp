@@ -129,6 +129,12 @@ bool Image::Load( char *buf, int bufSize ) {
 	w = s->w;
 	h = s->h;
 
+	// Without a display there is nowhere to put a texture
+	if( Video::IsHeadless() ) {
+		SDL_FreeSurface( s );
+		return( true );
+	}
+
 	if( ConvertToTexture( s ) == false ) {
 		LogMsg(WARN, "Failed to load image from buffer" );
 		SDL_FreeSurface( s );
@@ -234,6 +240,76 @@ void Image::DrawCentered( int x, int y, float angle ) {
 	Draw( x - (w / 2), y - (h / 2), angle );
 }
 
+/**\brief Draw a copy of the image centered on each placement (angles are in degrees)
+ * \details Each copy looks exactly like a DrawCentered one, but the texture
+ *          is bound once and every copy goes into the same set of quads.
+ */
+void Image::DrawCenteredBatch( const vector<ImagePlacement>& placements ) {
+	// the four rotated (if needed) corners of each copy
+	float ulx, urx, llx, lrx, uly, ury, lly, lry;
+
+	if( placements.empty() ) {
+		return;
+	}
+	assert(image);
+	if( !image ) {
+		LogMsg(WARN, "Trying to draw without loading an image first." );
+		return;
+	}
+
+	Trig *trig = Trig::Instance();
+
+	glPushMatrix();
+
+	glEnable(GL_TEXTURE_2D); // Enable 2D Texture Mapping
+	glEnable(GL_BLEND);
+	glDisable(GL_DEPTH_TEST);
+
+	glColor4f(1.f, 1.f, 1.f, 1.f);
+	glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glBindTexture( GL_TEXTURE_2D, image );
+
+	glBegin( GL_QUADS );
+	vector<ImagePlacement>::const_iterator p;
+	for( p = placements.begin(); p != placements.end(); ++p ) {
+		int x = p->x - (w / 2);
+		int y = p->y - (h / 2);
+		if( p->angle != 0.f ) {
+			float a = (float)trig->DegToRad( p->angle );
+			float ax = static_cast<float>(x + (w / 2.));
+			float ay = static_cast<float>(y + (h / 2.));
+
+			trig->RotatePoint( (float)x, (float)y + h, ax, ay, (float *)&ulx, (float *)&uly, a );
+			trig->RotatePoint( (float)x + w, (float)y + h, ax, ay, (float *)&urx, (float *)&ury, a );
+			trig->RotatePoint( (float)x, (float)y, ax, ay, (float *)&llx, (float *)&lly, a );
+			trig->RotatePoint( (float)x + w, (float)y, ax, ay, (float *)&lrx, (float *)&lry, a );
+		} else {
+			ulx = static_cast<float>(x);
+			urx = static_cast<float>(x + w);
+			llx = static_cast<float>(x);
+			lrx = static_cast<float>(x + w);
+			uly = static_cast<float>(y + h);
+			ury = static_cast<float>(y + h);
+			lly = static_cast<float>(y);
+			lry = static_cast<float>(y);
+		}
+		glTexCoord2f( 0., 0. ); glVertex2f( llx, lly );
+		glTexCoord2f( scale_w, 0. ); glVertex2f( lrx, lry );
+		glTexCoord2f( scale_w, scale_h ); glVertex2f( urx, ury );
+		glTexCoord2f( 0., scale_h ); glVertex2f( ulx, uly );
+	}
+	glEnd();
+
+	glEnable(GL_DEPTH_TEST); // Enable Depth Testing
+	glDisable(GL_BLEND); // Disable Blending
+
+	glDisable(GL_TEXTURE_2D); // Disable 2D Texture Mapping
+	glBindTexture(GL_TEXTURE_2D,0); // Unbind The Blur Texture
+
+	glPopMatrix();
+}
+
 /**\brief Draw the image stretched within to a box
  */
 void Image::DrawStretch( int x, int y, int box_w, int box_h, float angle ) {
@@ -22,6 +22,13 @@
 #include "includes.h"
 #include "Utilities/resource.h"
 
+/**\brief Where one copy of an Image is drawn by Image::DrawCenteredBatch.
+ */
+struct ImagePlacement {
+	int x, y;     ///< The center of the copy, in screen coordinates.
+	float angle;  ///< The rotation of the copy, in degrees.
+};
+
 class Image : public Resource {
 	public:
 		Image();
@@ -50,6 +57,8 @@ class Image : public Resource {
 		void DrawAlpha( int x, int y, float alpha );
 		// Draw the image centered on (x,y) (angle in degrees)
 		void DrawCentered( int x, int y, float angle = 0. );
+		// Draw many copies of the image centered on each placement, all at once
+		void DrawCenteredBatch( const vector<ImagePlacement>& placements );
 		// Draw the image tiled to fill a rectangle of w/h - will crop to meet w/h and won't overflow
 		void DrawTiled( int x, int y, int w, int h, float alpha = 1. );
 		// Draw the image stretched within to a box
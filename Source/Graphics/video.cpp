@@ -145,6 +145,7 @@ int Video::w2 = 0;
 int Video::h2 = 0;
 stack<Rect> Video::cropRects;
 SDL_Surface *Video::screen = NULL;
+bool Video::headless = false;
 
 /**\brief Initializes the Video display.
  */
@@ -186,9 +187,37 @@ bool Video::Initialize( void ) {
 	return( true );
 }
 
+/**\brief Initializes Video without a display, for running the Simulation alone.
+ * \details No window or OpenGL context is created, so nothing may be drawn.
+ *          Images are still loaded so that their sizes are known, but they
+ *          are not turned into textures.  The screen keeps the size from the
+ *          options so that the Camera still works.
+ */
+bool Video::InitializeHeadless( void ) {
+	// SDL is still needed for its clock
+	if( SDL_Init( SDL_INIT_TIMER ) != 0 ) {
+		LogMsg(ERR, "Could not initialize SDL: %s", SDL_GetError() );
+		return( false );
+	}
+	atexit( SDL_Quit );
+
+	headless = true;
+	w = OPTION( int, "options/video/w" );
+	h = OPTION( int, "options/video/h" );
+	w2 = w / 2;
+	h2 = h / 2;
+
+	LogMsg(INFO, "Running without a display." );
+
+	return( true );
+}
+
 /**\brief Shuts down the Video display.
  */
 bool Video::Shutdown( void ) {
+	if( headless ) {
+		return( true );
+	}
 	
 	EnableMouse();
 
@@ -62,7 +62,9 @@ class Rect {
 class Video {
  	public:
 		static bool Initialize( void );
+		static bool InitializeHeadless( void );
 		static bool Shutdown( void );
+		static bool IsHeadless( void ) { return headless; }
 		
   		static bool SetWindow( int w, int h, int bpp, bool fullscreen );
 
@@ -118,6 +120,7 @@ class Video {
 		static int w2, h2; // width/height divided by 2
 		static stack<Rect> cropRects;
 		static SDL_Surface *screen; // pointer to main video surface
+		static bool headless; // true when there is no window to draw to
 };
 
 #endif // __H_VIDEO__
@@ -11,7 +11,11 @@
 #include "Sprites/ai.h"
 #include "Sprites/player.h"
 #include "Sprites/spritemanager.h"
+#include "Sprites/statemachine.h"
 #include "Utilities/lua.h"
+#include "Utilities/options.h"
+#include "Utilities/scriptprofiler.h"
+#include "Utilities/timer.h"
 #include "Engine/simulation_lua.h"
 
 /** \addtogroup Sprites
@@ -26,50 +30,71 @@
 /** \brief AI Constructor
  */
 
-AI::AI(string _name, string machine) :
+Uint32 AI::thinkFrame = 0;
+double AI::thinkSpent = 0.0;
+Uint32 AI::thinkBudget = 0;
+int AI::defaultThinkInterval = 1;
+bool AI::batching = true;
+double AI::batchCost = 0.0;
+
+AI::AI(string _name, string _machine) :
 	name(_name),
 	allegiance(NULL),
-	stateMachine(machine),
-	state("default")
+	stateMachine(_machine),
+	state("default"),
+	machine(NULL),
+	stateID(-1),
+	nextThink(0),
+	heldAccelerate(false),
+	heldTurn(0.0f)
 {
 	this -> playerCheck = false;
 	target = 0;
 	merciful = 0;
 }
 
+/** \brief Read the options that control how often the AIs Decide.
+ *  \details These are kept rather than looked up on every Update.
+ */
+void AI::LoadThinkOptions() {
+	thinkBudget = OPTION(Uint32, "options/simulation/ai-think-budget");
+	defaultThinkInterval = OPTION(int, "options/simulation/ai-think-interval");
+	if( defaultThinkInterval < 1 ) {
+		defaultThinkInterval = 1;
+	}
+	batching = OPTION(int, "options/simulation/ai-batch") != 0;
+}
+
+/** \brief Learn what a batched Decide costs from the batches of a tick.
+ *  \param spent Microseconds that StateMachine::RunBatches took.
+ *  \param count The number of AIs that it Decided.
+ *  \details Batches run after every AI has thought, so Think charges each
+ *  batched AI this average against the think budget instead.
+ */
+void AI::ChargeBatches( Uint64 spent, unsigned int count ) {
+	if( count == 0 ) {
+		return;
+	}
+	double cost = double( spent ) / double( count );
+	batchCost = ( batchCost == 0.0 ) ? cost : ( 0.75 * batchCost + 0.25 * cost );
+}
+
 /** \brief Run the Lua Statemachine to act and possibly change state.
+ *  \details Besides the new state, the state function may return the number
+ *  of ticks until this AI should Decide again.
+ *
+ *  The state function comes straight from the compiled StateMachine, so only
+ *  the name of a new state is looked up.
+ *  \pre ResolveState has succeeded.
+ *  \return The ticks until the next Decide, or 0 to use the state's interval.
  */
 
-void AI::Decide( lua_State *L ) {
-	string newstate;
+int AI::Decide( lua_State *L ) {
 	// Decide
 	const int initialStackTop = lua_gettop(L);
 
-	// Get the current state machine
-	lua_getglobal(L, stateMachine.c_str() );
-	int machineIndex = lua_gettop(L);
-	if( ! lua_istable(L, machineIndex) )
-	{
-		LogMsg(ERR, "There is no State Machine named '%s'!", stateMachine.c_str() );
-		return; // This ship will just sit idle...
-	}
-
-	// Get the current state
-	lua_pushstring(L, state.c_str() );
-	lua_gettable(L, machineIndex);
-	if( ! lua_isfunction(L,lua_gettop(L)) )
-	{
-		LogMsg(WARN, "The State Machine '%s' has no state '%s'.", stateMachine.c_str(), state.c_str() );
-		lua_getglobal(L, stateMachine.c_str() );
-		lua_pushstring(L, "default" );
-		lua_gettable(L,machineIndex);
-		if( !lua_isfunction(L,lua_gettop(L)) )
-		{
-			LogMsg(ERR, "The State Machine '%s' has no default state.", stateMachine.c_str() );
-			lua_settop(L, initialStackTop);
-			return; // This ship will just sit idle...
-		}
-	}
+	// Get the current state, which ResolveState has found
+	machine->PushState( L, stateID );
 
 	// Push Current AI Variables
 	lua_pushinteger( L, this->GetID() );
@@ -81,33 +106,106 @@ void AI::Decide( lua_State *L ) {
 
 	// Run the current AI state
 	//printf("Call:"); Lua::stackDump(L); // DEBUG
-	if( lua_pcall(L, 6, 1, 0) != 0)
+	ScriptTimer timer( L );
+	int failed = lua_pcall(L, 6, 2, 0);
+	timer.Stop( stateMachine, state );
+	if( failed != 0 )
 	{
 		LogMsg(ERR,"Failed to run %s(%s): %s\n", stateMachine.c_str(), state.c_str(), lua_tostring(L, -1));
 		lua_settop(L, initialStackTop);
-		return;
+		return 0;
 	}
 	//printf("Return:"); Lua::stackDump(L); // DEBUG
 
-	if( lua_isstring( L, lua_gettop(L) ) )
+	int interval = 0;
+	if( lua_isnumber( L, lua_gettop(L) ) )
 	{
-		newstate = (string)luaL_checkstring(L, lua_gettop(L));
+		interval = lua_tointeger( L, lua_gettop(L) );
+	}
 
+	if( lua_isstring( L, lua_gettop(L) - 1 ) )
+	{
 		// Verify that this new state exists
-		lua_pushstring(L, newstate.c_str() );
-		lua_gettable(L,machineIndex);
-		if( lua_isfunction(L, lua_gettop(L) ))
+		int newStateID = machine->GetStateAt( L, lua_gettop(L) - 1 );
+		if( newStateID >= 0 )
 		{
-			state = newstate;
+			if( newStateID != stateID ) {
+				stateID = newStateID;
+				state = machine->GetStateName( stateID );
+			}
 		} else {
-			LogMsg(ERR, "The State Machine '%s' has no state '%s'. Could not transition from '%s'. Resetting StateMachine.", stateMachine.c_str(), newstate.c_str(), state.c_str() );
+			LogMsg(ERR, "The State Machine '%s' has no state '%s'. Could not transition from '%s'. Resetting StateMachine.", stateMachine.c_str(), lua_tostring(L, lua_gettop(L) - 1), state.c_str() );
 			state = "default"; // Reset the state
+			stateID = -1;
 		}
 		//printf("Changing State:"); Lua::stackDump(L); // DEBUG
 	}
 
 	//printf("Complete:");Lua::stackDump(L); // DEBUG
 	lua_settop(L,initialStackTop);
+	return interval;
+}
+
+/** \brief Look up the compiled State Machine and the number of the current state.
+ *  \details An AI whose state is gone falls back to the default state.
+ *  \return false if there is no such State Machine or it has no default state.
+ */
+bool AI::ResolveState( lua_State *L ) {
+	// Get the current state machine
+	if( machine == NULL )
+	{
+		machine = StateMachine::Get( L, stateMachine );
+		if( machine == NULL )
+		{
+			LogMsg(ERR, "There is no State Machine named '%s'!", stateMachine.c_str() );
+			return false;
+		}
+		stateID = -1;
+	}
+
+	if( stateID < 0 )
+	{
+		stateID = machine->GetState( state );
+	}
+	if( ! machine->HasState( stateID ) )
+	{
+		LogMsg(WARN, "The State Machine '%s' has no state '%s'.", stateMachine.c_str(), state.c_str() );
+		state = "default";
+		stateID = machine->GetState( state );
+		if( stateID < 0 )
+		{
+			LogMsg(ERR, "The State Machine '%s' has no default state.", stateMachine.c_str() );
+			return false;
+		}
+	}
+	return true;
+}
+
+/**\brief Carry out what a batched state decided for this AI.
+ * \details The AI turns before it accelerates, like the Lua states do.
+ * \see StateMachine::RunBatches
+ */
+void AI::ApplyDecision( const AIDecision& decision ) {
+	ClearMoveCommands();
+	if( decision.rotate != 0.0f ) {
+		Rotate( decision.rotate );
+	}
+	if( decision.accelerate ) {
+		Accelerate();
+	}
+	if( decision.fire & AI_FIRE_PRIMARY ) {
+		FirePrimary( decision.target );
+	}
+	if( decision.fire & AI_FIRE_SECONDARY ) {
+		FireSecondary( decision.target );
+	}
+
+	// The State Machine may have been changed from Lua during the batch
+	if( machine != NULL && decision.state >= 0 && decision.state != stateID ) {
+		stateID = decision.state;
+		state = machine->GetStateName( stateID );
+	}
+	Schedule( decision.interval );
 }
 
 /**\brief Updates the AI controlled ship by first calling the Lua function
@@ -124,13 +222,111 @@ void AI::Update( lua_State *L ) {
 		}
 	}
 	if( !this->IsDisabled() ) {
-		this->Decide( L );
+		this->Think( L );
 	}
 
 	// Now act like a normal ship
 	this->Ship::Update( L );
 }
 
+/**\brief Decide if it is time to, otherwise keep doing what was last decided.
+ * \details Each state Decides every few ticks, as set by the ThinkIntervals
+ * table in Lua.  Once the Decides of a tick have taken the think budget, the
+ * AIs that are due wait for a later tick, unless they are urgent or have
+ * already waited a whole interval.
+ *
+ * Between Decides the AI keeps accelerating if it last did, and finishes the
+ * turn that it last asked for.
+ *
+ * States with a Batch version are only queued here, and are Decided along
+ * with the rest of their State Machine once every AI has thought.  They are
+ * charged what a batched Decide has cost on average, so the budget covers
+ * them too.
+ * \see StateMachine::RunBatches
+ */
+void AI::Think( lua_State *L ) {
+	Uint32 frame = Timer::GetLogicalFrameCount();
+	if( frame != thinkFrame ) {
+		thinkFrame = frame;
+		thinkSpent = 0;
+	}
+
+	bool due = ( frame >= nextThink );
+	bool overdue = due && ( frame >= nextThink + GetStateInterval() );
+	bool affordable = ( thinkBudget == 0 || thinkSpent < thinkBudget );
+	if( !( due && ( affordable || overdue ) ) && !IsUrgent() ) {
+		if( heldAccelerate ) {
+			Accelerate();
+		}
+		if( heldTurn != 0.0f ) {
+			Rotate( heldTurn );
+			heldTurn = GetUnfinishedTurn();
+		}
+		return;
+	}
+
+	if( ! ResolveState( L ) ) {
+		// This ship will just sit idle...
+		ClearMoveCommands();
+		Schedule( 0 );
+		return;
+	}
+	if( batching && machine->IsBatched( stateID ) ) {
+		// Decided along with the other AIs of this State Machine
+		machine->Enqueue( this, stateID );
+		thinkSpent += batchCost;
+		return;
+	}
+
+	Uint64 started = Timer::GetMicroseconds();
+	ClearMoveCommands();
+	int interval = Decide( L );
+	thinkSpent += double( Timer::GetMicroseconds() - started );
+	Schedule( interval );
+}
+
+/**\brief Keep doing what was just Decided until the next Decide.
+ * \param interval Ticks until the next Decide, or 0 to use the state's interval.
+ */
+void AI::Schedule( int interval ) {
+	heldAccelerate = HasAccelerated();
+	heldTurn = GetUnfinishedTurn();
+
+	if( interval <= 0 ) {
+		interval = GetStateInterval();
+	}
+	bool first = ( nextThink == 0 );
+	nextThink = Timer::GetLogicalFrameCount() + interval;
+	if( first ) {
+		// Spread the AIs created together over the ticks
+		nextThink += GetID() % interval;
+	}
+}
+
+/**\brief Whether this AI must Decide on every tick.
+ * \details AIs that are fighting or near the player are watched closely.
+ */
+bool AI::IsUrgent() {
+	if( !enemies.empty() ) {
+		return true;
+	}
+	Sprite *player = SpriteManager::Instance()->GetPlayer();
+	return ( player != NULL && InRange( player->GetWorldPosition(), GetWorldPosition() ) );
+}
+
+/**\brief The ticks between Decides in the current state.
+ * \details The interval comes from the ThinkIntervals table in Lua, by the
+ *          name of the state, and is read when the StateMachine is compiled.
+ *          States without an entry use "options/simulation/ai-think-interval".
+ */
+int AI::GetStateInterval() {
+	int interval = 0;
+	if( machine != NULL && stateID >= 0 ) {
+		interval = machine->GetInterval( stateID );
+	}
+	return ( interval > 0 ) ? interval : defaultThinkInterval;
+}
+
 /**\brief The last function call to the ship before it get's deleted
  *
  * At this point, the ship still exists. It has not been removed from the Universe
@@ -175,10 +371,10 @@ void AI::Draw(){
 int AI::ChooseTarget( lua_State *L ){
 	//printf("choosing target\n");
 	SpriteManager *sprites = Simulation_Lua::GetSimulation(L)->GetSpriteManager();
-	list<Sprite*> *nearbySprites = sprites->GetSpritesNear(this->GetWorldPosition(), COMBAT_RANGE, DRAW_ORDER_SHIP);
+	sprites->GetSpritesNear(this->GetWorldPosition(), COMBAT_RANGE, &nearbySprites, DRAW_ORDER_SHIP);
 	
-	nearbySprites->sort(CompareAI);
-	list<Sprite*>::iterator it;
+	sort( nearbySprites.begin(), nearbySprites.end(), CompareAI );
+	vector<Sprite*>::iterator it;
 	list<enemy>::iterator enemyIt=enemies.begin();
 	//printf("printing list of enemies\n");
 	//printf("the size of enemies = %d\n", enemies.size() );
@@ -192,21 +388,21 @@ int AI::ChooseTarget( lua_State *L ){
 	}
 	
 	//printf("printing list of nearby it->GetTarget()\n");
-	//int nearbySpritesSize=(*nearbySprites).size();
+	//int nearbySpritesSize=nearbySprites.size();
 	//printf("the size of nearbySprites = %d\n",nearbySpritesSize);
-	/*for(it=nearbySprites->begin(); it!=nearbySprites->end(); it++){
+	/*for(it=nearbySprites.begin(); it!=nearbySprites.end(); it++){
 		if( (*it)->GetDrawOrder() ==DRAW_ORDER_SHIP )
 			printf("it->GetTarget() = %d\n",((AI*)(*it))->GetTarget() );
 		printf("it->GetID() = %d\n",(*it)->GetID() );
 
 	}*/
-	it=nearbySprites->begin();
+	it=nearbySprites.begin();
 	enemyIt=enemies.begin();
 	int max=0,currTarget=-1;
 	int threat=0;
 	//printf("starting sprite iteration\n");
 		
-	for(it= nearbySprites->begin(); it!=nearbySprites->end() && enemyIt!=enemies.end() ; it++){
+	for(it= nearbySprites.begin(); it!=nearbySprites.end() && enemyIt!=enemies.end() ; it++){
 		if( (*it)->GetID()== this->GetID() )
 			continue;
 
@@ -232,8 +428,9 @@ int AI::ChooseTarget( lua_State *L ){
 					enemyIt++;
 				}
 				//printf("successfully completed enemyIt iteration\n");
-				it--;
-				continue;
+				// The remaining enemies are checked against this same Sprite below
+				if( enemyIt==enemies.end() )
+					break;
 			}
 			if( enemyIt->id == ((AI*) (*it))->GetTarget() )
 				threat-= ( (Ship*)(*it) )->GetTotalCost();
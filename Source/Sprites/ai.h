@@ -13,6 +13,9 @@
 #include "Engine/alliances.h"
 #include "includes.h"
 
+class StateMachine;
+struct AIDecision;
+
 #define COMBAT_RANGE 1000 ///< Radius of ships involved in any specific battle
 #define COMBAT_RANGE_SQUARED (COMBAT_RANGE*COMBAT_RANGE) ///< Used for fast range checking.
 
@@ -35,10 +38,14 @@ class AI : public Ship {
 		// State Machine Mechanics:
 
 		string GetStateMachine() { return stateMachine; }
-		void SetStateMachine(string _machine) { stateMachine = _machine; }
+		void SetStateMachine(string _machine) { stateMachine = _machine; machine = NULL; stateID = -1; Reschedule(); }
 
 		string GetState() { return state; }
-		void SetState(string _state)  { state = _state; }
+		void SetState(string _state)  { state = _state; stateID = -1; Reschedule(); }
+
+		static void LoadThinkOptions();
+		static void ChargeBatches( Uint64 spent, unsigned int count );
+		void ApplyDecision( const AIDecision& decision );
 
 		// Combat Mechanics:
 
@@ -61,7 +68,28 @@ class AI : public Ship {
 		// The state machine is essentially a flow chart
 		string stateMachine; ///< The name of the State Machine.
 		string state; ///< The current state of the state machine.
-		void Decide( lua_State *L );
+		StateMachine *machine; ///< The compiled State Machine, or NULL if it hasn't been looked up.
+		int stateID; ///< The number of the current state in the machine, or -1 if it hasn't been looked up.
+		int Decide( lua_State *L );
+		bool ResolveState( lua_State *L );
+
+		// The AI only Decides every few ticks
+		Uint32 nextThink; ///< The logical frame of the next Decide.  0 Decides on the next Update.
+		bool heldAccelerate; ///< Whether the last Decide accelerated.  The ticks until the next Decide do too.
+		float heldTurn; ///< The part of the last Decide's turn that is still to be made, in degrees.
+
+		static Uint32 thinkFrame; ///< The logical frame that thinkSpent belongs to.
+		static double thinkSpent; ///< Microseconds spent Deciding during thinkFrame, counting each batched AI at batchCost.
+		static Uint32 thinkBudget; ///< Microseconds per tick that Deciding may take before the AIs that aren't urgent wait.
+		static int defaultThinkInterval; ///< Ticks between Decides in states without a ThinkIntervals entry.
+		static bool batching; ///< Whether states with a Batch version Decide together.  See StateMachine::RunBatches.
+		static double batchCost; ///< The average microseconds that RunBatches took for each AI.
+
+		void Think( lua_State *L );
+		bool IsUrgent();
+		void Schedule( int interval );
+		int GetStateInterval();
+		void Reschedule() { nextThink = 0; }
 
 		// AI Combat Mechanics:
 
@@ -73,6 +101,7 @@ class AI : public Ship {
 		int target; ///< The enemy that this AI is currently fighting
 		bool merciful; ///< Is this ship merciful to the player?
 		list<enemy> enemies; ///< A list of combatants.  The AI should keep fighting until everything on this list is dead.
+		vector<Sprite*> nearbySprites; ///< The Ships near this AI.
 
 		int CalcCost(int threat, int damage);
 		int ChooseTarget( lua_State *L );
@@ -9,7 +9,6 @@
 #include "includes.h"
 #include "common.h"
 #include "Utilities/lua.h"
-#include "Sprites/effects.h"
 #include "Sprites/player.h"
 #include "Sprites/planets.h"
 #include "Sprites/planets_lua.h"
@@ -331,7 +330,7 @@ int AI_Lua::ShipRepair(lua_State* L){
 }
 
 /**\brief Lua callable function to explode the ship.
- * \sa Effect
+ * \sa ParticleSystem
  */
 int AI_Lua::ShipExplode(lua_State* L){
 	int n = lua_gettop(L);  // Number of arguments
@@ -344,8 +343,8 @@ int AI_Lua::ShipExplode(lua_State* L){
 		if(OPTION(int, "options/sound/explosions"))
 			explodesnd->Play(
 				(ai)->GetWorldPosition() - Simulation_Lua::GetSimulation(L)->GetCamera()->GetFocusCoordinate());
-		Simulation_Lua::GetSimulation(L)->GetSpriteManager()->Add(
-			new Effect((ai)->GetWorldPosition(), "Resources/Animations/explosion1.ani", 0) );
+		Simulation_Lua::GetSimulation(L)->GetSpriteManager()->GetParticles()->Emit(
+			"Resources/Animations/explosion1.ani", (ai)->GetWorldPosition(), Coordinate(), 0.0f );
 		Simulation_Lua::GetSimulation(L)->GetSpriteManager()->Delete((Sprite*)(ai));
 	} else {
 		luaL_error(L, "Got %d arguments expected 1 (ship)", n);
@@ -1686,6 +1685,8 @@ int AI_Lua::PlayerAddHiredEscort(lua_State* L){
                 int pay = luaL_checkint (L, 3);
                 int spriteID = luaL_checkint (L, 4);
                 (p)->AddHiredEscort(type, pay, spriteID);
+                // Escorts fly with the player, so keep their surroundings up to date too.
+                Simulation_Lua::GetSimulation(L)->GetSpriteManager()->SetInteresting(spriteID, true);
         } else {
                 luaL_error(L, "Got %d arguments expected 4 (player, type, pay, spriteID)", n);
         }
@@ -0,0 +1,130 @@
+/**\file			drawlist.cpp
+ * \author			agent (agent@local)
+ * \date			Created: Sunday, October 18, 2026
+ * \date			Modified: Sunday, October 18, 2026
+ * \brief			Collects the Sprites on screen in the order they are drawn.
+ * \details
+ */
+
+#include "includes.h"
+#include "common.h"
+#include "Sprites/drawlist.h"
+#include "Sprites/spritemanager.h"
+#include "Utilities/log.h"
+
+/** \addtogroup Sprites
+ * @{
+ */
+
+/**\brief Orders the entries of a layer by Sprite ID.
+ * \details Since the Sprite ID is unique, this keeps overlapping Sprites in
+ *          the same order from one frame to the next.
+ */
+static bool compareEntryID( const DrawEntry& entry, int id ) {
+	return entry.id < id;
+}
+
+/**\brief Create an empty DrawList.
+ */
+DrawList::DrawList()
+	:frame( 0 )
+	,halfWidth( 0.0f )
+	,halfHeight( 0.0f )
+	,numVisible( 0 )
+	,numCulled( 0 )
+{
+}
+
+/**\brief Collect the Sprites that are on screen.
+ * \param sprites The SpriteManager holding every Sprite.
+ * \param focus The center of the screen.
+ * \param halfWidth Half the width of the screen.
+ * \param halfHeight Half the height of the screen.
+ */
+void DrawList::Build( SpriteManager *sprites, Coordinate focus, float halfWidth, float halfHeight ) {
+	this->focus = focus;
+	this->halfWidth = halfWidth;
+	this->halfHeight = halfHeight;
+	numVisible = 0;
+	numCulled = 0;
+	frame++;
+
+	float r = (halfHeight < halfWidth ? halfWidth : halfHeight) * V_SQRT2;
+	sprites->ForEachSpriteNear( focus, r, DRAW_ORDER_ALL, *this );
+
+	// Drop the Sprites that went out of view or were removed, keeping the order
+	for( int l = 0; l < DRAW_LAYERS; l++ ) {
+		vector<DrawEntry>& layer = layers[l];
+		unsigned int kept = 0;
+		for( unsigned int e = 0; e < layer.size(); e++ ) {
+			if( layer[e].frame == frame ) {
+				layer[kept++] = layer[e];
+			}
+		}
+		layer.resize( kept );
+	}
+}
+
+/**\brief Draw the collected Sprites, bottom layer first.
+ * \param lowest The DRAW_ORDER of the first layer to draw.
+ * \param highest The DRAW_ORDER of the last layer to draw.
+ * \details Drawing the layers in parts lets other things be drawn between them.
+ */
+void DrawList::Draw( int lowest, int highest ) {
+	vector<DrawEntry>::iterator i;
+	int first = GetLayer( lowest );
+	int last = GetLayer( highest );
+	if( first < 0 || last < 0 ) {
+		LogMsg(WARN, "Cannot draw the layers from 0x%04X to 0x%04X.", lowest, highest );
+		return;
+	}
+	for( int l = first; l <= last; l++ ) {
+		for( i = layers[l].begin(); i != layers[l].end(); ++i ) {
+			i->sprite->Draw();
+		}
+	}
+}
+
+/**\brief Keep a Sprite if any of it could be drawn on screen.
+ */
+void DrawList::Visit( Sprite *sprite ) {
+	Coordinate offset = sprite->GetWorldPosition() - focus;
+	float reach = static_cast<float>( sprite->GetDrawRadius() );
+	if( fabs( offset.GetX() ) > halfWidth + reach || fabs( offset.GetY() ) > halfHeight + reach ) {
+		numCulled++;
+		return;
+	}
+
+	int layer = GetLayer( sprite->GetDrawOrder() );
+	if( layer < 0 ) {
+		LogMsg(WARN, "Sprite %d has the unknown draw order 0x%04X.", sprite->GetID(), sprite->GetDrawOrder() );
+		return;
+	}
+
+	// Sprites still in view are found in place, new ones are inserted in order
+	int id = sprite->GetID();
+	vector<DrawEntry>& entries = layers[layer];
+	vector<DrawEntry>::iterator entry = lower_bound( entries.begin(), entries.end(), id, compareEntryID );
+	if( entry == entries.end() || entry->id != id ) {
+		DrawEntry added;
+		added.id = id;
+		entry = entries.insert( entry, added );
+	}
+	entry->sprite = sprite; // The ID may have been handed to a new Sprite
+	entry->frame = frame;
+	numVisible++;
+}
+
+/**\brief Convert a DRAW_ORDER bit into a layer number.
+ * \returns The layer, or -1 if the draw order isn't a single known bit.
+ */
+int DrawList::GetLayer( int drawOrder ) {
+	for( int l = 0; l < DRAW_LAYERS; l++ ) {
+		if( drawOrder == (1 << l) ) {
+			return l;
+		}
+	}
+	return -1;
+}
+
+/** @} */
@@ -0,0 +1,65 @@
+/**\file			drawlist.h
+ * \author			agent (agent@local)
+ * \date			Created: Sunday, October 18, 2026
+ * \date			Modified: Sunday, October 18, 2026
+ * \brief			Collects the Sprites on screen in the order they are drawn.
+ * \details
+ */
+
+#ifndef __h_drawlist__
+#define __h_drawlist__
+
+#include "includes.h"
+#include "Sprites/sprite.h"
+#include "Utilities/spatialindex.h"
+
+class SpriteManager;
+
+#define DRAW_LAYERS 7 ///< The number of DRAW_ORDER bits, from DRAW_ORDER_PLANET to DRAW_ORDER_EFFECT.
+
+/**\class DrawList
+ * \brief The Sprites visible this frame, binned by their DRAW_ORDER.
+ *
+ * \details
+ * Each DRAW_ORDER gets its own layer.  The layers are drawn bottom up and
+ * the Sprites inside a layer are drawn in ID order, so that overlapping
+ * Sprites don't flicker.  The layers are kept in ID order from one frame to
+ * the next: a Sprite coming into view is inserted in its place, and the
+ * Sprites that were not seen this frame are dropped, so nothing is sorted.
+ *
+ * The SpriteManager is searched with the circle around the screen, then every
+ * Sprite found is checked against the screen rectangle, widened by the
+ * Sprite's draw radius.
+ */
+/**\brief A Sprite in a layer of the DrawList.
+ */
+struct DrawEntry {
+	int id;          ///< The ID of the Sprite, which orders the layer.
+	Sprite *sprite;  ///< The Sprite.
+	Uint32 frame;    ///< The last Build that saw the Sprite on screen.
+};
+
+class DrawList : public SpriteVisitor {
+	public:
+		DrawList();
+
+		void Build( SpriteManager *sprites, Coordinate focus, float halfWidth, float halfHeight );
+		void Draw( int lowest = DRAW_ORDER_PLANET, int highest = DRAW_ORDER_EFFECT );
+
+		unsigned int GetNumVisible() const { return numVisible; }
+		unsigned int GetNumCulled() const { return numCulled; }
+
+		void Visit( Sprite *sprite );
+
+	private:
+		static int GetLayer( int drawOrder );
+
+		vector<DrawEntry> layers[DRAW_LAYERS]; ///< The visible Sprites of each DRAW_ORDER, by ID.
+		Uint32 frame;                          ///< The number of the current Build.
+		Coordinate focus;                    ///< The center of the screen.
+		float halfWidth, halfHeight;         ///< Half the size of the screen.
+		unsigned int numVisible;             ///< Sprites drawn by the last Build.
+		unsigned int numCulled;              ///< Sprites found near the screen but not on it.
+};
+
+#endif // __h_drawlist__
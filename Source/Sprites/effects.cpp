@@ -9,10 +9,8 @@
 #include "includes.h"
 #include "Graphics/animation.h"
 #include "Graphics/image.h"
-#include "Sprites/spritemanager.h"
 #include "Sprites/sprite.h"
 #include "Sprites/effects.h"
-#include "Engine/simulation_lua.h"
 
 /** \addtogroup Sprites
  * @{
@@ -20,8 +18,17 @@
 
 /**\class Effect
  * \brief Various Animation effects.
+ * \details Effects are Animations that live in the universe like any other
+ *          Sprite, such as drifting asteroids.  Their memory comes from a
+ *          Pool rather than the heap.
+ *
+ *          Short lived Animations like hits and explosions are played by the
+ *          ParticleSystem instead.
+ * \see ParticleSystem
  */
 
+Pool<Effect> Effect::pool( 128 );
+
 /**\brief Creates a new Effect at specified coordinate with Animation file
  */
 Effect::Effect(Coordinate pos, string filename, float loopPercent) {
@@ -38,11 +45,9 @@ Effect::~Effect() {
 
 /**\brief Updates the Effect
  */
-void Effect::Update( lua_State *L ) {
-	Sprite::Update( L );
+void Effect::UpdateNative( SpriteCommands *commands ) {
 	if( visual->Update() == true ) {
-		SpriteManager *sprites = Simulation_Lua::GetSimulation(L)->GetSpriteManager();
-		sprites->Delete( (Sprite*)this );
+		commands->Delete( (Sprite*)this );
 	}
 }
 
@@ -53,9 +58,35 @@ void Effect::Draw( void ) {
 	visual->Draw( pos.GetScreenX(), pos.GetScreenY(), this->GetAngle());
 }
 
+/**\brief The Animation is drawn centered and rotated on the Effect.
+ */
+int Effect::GetDrawRadius( void ) {
+	return visual->GetHalfWidth() + visual->GetHalfHeight();
+}
+
 /**\fn Effect::GetDrawOrder( )
  *  \brief Returns the Draw order of the Effect
  */
 
+/**\brief Allocate an Effect from the Pool.
+ * \details Anything that isn't exactly an Effect comes from the heap.
+ */
+void* Effect::operator new( size_t size ) {
+	if( size != sizeof(Effect) ) {
+		return ::operator new( size );
+	}
+	return pool.Allocate();
+}
+
+/**\brief Return an Effect to the Pool.
+ */
+void Effect::operator delete( void* ptr, size_t size ) {
+	if( size != sizeof(Effect) ) {
+		::operator delete( ptr );
+		return;
+	}
+	pool.Release( ptr );
+}
+
 /** @} */
 
@@ -13,18 +13,26 @@
 #include "Graphics/animation.h"
 #include "Sprites/sprite.h"
 #include "Graphics/image.h"
+#include "Utilities/pool.h"
 #include "includes.h"
 
 class Effect : public Sprite {
 	public:
 		Effect(Coordinate pos, string filename, float loopPercent);
 		~Effect();
-		void Update( lua_State *L );
+		void UpdateNative( SpriteCommands *commands );
 		void Draw(void);
+		int GetDrawRadius( void );
 		virtual int GetDrawOrder( void ) {
 			return( DRAW_ORDER_EFFECT);
 		}
+
+		static void* operator new( size_t size );
+		static void operator delete( void* ptr, size_t size );
+		static const Pool<Effect>& GetPool() { return pool; }
 	private:
+		static Pool<Effect> pool; ///< Recycles the memory of finished Effects.
+
 		Animation *visual;
 };
 
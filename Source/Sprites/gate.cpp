@@ -17,6 +17,7 @@
 #include "Utilities/trig.h"
 #include "Utilities/log.h"
 #include "Engine/simulation_lua.h"
+#include "Engine/routeplanner.h"
 
 /** \addtogroup Sprites
  * @{
@@ -127,6 +128,7 @@ void Gate::SetAngle(float angle) {
 void Gate::SetWorldPosition(Coordinate c) {
 	this->_SetWorldPosition(c);
 	GetPartner()->_SetWorldPosition(c);
+	RoutePlanner::Invalidate();
 }
 
 /**\brief Set the exit for this Gate
@@ -134,6 +136,7 @@ void Gate::SetWorldPosition(Coordinate c) {
 
 void Gate::SetExit(int spriteID) {
 	exitID = spriteID;
+	RoutePlanner::Invalidate();
 }
 
 void Gate::SetPair(Gate* one, Gate* two) {
@@ -200,8 +203,6 @@ void Gate::Update( lua_State *L ) {
 			SendRandomDistance(ship);
 		}
 	}
-
-	Sprite::Update( L );
 }
 
 /**\brief Teleport any ship that enters the gate to a random location
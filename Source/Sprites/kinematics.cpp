@@ -0,0 +1,145 @@
+/**\file			kinematics.cpp
+ * \author			agent (agent@local)
+ * \date			Created: Sunday, October 18, 2026
+ * \date			Modified: Sunday, October 18, 2026
+ * \brief			Positions and momentums of every Sprite, stored by column.
+ * \details
+ */
+
+#include "includes.h"
+#include "Sprites/kinematics.h"
+
+// SSE2 is part of every x86-64 processor, so it needs no special build flags there.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define KINEMATICS_SSE2
+#include <emmintrin.h>
+#endif
+
+/** \addtogroup Sprites
+ * @{
+ */
+
+/**\brief Make sure that a row exists.
+ * \details New rows are empty.  Existing rows are left alone.
+ */
+void KinematicsTable::Reserve( unsigned int row ) {
+	if( row < x.size() ) return;
+	unsigned int rows = row + 1;
+	x.resize( rows, 0. );
+	y.resize( rows, 0. );
+	px.resize( rows, 0. );
+	py.resize( rows, 0. );
+	vx.resize( rows, 0. );
+	vy.resize( rows, 0. );
+	lvx.resize( rows, 0. );
+	lvy.resize( rows, 0. );
+	ax.resize( rows, 0. );
+	ay.resize( rows, 0. );
+	steps.resize( rows, 0. );
+	marked.resize( ( (rows - 1) >> KINEMATICS_BLOCK_BITS ) + 1, 0 );
+}
+
+/**\brief Reset a row to a Sprite resting at the origin.
+ */
+void KinematicsTable::Clear( unsigned int row ) {
+	x[row] = y[row] = 0.;
+	px[row] = py[row] = 0.;
+	vx[row] = vy[row] = 0.;
+	lvx[row] = lvy[row] = 0.;
+	ax[row] = ay[row] = 0.;
+	steps[row] = 0.;
+}
+
+/**\brief Copy every column of one row into another.
+ */
+void KinematicsTable::Copy( unsigned int from, unsigned int to ) {
+	x[to] = x[from];
+	y[to] = y[from];
+	px[to] = px[from];
+	py[to] = py[from];
+	vx[to] = vx[from];
+	vy[to] = vy[from];
+	lvx[to] = lvx[from];
+	lvy[to] = lvy[from];
+	ax[to] = ax[from];
+	ay[to] = ay[from];
+	steps[to] = steps[from];
+	if( steps[to] > 0. ) MarkBlock( to );
+}
+
+/**\brief Place a row without moving it.
+ * \details Setting the position directly (jumping, for example) is not
+ *          considered movement, so this also cancels any pending Step.
+ */
+void KinematicsTable::SetPosition( unsigned int row, Coordinate position ) {
+	x[row] = px[row] = position.GetX();
+	y[row] = py[row] = position.GetY();
+	steps[row] = 0.;
+}
+
+/**\brief Move every row that was Stepped since the last Integrate.
+ * \details Each row that was Stepped remembers its position, moves by its
+ *          momentum once per frame, and records how much its momentum
+ *          changed since its last movement.  The other rows are untouched.
+ *
+ *          Only the blocks holding a Stepped row are scanned, so the rows of
+ *          free ID slots and of Sprites that did not move are skipped a block
+ *          at a time.
+ *
+ *          Since this space has no friction, the momentum itself is never
+ *          changed here.
+ */
+void KinematicsTable::Integrate() {
+	unsigned int rows = x.size();
+	vector<unsigned int>::iterator block;
+	for( block = blocks.begin(); block != blocks.end(); ++block ) {
+		marked[*block] = 0;
+		unsigned int r = *block << KINEMATICS_BLOCK_BITS;
+		unsigned int end = min( r + (1 << KINEMATICS_BLOCK_BITS), rows );
+
+#ifdef KINEMATICS_SSE2
+		// Two rows at a time.  The rows that were not Stepped are blended back in
+		// unchanged rather than branched around.
+		const __m128d zero = _mm_setzero_pd();
+		for( ; r + 2 <= end; r += 2 ) {
+			__m128d s = _mm_loadu_pd( &steps[r] );
+			__m128d moving = _mm_cmpgt_pd( s, zero );
+			if( _mm_movemask_pd( moving ) == 0 ) continue;
+
+			__m128d cx = _mm_loadu_pd( &x[r] );
+			__m128d cy = _mm_loadu_pd( &y[r] );
+			__m128d mx = _mm_loadu_pd( &vx[r] );
+			__m128d my = _mm_loadu_pd( &vy[r] );
+			__m128d lx = _mm_loadu_pd( &lvx[r] );
+			__m128d ly = _mm_loadu_pd( &lvy[r] );
+
+			_mm_storeu_pd( &px[r], _mm_or_pd( _mm_and_pd( moving, cx ), _mm_andnot_pd( moving, _mm_loadu_pd( &px[r] ) ) ) );
+			_mm_storeu_pd( &py[r], _mm_or_pd( _mm_and_pd( moving, cy ), _mm_andnot_pd( moving, _mm_loadu_pd( &py[r] ) ) ) );
+			// Rows with no steps add 0 times their momentum, which leaves them where they are.
+			_mm_storeu_pd( &x[r], _mm_add_pd( cx, _mm_mul_pd( mx, s ) ) );
+			_mm_storeu_pd( &y[r], _mm_add_pd( cy, _mm_mul_pd( my, s ) ) );
+			_mm_storeu_pd( &ax[r], _mm_or_pd( _mm_and_pd( moving, _mm_sub_pd( lx, mx ) ), _mm_andnot_pd( moving, _mm_loadu_pd( &ax[r] ) ) ) );
+			_mm_storeu_pd( &ay[r], _mm_or_pd( _mm_and_pd( moving, _mm_sub_pd( ly, my ) ), _mm_andnot_pd( moving, _mm_loadu_pd( &ay[r] ) ) ) );
+			_mm_storeu_pd( &lvx[r], _mm_or_pd( _mm_and_pd( moving, mx ), _mm_andnot_pd( moving, lx ) ) );
+			_mm_storeu_pd( &lvy[r], _mm_or_pd( _mm_and_pd( moving, my ), _mm_andnot_pd( moving, ly ) ) );
+			_mm_storeu_pd( &steps[r], zero );
+		}
+#endif
+
+		for( ; r < end; r++ ) {
+			if( steps[r] <= 0. ) continue;
+			px[r] = x[r];
+			py[r] = y[r];
+			x[r] += vx[r] * steps[r];
+			y[r] += vy[r] * steps[r];
+			ax[r] = lvx[r] - vx[r];
+			ay[r] = lvy[r] - vy[r];
+			lvx[r] = vx[r];
+			lvy[r] = vy[r];
+			steps[r] = 0.;
+		}
+	}
+	blocks.clear();
+}
+
+/** @} */
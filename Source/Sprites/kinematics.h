@@ -0,0 +1,75 @@
+/**\file			kinematics.h
+ * \author			agent (agent@local)
+ * \date			Created: Sunday, October 18, 2026
+ * \date			Modified: Sunday, October 18, 2026
+ * \brief			Positions and momentums of every Sprite, stored by column.
+ * \details
+ */
+
+#ifndef __h_kinematics__
+#define __h_kinematics__
+
+#include "includes.h"
+#include "Utilities/coordinate.h"
+
+#define KINEMATICS_BLOCK_BITS 6 ///< Rows are tracked for Integrate in blocks of 2^KINEMATICS_BLOCK_BITS.
+
+/**\class KinematicsTable
+ * \brief The motion of every Sprite, one row per Sprite ID slot.
+ *
+ * \details
+ * Each quantity is kept in its own contiguous column rather than inside the
+ * Sprite objects, so that the Sprites can be moved by one tight pass over
+ * the columns.  The Sprite accessors read and write their own row.
+ *
+ * The pass only covers the blocks of rows that were Stepped, so its cost
+ * follows the Sprites that moved rather than every row ever allocated.
+ * Blocks of free ID slots and of Sprites that never move are skipped.
+ *
+ * \see Sprite
+ */
+class KinematicsTable {
+	public:
+		void Reserve( unsigned int row );
+		void Clear( unsigned int row );
+		void Copy( unsigned int from, unsigned int to );
+
+		Coordinate GetPosition( unsigned int row ) const { return Coordinate( x[row], y[row] ); }
+		Coordinate GetPreviousPosition( unsigned int row ) const { return Coordinate( px[row], py[row] ); }
+		Coordinate GetMomentum( unsigned int row ) const { return Coordinate( vx[row], vy[row] ); }
+		Coordinate GetAcceleration( unsigned int row ) const { return Coordinate( ax[row], ay[row] ); }
+		void SetPosition( unsigned int row, Coordinate position );
+		void SetMomentum( unsigned int row, Coordinate momentum ) {
+			vx[row] = momentum.GetX();
+			vy[row] = momentum.GetY();
+		}
+
+		/// Move a row by this many frames during the next Integrate.
+		void Step( unsigned int row, Uint32 frames ) {
+			steps[row] = double( frames );
+			MarkBlock( row );
+		}
+		void Integrate();
+
+		unsigned int GetNumRows() const { return x.size(); }
+
+	private:
+		void MarkBlock( unsigned int row ) {
+			unsigned int block = row >> KINEMATICS_BLOCK_BITS;
+			if( !marked[block] ) {
+				marked[block] = 1;
+				blocks.push_back( block );
+			}
+		}
+
+		vector<double> x, y;       ///< The current position.
+		vector<double> px, py;     ///< The position before the last movement.
+		vector<double> vx, vy;     ///< The current momentum.
+		vector<double> lvx, lvy;   ///< The momentum after the last movement.
+		vector<double> ax, ay;     ///< The change in momentum during the last movement.
+		vector<double> steps;      ///< The frames to move by during the next Integrate, usually 0.
+		vector<unsigned char> marked; ///< Whether each block of rows is in blocks.
+		vector<unsigned int> blocks;  ///< The blocks with rows Stepped since the last Integrate.
+};
+
+#endif // __h_kinematics__
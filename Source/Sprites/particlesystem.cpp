@@ -0,0 +1,203 @@
+/**\file			particlesystem.cpp
+ * \author			agent (agent@local)
+ * \date			Created: Sunday, October 18, 2026
+ * \date			Modified: Sunday, October 18, 2026
+ * \brief			Plays short Animations like hits and explosions in flat arrays.
+ * \details
+ */
+
+#include "includes.h"
+#include "Sprites/particlesystem.h"
+#include "Utilities/log.h"
+
+/** \addtogroup Sprites
+ * @{
+ */
+
+/**\brief Forget one particle by moving the last one into its place.
+ */
+void ParticleEmitter::Remove( unsigned int p ) {
+	unsigned int last = x.size() - 1;
+	x[p] = x[last];                 x.pop_back();
+	y[p] = y[last];                 y.pop_back();
+	vx[p] = vx[last];               vx.pop_back();
+	vy[p] = vy[last];               vy.pop_back();
+	angle[p] = angle[last];         angle.pop_back();
+	startTime[p] = startTime[last]; startTime.pop_back();
+	frame[p] = frame[last];         frame.pop_back();
+}
+
+/**\brief Orders the frames handed to DrawLater by their Image.
+ */
+static bool compareLaterImages( const pair<Image*,ImagePlacement>& a, const pair<Image*,ImagePlacement>& b ) {
+	return a.first < b.first;
+}
+
+/**\brief Create a system without any particles.
+ */
+ParticleSystem::ParticleSystem()
+	:lastFrame( 0 )
+	,count( 0 )
+	,highWater( 0 )
+{
+}
+
+/**\brief Find the emitter for an Animation, starting one if it has never been emitted.
+ * \details There are only ever a handful of Animations, so they are searched in order.
+ */
+ParticleEmitter* ParticleSystem::GetEmitter( Ani *ani, float loopPercent ) {
+	vector<ParticleEmitter>::iterator e;
+	for( e = emitters.begin(); e != emitters.end(); ++e ) {
+		if( e->ani == ani && e->loopPercent == loopPercent ) {
+			return &(*e);
+		}
+	}
+	emitters.push_back( ParticleEmitter( ani, loopPercent ) );
+	emitters.back().placements.resize( ani->GetNumFrames() );
+	return &emitters.back();
+}
+
+/**\brief Start playing an Animation.
+ * \param filename The .ani file to play.
+ * \param position Where the Animation is played.
+ * \param momentum How the Animation drifts while it is playing.
+ * \param angle The rotation of the Animation, in degrees.
+ * \param loopPercent How far back the Animation loops.  0 plays it once.
+ * \see Animation::SetLoopPercent
+ */
+void ParticleSystem::Emit( string filename, Coordinate position, Coordinate momentum, float angle, float loopPercent ) {
+	Ani *ani = Ani::Get( filename );
+	if( ani->GetNumFrames() <= 0 ) {
+		LogMsg(WARN, "Cannot emit the Animation '%s' since it has no frames.", filename.c_str() );
+		return;
+	}
+	if( loopPercent < 0.0f ) {
+		loopPercent = 0.0f;
+	} else if( loopPercent > 1.0f ) {
+		loopPercent = 1.0f;
+	}
+
+	ParticleEmitter *emitter = GetEmitter( ani, loopPercent );
+	emitter->x.push_back( position.GetX() );
+	emitter->y.push_back( position.GetY() );
+	emitter->vx.push_back( momentum.GetX() );
+	emitter->vy.push_back( momentum.GetY() );
+	emitter->angle.push_back( angle );
+	emitter->startTime.push_back( SDL_GetTicks() );
+	emitter->frame.push_back( 0 );
+
+	count++;
+	if( count > highWater ) {
+		highWater = count;
+	}
+}
+
+/**\brief Move every particle and advance its Animation.
+ * \param frame The current logical frame.  Particles drift once for each
+ *        frame since the last Update.
+ * \details Particles that reach the end of an Animation that doesn't loop
+ *          are removed.
+ */
+void ParticleSystem::Update( Uint32 frame ) {
+	double frames = (lastFrame == 0 || frame <= lastFrame) ? 1. : double( frame - lastFrame );
+	lastFrame = frame;
+	Uint32 now = SDL_GetTicks();
+
+	vector<ParticleEmitter>::iterator emitter;
+	for( emitter = emitters.begin(); emitter != emitters.end(); ++emitter ) {
+		int numFrames = emitter->ani->GetNumFrames();
+		Uint32 delay = emitter->ani->GetDelay();
+		for( unsigned int p = 0; p < emitter->Size(); ) {
+			int fnum = (now - emitter->startTime[p]) / delay;
+			if( fnum > numFrames - 1 ) {
+				if( emitter->loopPercent <= 0.0f ) {
+					emitter->Remove( p );
+					count--;
+					continue;
+				}
+				fnum = TO_INT(numFrames * (1.0f-emitter->loopPercent)); // Step back a few frames.
+				emitter->startTime[p] = now - delay*fnum; // Pretend that we started fnum frames ago
+			}
+			emitter->frame[p] = fnum;
+			emitter->x[p] += emitter->vx[p] * frames;
+			emitter->y[p] += emitter->vy[p] * frames;
+			++p;
+		}
+	}
+}
+
+/**\brief Draw a frame along with the particles, rather than right away.
+ * \param image The frame to draw.
+ * \param x The center of the frame, in screen coordinates.
+ * \param y The center of the frame, in screen coordinates.
+ * \param angle The rotation of the frame, in degrees.
+ * \details The frame is drawn by the next Draw, above every Sprite.
+ */
+void ParticleSystem::DrawLater( Image *image, int x, int y, float angle ) {
+	ImagePlacement placement;
+	placement.x = x;
+	placement.y = y;
+	placement.angle = angle;
+	later.push_back( make_pair( image, placement ) );
+}
+
+/**\brief Draw the particles that are on screen, then the frames handed to DrawLater.
+ * \param focus The center of the screen.
+ * \param halfWidth Half the width of the screen.
+ * \param halfHeight Half the height of the screen.
+ * \details Each frame of each Animation is drawn in one batch.
+ */
+void ParticleSystem::Draw( Coordinate focus, float halfWidth, float halfHeight ) {
+	vector<ParticleEmitter>::iterator emitter;
+	for( emitter = emitters.begin(); emitter != emitters.end(); ++emitter ) {
+		double reach = emitter->ani->GetWidth() / 2 + emitter->ani->GetHeight() / 2;
+		unsigned int f;
+		for( f = 0; f < emitter->placements.size(); f++ ) {
+			emitter->placements[f].clear();
+		}
+
+		unsigned int size = emitter->Size();
+		for( unsigned int p = 0; p < size; p++ ) {
+			if( fabs( emitter->x[p] - focus.GetX() ) > halfWidth + reach
+			 || fabs( emitter->y[p] - focus.GetY() ) > halfHeight + reach ) {
+				continue;
+			}
+			Coordinate position( emitter->x[p], emitter->y[p] );
+			ImagePlacement placement;
+			placement.x = position.GetScreenX();
+			placement.y = position.GetScreenY();
+			placement.angle = emitter->angle[p];
+			emitter->placements[ emitter->frame[p] ].push_back( placement );
+		}
+
+		for( f = 0; f < emitter->placements.size(); f++ ) {
+			emitter->ani->GetFrame( f )->DrawCenteredBatch( emitter->placements[f] );
+		}
+	}
+
+	// The frames of the same Image are next to each other once sorted
+	sort( later.begin(), later.end(), compareLaterImages );
+	unsigned int l = 0;
+	while( l < later.size() ) {
+		Image *image = later[l].first;
+		batch.clear();
+		for( ; l < later.size() && later[l].first == image; l++ ) {
+			batch.push_back( later[l].second );
+		}
+		image->DrawCenteredBatch( batch );
+	}
+	later.clear();
+}
+
+/**\brief The number of particles that fit in the arrays without growing them.
+ */
+unsigned int ParticleSystem::GetCapacity() const {
+	unsigned int capacity = 0;
+	vector<ParticleEmitter>::const_iterator emitter;
+	for( emitter = emitters.begin(); emitter != emitters.end(); ++emitter ) {
+		capacity += emitter->x.capacity();
+	}
+	return capacity;
+}
+
+/** @} */
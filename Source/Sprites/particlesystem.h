@@ -0,0 +1,81 @@
+/**\file			particlesystem.h
+ * \author			agent (agent@local)
+ * \date			Created: Sunday, October 18, 2026
+ * \date			Modified: Sunday, October 18, 2026
+ * \brief			Plays short Animations like hits and explosions in flat arrays.
+ * \details
+ */
+
+#ifndef __h_particlesystem__
+#define __h_particlesystem__
+
+#include "includes.h"
+#include "Graphics/animation.h"
+#include "Graphics/image.h"
+#include "Utilities/coordinate.h"
+
+/**\brief The particles playing one Animation.
+ * \details Each particle is one entry of every array.  They are removed by
+ *          moving the last particle into the gap, so the arrays keep their
+ *          memory for the next particles emitted.
+ * \see ParticleSystem
+ */
+struct ParticleEmitter {
+	ParticleEmitter( Ani *_ani, float _loopPercent ) :ani( _ani ), loopPercent( _loopPercent ) {}
+
+	unsigned int Size() const { return x.size(); }
+	void Remove( unsigned int p );
+
+	Ani *ani;                  ///< The frames that every particle of this emitter plays.
+	float loopPercent;         ///< How far back the particles loop once they reach the last frame.  0 plays them once.
+	vector<double> x, y;       ///< Where each particle is.
+	vector<double> vx, vy;     ///< The momentum of each particle.
+	vector<float> angle;       ///< The rotation of each particle, in degrees.
+	vector<Uint32> startTime;  ///< When each particle showed its first frame, in real ticks.
+	vector<int> frame;         ///< The frame each particle is showing.
+	vector< vector<ImagePlacement> > placements; ///< The particles on screen, by frame.
+};
+
+/**\class ParticleSystem
+ * \brief Every short lived Animation in the universe.
+ *
+ * \details
+ * Hits and explosions only drift and play their frames once, so they don't
+ * need to be Sprites.  Each kind of Animation gets one ParticleEmitter, and
+ * every particle is advanced by one pass over the emitters.  The particles
+ * showing the same frame are drawn together as one batch.
+ *
+ * Things that draw an Animation of their own, like the engine flares of
+ * Ships, can hand its frame to the ParticleSystem while they are being drawn.
+ * The frames are then drawn in batches with the particles.
+ *
+ * Like Animation, the frames follow real time, so they keep playing while
+ * the game is paused.
+ *
+ * \see Animation
+ */
+class ParticleSystem {
+	public:
+		ParticleSystem();
+
+		void Emit( string filename, Coordinate position, Coordinate momentum, float angle, float loopPercent = 0.0f );
+		void Update( Uint32 frame );
+		void DrawLater( Image *image, int x, int y, float angle );
+		void Draw( Coordinate focus, float halfWidth, float halfHeight );
+
+		unsigned int GetCount() const { return count; }
+		unsigned int GetHighWater() const { return highWater; }
+		unsigned int GetCapacity() const;
+
+	private:
+		ParticleEmitter* GetEmitter( Ani *ani, float loopPercent );
+
+		vector<ParticleEmitter> emitters;           ///< One emitter for each Animation and loop that has been emitted.
+		Uint32 lastFrame;                           ///< The logical frame of the last Update, or 0 before the first.
+		unsigned int count;                         ///< Particles alive.
+		unsigned int highWater;                     ///< The most particles ever alive at once.
+		vector< pair<Image*,ImagePlacement> > later; ///< The frames handed over by DrawLater since the last Draw.
+		vector<ImagePlacement> batch;               ///< One Image's worth of those frames.
+};
+
+#endif // __h_particlesystem__
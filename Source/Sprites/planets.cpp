@@ -197,17 +197,15 @@ void Planet::Update( lua_State *L ) {
 	if( lastTrafficTime + 120 < Timer::GetLogicalFrameCount() ) {
 		GenerateTraffic( L );
 	}
-	Sprite::Update( L );
 }
 
 void Planet::GenerateTraffic( lua_State *L ) {
 	SpriteManager *sprites = Simulation_Lua::GetSimulation(L)->GetSpriteManager();
-	list<Sprite*> *nearbySprites = sprites->GetSpritesNear( GetWorldPosition(), TO_FLOAT(sphereOfInfluence), DRAW_ORDER_SHIP | DRAW_ORDER_PLAYER);
+	unsigned int nearbyShips = sprites->CountSpritesNear( GetWorldPosition(), TO_FLOAT(sphereOfInfluence), DRAW_ORDER_SHIP | DRAW_ORDER_PLAYER);
 
-	if( nearbySprites->size() < traffic ) {
+	if( nearbyShips < traffic ) {
 		Lua::Call( "createRandomShipForPlanet", "i", GetID() );
 	}
-	delete nearbySprites;
 	lastTrafficTime = Timer::GetLogicalFrameCount();
 }
 
@@ -0,0 +1,310 @@
+/**\file			projectilesystem.cpp
+ * \author			agent (agent@local)
+ * \date			Created: Sunday, October 18, 2026
+ * \date			Modified: Sunday, October 18, 2026
+ * \brief			Flies, collides and draws every Projectile in flat arrays.
+ * \details
+ */
+
+#include "includes.h"
+#include "Sprites/ai.h"
+#include "Sprites/projectilesystem.h"
+#include "Sprites/ship.h"
+#include "Sprites/spritemanager.h"
+#include "Utilities/log.h"
+#include "Utilities/timer.h"
+#include "Utilities/trig.h"
+
+/** \addtogroup Sprites
+ * @{
+ */
+
+/**\brief Forget one Projectile by moving the last one into its place.
+ */
+void ProjectileBatch::Remove( unsigned int p ) {
+	unsigned int last = x.size() - 1;
+	x[p] = x[last];                     x.pop_back();
+	y[p] = y[last];                     y.pop_back();
+	startX[p] = startX[last];           startX.pop_back();
+	startY[p] = startY[last];           startY.pop_back();
+	vx[p] = vx[last];                   vx.pop_back();
+	vy[p] = vy[last];                   vy.pop_back();
+	angle[p] = angle[last];             angle.pop_back();
+	damageBoost[p] = damageBoost[last]; damageBoost.pop_back();
+	expires[p] = expires[last];         expires.pop_back();
+	ownerID[p] = ownerID[last];         ownerID.pop_back();
+	targetID[p] = targetID[last];       targetID.pop_back();
+}
+
+/**\brief Follow a Projectile's path relative to a Ship.
+ * \details Both bodies may have moved during this tick, possibly by many
+ *          frames worth of momentum, so this finds the first moment that the
+ *          Projectile came within the Ship's radar size.
+ */
+void ProjectileHitTest::Visit( Sprite *ship ) {
+	if( ship->GetID() == ownerID ) {
+		return;
+	}
+
+	// Solve |from + path*t| = radius for the earliest t in [0,1]
+	Coordinate from = start - ship->GetPreviousWorldPosition();
+	Coordinate path = (end - ship->GetWorldPosition()) - from;
+	double radius = ship->GetRadarSize();
+
+	double a = path.GetX()*path.GetX() + path.GetY()*path.GetY();
+	double b = from.GetX()*path.GetX() + from.GetY()*path.GetY();
+	double c = from.GetX()*from.GetX() + from.GetY()*from.GetY() - radius*radius;
+	double t;
+
+	if( c < 0 ) {
+		t = 0; // Already touching at the start of this tick
+	} else {
+		double discriminant = b*b - a*c;
+		if( a == 0 || b >= 0 || discriminant < 0 ) {
+			return; // Not moving closer, or passes by without touching
+		}
+		t = (-b - sqrt(discriminant)) / a;
+		if( t > 1 ) {
+			return; // Will not reach the ship until a later tick
+		}
+	}
+
+	// Ties go to the lower ID so that the index order doesn't matter
+	if( hit == NULL || t < hitTime || (t == hitTime && ship->GetID() < hit->GetID()) ) {
+		hit = ship;
+		hitTime = t;
+	}
+}
+
+/**\brief Create a system without any Projectiles.
+ */
+ProjectileSystem::ProjectileSystem()
+	:lastFrame( 0 )
+	,count( 0 )
+	,highWater( 0 )
+{
+}
+
+/**\brief Find the batch for a Weapon, starting one if it has never fired.
+ * \details There are only ever a handful of Weapons, so they are searched in order.
+ */
+ProjectileBatch* ProjectileSystem::GetBatch( Weapon *weapon ) {
+	vector<ProjectileBatch>::iterator b;
+	for( b = batches.begin(); b != batches.end(); ++b ) {
+		if( b->weapon == weapon ) {
+			return &(*b);
+		}
+	}
+	batches.push_back( ProjectileBatch( weapon ) );
+	return &batches.back();
+}
+
+/**\brief Launch a new Projectile.
+ * \param weapon The Weapon being fired.  This decides how the Projectile looks, flies and hurts.
+ * \param damageBoost Multiplies the Weapon's payload.
+ * \param angleToFire The direction of the Projectile, in degrees.
+ * \param position Where the Projectile starts.
+ * \param firedMomentum The momentum of the Ship firing it, which the Projectile keeps.
+ * \param ownerID The Ship firing the Projectile.
+ * \param targetID The Sprite that the Projectile homes in on, or 0.
+ */
+void ProjectileSystem::Fire( Weapon *weapon, float damageBoost, float angleToFire, Coordinate position, Coordinate firedMomentum, int ownerID, int targetID ) {
+	ProjectileBatch *batch = GetBatch( weapon );
+
+	Trig *trig = Trig::Instance();
+	float angle = static_cast<float>(trig->DegToRad( angleToFire ));
+	Coordinate momentum = firedMomentum +
+	           Coordinate( trig->GetCos( angle ) * weapon->GetVelocity(),
+	                      -trig->GetSin( angle ) * weapon->GetVelocity() );
+
+	batch->x.push_back( position.GetX() );
+	batch->y.push_back( position.GetY() );
+	batch->startX.push_back( position.GetX() );
+	batch->startY.push_back( position.GetY() );
+	batch->vx.push_back( momentum.GetX() );
+	batch->vy.push_back( momentum.GetY() );
+	batch->angle.push_back( angleToFire );
+	batch->damageBoost.push_back( damageBoost );
+	batch->expires.push_back( Timer::GetTicks() + weapon->GetLifetime() );
+	batch->ownerID.push_back( ownerID );
+	batch->targetID.push_back( targetID );
+
+	count++;
+	if( count > highWater ) {
+		highWater = count;
+	}
+}
+
+/**\brief Move every Projectile, then turn the homing ones towards their targets.
+ * \param sprites Where the targets are looked up.
+ * \param frame The current logical frame.  Projectiles are moved once for
+ *        each frame since the last Update.
+ * \details Projectiles in space have no friction, so each one just moves by
+ *          its momentum.  The targets have already moved this tick.
+ */
+void ProjectileSystem::Update( SpriteManager *sprites, Uint32 frame ) {
+	double frames = (lastFrame == 0 || frame <= lastFrame) ? 1. : double( frame - lastFrame );
+	lastFrame = frame;
+
+	vector<ProjectileBatch>::iterator batch;
+	for( batch = batches.begin(); batch != batches.end(); ++batch ) {
+		unsigned int size = batch->Size();
+		for( unsigned int p = 0; p < size; p++ ) {
+			batch->startX[p] = batch->x[p];
+			batch->startY[p] = batch->y[p];
+			batch->x[p] += batch->vx[p] * frames;
+			batch->y[p] += batch->vy[p] * frames;
+		}
+
+		float tracking = batch->weapon->GetTracking();
+		if( tracking <= 0.00000001f ) {
+			continue;
+		}
+		for( unsigned int p = 0; p < size; p++ ) {
+			if( batch->targetID[p] == 0 ) {
+				continue;
+			}
+			Sprite *target = sprites->GetSpriteByID( batch->targetID[p] );
+			if( target == NULL ) {
+				continue;
+			}
+			Coordinate position( batch->x[p], batch->y[p] );
+			Coordinate momentum( batch->vx[p], batch->vy[p] );
+			float angleTowards = normalizeAngle( ( target->GetWorldPosition() - position ).GetAngle() - batch->angle[p] );
+			momentum = momentum.RotateBy( angleTowards*tracking );
+			batch->vx[p] = momentum.GetX();
+			batch->vy[p] = momentum.GetY();
+			batch->angle[p] = momentum.GetAngle();
+		}
+	}
+}
+
+/**\brief How far from the middle of a Projectile's path a Ship it hit can be.
+ * \param start Where the Projectile was at the start of this tick.
+ * \param end Where the Projectile is now.
+ * \param maxShipTravel The furthest any Ship moved during this tick.
+ * \param maxShipRadarSize The largest radar size of any Ship.
+ * \details A Ship that was hit came within its radar size of some point on
+ *          the path, and is now at most maxShipTravel further away.
+ */
+double ProjectileSystem::GetCollisionReach( Coordinate start, Coordinate end, double maxShipTravel, double maxShipRadarSize ) {
+	return (end - start).GetMagnitude() * 0.5 + maxShipTravel + maxShipRadarSize;
+}
+
+/**\brief Let every Projectile hit the Ships, then forget the spent ones.
+ * \param sprites Where the Ships are found, and where the shield Animations are played.
+ * \param maxShipTravel The furthest any Ship moved during this tick.
+ * \param maxShipRadarSize The largest radar size of any Ship.
+ * \details
+ * Each Projectile only asks the SpatialIndex for the Ships within its
+ * GetCollisionReach of the middle of its path.
+ *
+ * Every hit damages the Ship, tells the AI who attacked it and plays a
+ * shield Animation at the point of impact.  Projectiles that hit something or
+ * outlived their Weapon's lifetime are then removed.  A Projectile that
+ * expires this tick can still hit something on its way out.
+ */
+void ProjectileSystem::Collide( SpriteManager *sprites, double maxShipTravel, double maxShipRadarSize ) {
+	Uint32 now = Timer::GetTicks();
+
+	vector<ProjectileBatch>::iterator batch;
+	for( batch = batches.begin(); batch != batches.end(); ++batch ) {
+		for( unsigned int p = 0; p < batch->Size(); ) {
+			Coordinate start( batch->startX[p], batch->startY[p] );
+			Coordinate end( batch->x[p], batch->y[p] );
+			Coordinate middle = (start + end) * 0.5;
+			double reach = GetCollisionReach( start, end, maxShipTravel, maxShipRadarSize );
+
+			ProjectileHitTest test( start, end, batch->ownerID[p] );
+			sprites->ForEachSpriteNear( middle, static_cast<float>(reach), DRAW_ORDER_SHIP | DRAW_ORDER_PLAYER, test );
+
+			if( test.hit != NULL ) {
+				Ship *ship = (Ship*)test.hit;
+				int damageDone = static_cast<int>( (batch->weapon->GetPayload())*batch->damageBoost[p] );
+				ship->Damage( damageDone );
+				if( ship->GetDrawOrder() == DRAW_ORDER_SHIP ) {
+					((AI*)ship)->AddEnemy( batch->ownerID[p], damageDone );
+				}
+
+				// Create a fire burst where this projectile hit the ship's shields.
+				Coordinate impact = start + (end - start) * test.hitTime;
+				sprites->GetParticles()->Emit( "Resources/Animations/shield.ani", impact, ship->GetMomentum(), -batch->angle[p] );
+			}
+
+			if( test.hit != NULL || now > batch->expires[p] ) {
+				batch->Remove( p );
+				count--;
+			} else {
+				++p;
+			}
+		}
+	}
+}
+
+/**\brief Draw the Projectiles that are on screen, one batch per Weapon.
+ * \param focus The center of the screen.
+ * \param halfWidth Half the width of the screen.
+ * \param halfHeight Half the height of the screen.
+ */
+void ProjectileSystem::Draw( Coordinate focus, float halfWidth, float halfHeight ) {
+	vector<ProjectileBatch>::iterator batch;
+	for( batch = batches.begin(); batch != batches.end(); ++batch ) {
+		Image *image = batch->weapon->GetImage();
+		if( image == NULL ) {
+			if( batch->Size() > 0 ) {
+				LogMsg(WARN, "Attempt to draw a projectile before an image was assigned." );
+			}
+			continue;
+		}
+		// The widest the image can be once it is rotated
+		double reach = (image->GetWidth() > image->GetHeight()) ? image->GetWidth() : image->GetHeight();
+
+		placements.clear();
+		unsigned int size = batch->Size();
+		for( unsigned int p = 0; p < size; p++ ) {
+			if( fabs( batch->x[p] - focus.GetX() ) > halfWidth + reach
+			 || fabs( batch->y[p] - focus.GetY() ) > halfHeight + reach ) {
+				continue;
+			}
+			Coordinate position( batch->x[p], batch->y[p] );
+			ImagePlacement placement;
+			placement.x = position.GetScreenX();
+			placement.y = position.GetScreenY();
+			placement.angle = batch->angle[p];
+			placements.push_back( placement );
+		}
+		image->DrawCenteredBatch( placements );
+	}
+}
+
+/**\brief Collect the positions of the Projectiles near a point, for the radar.
+ * \param positions [out] Replaced with the positions, in no particular order.
+ */
+void ProjectileSystem::GetPositionsNear( Coordinate c, float r, vector<Coordinate> *positions ) {
+	double limit = double(r) * double(r);
+	positions->clear();
+	vector<ProjectileBatch>::iterator batch;
+	for( batch = batches.begin(); batch != batches.end(); ++batch ) {
+		unsigned int size = batch->Size();
+		for( unsigned int p = 0; p < size; p++ ) {
+			double dx = batch->x[p] - c.GetX();
+			double dy = batch->y[p] - c.GetY();
+			if( dx*dx + dy*dy <= limit ) {
+				positions->push_back( Coordinate( batch->x[p], batch->y[p] ) );
+			}
+		}
+	}
+}
+
+/**\brief The number of Projectiles that fit in the arrays without growing them.
+ */
+unsigned int ProjectileSystem::GetCapacity() const {
+	unsigned int capacity = 0;
+	vector<ProjectileBatch>::const_iterator batch;
+	for( batch = batches.begin(); batch != batches.end(); ++batch ) {
+		capacity += batch->x.capacity();
+	}
+	return capacity;
+}
+
+/** @} */
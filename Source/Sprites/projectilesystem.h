@@ -0,0 +1,99 @@
+/**\file			projectilesystem.h
+ * \author			agent (agent@local)
+ * \date			Created: Sunday, October 18, 2026
+ * \date			Modified: Sunday, October 18, 2026
+ * \brief			Flies, collides and draws every Projectile in flat arrays.
+ * \details
+ */
+
+#ifndef __h_projectilesystem__
+#define __h_projectilesystem__
+
+#include "includes.h"
+#include "Engine/weapons.h"
+#include "Graphics/image.h"
+#include "Utilities/coordinate.h"
+#include "Utilities/spatialindex.h"
+
+class SpriteManager;
+
+/**\brief The Projectiles in flight from one kind of Weapon.
+ * \details Each Projectile is one entry of every array.  They are removed by
+ *          moving the last Projectile into the gap, so the order changes.
+ * \see ProjectileSystem
+ */
+struct ProjectileBatch {
+	ProjectileBatch( Weapon *_weapon ) :weapon( _weapon ) {}
+
+	unsigned int Size() const { return x.size(); }
+	void Remove( unsigned int p );
+
+	Weapon *weapon;                ///< The Weapon that fired every Projectile in this batch.
+	vector<double> x, y;           ///< Where each Projectile is.
+	vector<double> startX, startY; ///< Where each Projectile was before its last movement.
+	vector<double> vx, vy;         ///< The momentum of each Projectile.
+	vector<float> angle;           ///< The direction each Projectile is pointing, in degrees.
+	vector<float> damageBoost;     ///< The damage booster of the Ship that fired each Projectile.
+	vector<Uint32> expires;        ///< The tick after which each Projectile disappears.
+	vector<int> ownerID;           ///< The Ship that fired each Projectile.  It is never hit by it.
+	vector<int> targetID;          ///< The Sprite that each Projectile is homing in on, or 0.
+};
+
+/**\brief Finds the first Ship that one Projectile struck during this tick.
+ * \details Rather than testing only where the bodies ended up, this follows
+ *          the Projectile's path relative to each Ship it visits.  A
+ *          Projectile never hits the Ship that fired it.
+ */
+class ProjectileHitTest : public SpriteVisitor {
+	public:
+		ProjectileHitTest( Coordinate _start, Coordinate _end, int _ownerID )
+			:start( _start ), end( _end ), ownerID( _ownerID ), hit( NULL ), hitTime( 0 ) {}
+
+		void Visit( Sprite *ship );
+
+		Coordinate start;   ///< Where the Projectile was at the start of this tick.
+		Coordinate end;     ///< Where the Projectile is now.
+		int ownerID;        ///< The Ship that fired the Projectile.
+		Sprite *hit;        ///< The first Ship struck, or NULL.
+		double hitTime;     ///< How far through this tick (0 to 1) the hit happened.
+};
+
+/**\class ProjectileSystem
+ * \brief Every Projectile in flight.
+ *
+ * \details
+ * Projectiles are not Sprites.  They live for a fraction of a second, only
+ * fly straight or home in on a target, and there are a great many of them,
+ * so they are kept out of the SpatialIndex, the Sprite lookup and the
+ * DrawList.  Instead they are stored in flat arrays, one ProjectileBatch per
+ * Weapon, and the SpriteManager has this system move, collide and draw them.
+ *
+ * \see SpriteManager::Update
+ */
+class ProjectileSystem {
+	public:
+		ProjectileSystem();
+
+		void Fire( Weapon *weapon, float damageBoost, float angleToFire, Coordinate position, Coordinate firedMomentum, int ownerID, int targetID );
+		void Update( SpriteManager *sprites, Uint32 frame );
+		void Collide( SpriteManager *sprites, double maxShipTravel, double maxShipRadarSize );
+		void Draw( Coordinate focus, float halfWidth, float halfHeight );
+		void GetPositionsNear( Coordinate c, float r, vector<Coordinate> *positions );
+
+		unsigned int GetCount() const { return count; }
+		unsigned int GetHighWater() const { return highWater; }
+		unsigned int GetCapacity() const;
+
+		static double GetCollisionReach( Coordinate start, Coordinate end, double maxShipTravel, double maxShipRadarSize );
+
+	private:
+		ProjectileBatch* GetBatch( Weapon *weapon );
+
+		vector<ProjectileBatch> batches;  ///< One batch for each Weapon that has fired.
+		Uint32 lastFrame;                 ///< The logical frame of the last Update, or 0 before the first.
+		unsigned int count;               ///< Projectiles in flight.
+		unsigned int highWater;           ///< The most Projectiles ever in flight at once.
+		vector<ImagePlacement> placements; ///< The Projectiles of one batch on screen.
+};
+
+#endif // __h_projectilesystem__
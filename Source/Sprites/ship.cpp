@@ -15,7 +15,6 @@
 #include "Utilities/trig.h"
 #include "Sprites/spritemanager.h"
 #include "Utilities/xml.h"
-#include "Sprites/effects.h"
 #include "Audio/sound.h"
 #include "Engine/hud.h"
 
@@ -118,6 +117,8 @@ Ship::Ship()
 	status.isRotatingRight = false;
 	status.isDisabled = false;
 	status.isJumping = false;
+	status.accelerated = false;
+	status.unfinishedTurn = 0.0f;
 	for(int a=0;a<max_ammo;a++){
 		ammo[a]=0;
 	}
@@ -250,12 +251,15 @@ void Ship::Rotate( float direction ) {
 		if (direction > 0 ){
 			angle += maxturning;
 			status.isRotatingLeft = true;
+			status.unfinishedTurn = direction - maxturning;
 		}else{
 			angle -= maxturning;
 			status.isRotatingRight = true;
+			status.unfinishedTurn = direction + maxturning;
 		}
 	} else {
 		angle += direction;
+		status.unfinishedTurn = 0.0f;
 	}
 
 	// Normalize
@@ -300,6 +304,7 @@ void Ship::Accelerate( void ) {
 	SetMomentum( momentum );
 
 	status.isAccelerating = true;
+	status.accelerated = true;
 
 	// Play engine sound
 	if( engine->GetSound() != NULL)
@@ -387,10 +392,20 @@ bool Ship::JumpDrive( Coordinate position ) {
 }
 
 /**\brief Update function on every frame.
+ * \details Explosions make sounds and new Sprites, so they happen here
+ *          rather than in UpdateNative.
  */
 void Ship::Update( lua_State *L ) {
-	Sprite::Update( L ); // update momentum and other generic sprite attributes
+	// Ship has taken as much damage as possible...
+	if( status.hullDamage >=  (float)shipStats.GetHullStrength() ) {
+		// It Explodes!
+		Explode( L );
+	}
+}
 
+/**\brief Update the Ship's engine and jump status after it has moved.
+ */
+void Ship::UpdateNative( SpriteCommands *commands ) {
 	// Movement Changes
 	if( status.isAccelerating == false
 		&& status.isRotatingLeft == false
@@ -412,12 +427,6 @@ void Ship::Update( lua_State *L ) {
 			SetWorldPosition( status.jumpDestination );
 		}
 	}
-
-	// Ship has taken as much damage as possible...
-	if( status.hullDamage >=  (float)shipStats.GetHullStrength() ) {
-		// It Explodes!
-		Explode( L );
-	}
 }
 
 /**\brief Draw function.
@@ -457,7 +466,12 @@ void Ship::Draw( void ) {
 				static_cast<float>(position.GetScreenX()),
 				static_cast<float>(position.GetScreenY()), &tx, &ty,
 				static_cast<float>( trig->DegToRad( direction ) ));
-		flareAnimation->Draw( (int)tx, (int)ty, direction );
+		if( status.isJumping ) {
+			// The particles are drawn without this Ship's jump translation
+			flareAnimation->Draw( (int)tx, (int)ty, direction );
+		} else {
+			SpriteManager::Instance()->GetParticles()->DrawLater( flareAnimation->GetCurrentFrame(), (int)tx, (int)ty, direction );
+		}
 
 		status.isAccelerating = false;
 	}
@@ -485,6 +499,21 @@ void Ship::Draw( void ) {
 	}
 }
 
+/**\brief How far from its position this Ship may draw.
+ * \details This covers the engine flare and the slide to the screen edge
+ *          while jumping.
+ */
+int Ship::GetDrawRadius( void ) {
+	int radius = GetRadarSize();
+	if( flareAnimation && model ) {
+		radius += flareAnimation->GetHalfWidth() * 2 + model->GetThrustOffset();
+	}
+	if( status.isJumping ) {
+		radius += Video::GetHalfWidth();
+	}
+	return radius;
+}
+
 /**\brief Fire's ship Primary weapons.
  * \return FireStatus
  */
@@ -597,10 +626,7 @@ FireStatus Ship::FireSlot( int slot, int target )
 	Coordinate slotPosition = Coordinate( weaponSlots[slot].x, weaponSlots[slot].y ).RotateTo( angle ) + GetWorldPosition();
 
 	// Fire the weapon
-	Projectile *projectile = new Projectile(status.damageBooster, projectileAngle, slotPosition, GetMomentum(), currentWeapon);
-	projectile->SetOwnerID( this->GetID() );
-	projectile->SetTargetID( target );
-	sprites->Add( (Sprite*)projectile );
+	sprites->GetProjectiles()->Fire( currentWeapon, status.damageBooster, projectileAngle, slotPosition, GetMomentum(), this->GetID(), target );
 
 	// Consume ammo
 	ammo[currentWeapon->GetAmmoType()] -=  currentWeapon->GetAmmoConsumption();
@@ -623,7 +649,7 @@ void Ship::Explode( lua_State *L )
 	}
 
 	// Create Explosion
-	sprites->Add( new Effect( GetWorldPosition(), "Resources/Animations/explosion1.ani", 0) );
+	sprites->GetParticles()->Emit( "Resources/Animations/explosion1.ani", GetWorldPosition(), Coordinate(), 0.0f );
 
 	// Remove this Sprite from the SpriteManager
 	sprites->Delete( (Sprite*)this );
@@ -14,7 +14,6 @@
 #include "Sprites/sprite.h"
 #include "Engine/commodities.h"
 #include "Engine/weapons.h"
-#include "Sprites/projectile.h"
 #include <map>
 
 class Ship : public Sprite {
@@ -24,7 +23,9 @@ class Ship : public Sprite {
 		
 		// Fundamental Sprite Mechanics
 		void Update( lua_State *L );
+		void UpdateNative( SpriteCommands *commands );
 		void Draw( void );
+		int GetDrawRadius( void );
 
 		// Movement Mechanics
 		void Rotate( float direction );
@@ -32,6 +33,11 @@ class Ship : public Sprite {
 		bool Jump( Coordinate position, bool jumpDrive );
 		bool JumpDrive( Coordinate position );
 
+		// Movement Commands, so that they can be repeated
+		void ClearMoveCommands() { status.accelerated = false; status.unfinishedTurn = 0.0f; }
+		bool HasAccelerated() { return status.accelerated; }
+		float GetUnfinishedTurn() { return status.unfinishedTurn; }
+
 		// Combat Mechanics
 		FireStatus FirePrimary( int target = -1 );
 		FireStatus FireSecondary( int target = -1 );
@@ -157,6 +163,10 @@ class Ship : public Sprite {
 			bool isRotatingRight;  ///< Cleared by update, set by turning right (so it's always updated twice a loop)
 			bool isDisabled; ///< Set when a ship is disabled (cannot move, may self-repair)
 			bool isJumping; ///< Set when a ship is currently jumping
+
+			/* Movement Commands */
+			bool accelerated; ///< Set by Accelerate, cleared by ClearMoveCommands
+			float unfinishedTurn; ///< The part of the last Rotate that was beyond this tick's turning rate, in degrees
 		} status;
 
 		// Weapon Systems
@@ -9,21 +9,29 @@
 #include "includes.h"
 #include "common.h"
 #include "Sprites/sprite.h"
+#include "Sprites/spritemanager.h"
 #include "Utilities/log.h"
+#include "Utilities/quadtree.h"
 #include "Utilities/timer.h"
 
 /** \addtogroup Sprites
  * @{
  */
 
-// Sprite ID 0 is only used as a NULL
-long int Sprite::sprite_ids = 1;
+// Sprite ID 0 is only used as a NULL.  Generations start at 1, so no ID is 0.
+vector<unsigned short> Sprite::idGenerations;
+deque<unsigned int> Sprite::freeIDSlots;
+KinematicsTable Sprite::kinematics;
 
 /**\class Sprite
  * \brief Supertype for all drawable objects existing at a point in the universe with an angle and momentum.
  * \details Sprites are the objects that move around the universe.
  *          They may be created and destroyed.
- *          Each Sprite has a Unique ID.
+ *          Each Sprite has a Unique ID.  The low bits of the ID are a slot
+ *          that is reused once the Sprite is gone, and the high bits are a
+ *          generation that changes every time the slot is reused.  That lets
+ *          the SpriteManager find a Sprite by indexing an array, and an ID
+ *          kept after its Sprite was deleted simply finds nothing.
  *
  *          Only the SpriteManager should ever store pointers to Sprite
  *          objects.  This is because only the SpriteManager is informed when a
@@ -32,11 +40,17 @@ long int Sprite::sprite_ids = 1;
  *
  *          Sprites are drawn based on their Draw Order and their id.  This
  *          means that all Planets are drawn below all ships, which are drawn
- *          below all Effects.  The Draw Order should also be used to detect
+ *          below all Effects.  Within a Draw Order the id just keeps the order
+ *          stable from one frame to the next.  The Draw Order should also be used to detect
  *          the kind of Sprite given just a Sprite pointer.
  * 
  *          Sprites share Image objects to save on memory usage.
  *
+ *          The position and momentum of a Sprite are not kept in the object
+ *          itself but in a row of the KinematicsTable, picked by the slot of
+ *          its ID.  That lets every Sprite that moves this tick be moved
+ *          by one pass over the table.
+ *
  * \TODO Move function implementations to the .cpp file.
  * \warn NEVER STORE SPRITE POINTERS (unless you are the SpriteManager)!
  *       Instead store the sprite's unique ID and query the SpriteManager for
@@ -52,7 +66,9 @@ long int Sprite::sprite_ids = 1;
  *          Sets the radarColor as Grey.
  */
 Sprite::Sprite() {
-	id = sprite_ids++;
+	id = AllocateID();
+	kinematics.Reserve( GetIDSlot( id ) );
+	kinematics.Clear( GetIDSlot( id ) );
 
 	// Momentum caps
 
@@ -64,35 +80,156 @@ Sprite::Sprite() {
 	radarColor = WHITE * 0.7f;
 
 	lastUpdateFrame = Timer::GetLogicalFrameCount();
+	managerSlot = 0;
+}
+
+/**\brief Copy a Sprite.
+ * \details The copy gets its own ID, and is not in any SpatialIndex.
+ */
+Sprite::Sprite( const Sprite& other ) {
+	id = AllocateID();
+	kinematics.Reserve( GetIDSlot( id ) );
+	managerSlot = 0;
+	CopyFrom( other );
+}
+
+/**\brief Copy another Sprite's position, motion and appearance.
+ * \details This Sprite keeps its own ID and place in the SpriteManager.
+ */
+Sprite& Sprite::operator=( const Sprite& other ) {
+	if( this != &other ) {
+		int oldRadarSize = radarSize;
+		CopyFrom( other );
+		if( radarSize != oldRadarSize ) {
+			SpriteManager::RadarSizeChanged( this, oldRadarSize );
+		}
+	}
+	return *this;
+}
+
+/**\brief Release the Sprite's ID so that its slot can be reused.
+ * \details Its row of the kinematics is emptied so that it no longer moves.
+ */
+Sprite::~Sprite() {
+	kinematics.Clear( GetIDSlot( id ) );
+	ReleaseID( id );
+}
+
+/**\brief Copy everything except for the ID and the bookkeeping.
+ */
+void Sprite::CopyFrom( const Sprite& other ) {
+	kinematics.Copy( GetIDSlot( other.id ), GetIDSlot( id ) );
+	image = other.image;
+	angle = other.angle;
+	radarSize = other.radarSize;
+	radarColor = other.radarColor;
+	lastUpdateFrame = other.lastUpdateFrame;
+	playerCheck = other.playerCheck;
+}
+
+/**\brief Get an ID that no living Sprite is using.
+ * \details Slots are reused oldest first, and only once enough of them are
+ *          free.  An ID therefore only comes back after a great many Sprites
+ *          have been created and destroyed.
+ */
+int Sprite::AllocateID() {
+	unsigned int slot;
+	if( freeIDSlots.size() > SPRITE_ID_MIN_FREE ) {
+		slot = freeIDSlots.front();
+		freeIDSlots.pop_front();
+	} else {
+		slot = idGenerations.size();
+		if( slot > SPRITE_ID_SLOT_MASK ) {
+			LogMsg(ERR, "There are too many Sprites (%u).", slot );
+			assert( slot <= SPRITE_ID_SLOT_MASK );
+		}
+		idGenerations.push_back( 1 );
+	}
+	return ( idGenerations[slot] << SPRITE_ID_SLOT_BITS ) | slot;
+}
+
+/**\brief Make an ID's slot available again under a new generation.
+ */
+void Sprite::ReleaseID( int id ) {
+	unsigned int slot = GetIDSlot( id );
+	idGenerations[slot] = ( idGenerations[slot] == SPRITE_ID_MAX_GENERATION ) ? 1 : idGenerations[slot] + 1;
+	freeIDSlots.push_back( slot );
 }
 
 Coordinate Sprite::GetWorldPosition( void ) const {
-	return worldPosition;
+	return kinematics.GetPosition( GetIDSlot( id ) );
+}
+
+/**\brief Where this Sprite was at the start of the current logical frame.
+ * \details Sprites that were not Updated during the current frame have not
+ *          moved, so this is the same as their current position.
+ *          Setting the position directly (jumping, for example) is not
+ *          considered movement.
+ */
+Coordinate Sprite::GetPreviousWorldPosition( void ) const {
+	if( lastUpdateFrame != Timer::GetLogicalFrameCount() ) {
+		return kinematics.GetPosition( GetIDSlot( id ) );
+	}
+	return kinematics.GetPreviousPosition( GetIDSlot( id ) );
+}
+
+/**\brief Change this Sprite's Image, and its radar size with it.
+ */
+void Sprite::SetImage( Image *image ) {
+	assert(image);
+	int oldRadarSize = radarSize;
+	this->image = image;
+	this->radarSize = ( image->GetWidth() + image->GetHeight() ) /(2);
+	SyncSpatialHandle();
+	if( radarSize != oldRadarSize ) {
+		SpriteManager::RadarSizeChanged( this, oldRadarSize );
+	}
 }
 
 void Sprite::SetWorldPosition( Coordinate coord ) {
-	worldPosition = coord;
+	kinematics.SetPosition( GetIDSlot( id ), coord );
+	SyncSpatialHandle();
 }
 
+/**\brief Refresh the copy of this Sprite that its QuadTree Leaf searches.
+ * \details The Leaf keeps this Sprite's position, radar size and draw order
+ *          next to its pointer.  This has to be called whenever one of them
+ *          changes, which the SpriteManager does for every Sprite it moves.
+ * \see QuadLeafBucket
+ */
+void Sprite::SyncSpatialHandle( void ) {
+	if( spatialHandle.bucket != NULL ) {
+		spatialHandle.bucket->Store( spatialHandle.slot, this );
+	}
+}
 
-/**\brief Move this Sprite in the direction of their current momentum.
+
+/**\brief Get ready to move this Sprite in the direction of its current momentum.
  * \details Since this is a space simulation, there is no Friction; momentum does not decrease over time.
+ *
+ * This only counts the logical frames since this Sprite last moved.  The
+ * movement itself happens for every Sprite at once in Integrate, which the
+ * SpriteManager runs after every Sprite's Update(L) and before any of their
+ * UpdateNative.
+ * \param currentFrame The logical frame count, looked up once by the caller for every Sprite.
+ * \see SpriteManager::Update
  */
-void Sprite::Update( lua_State *L ) {
-	Uint32 currentFrame = Timer::GetLogicalFrameCount();
-
+void Sprite::StartMove( Uint32 currentFrame ) {
 	Uint32 framesSinceUpdate = (currentFrame > lastUpdateFrame) 
 						? (currentFrame - lastUpdateFrame) 
 						: (lastUpdateFrame - currentFrame);
 
 	lastUpdateFrame = currentFrame;
 
-	// Apply their momentum to change their coordinates - apply it as often as the num frames that we've skipped
-	worldPosition += (momentum * framesSinceUpdate);
-	
-	// update acceleration - we do not care about the framesSinceUpdate for updating thesef
-	acceleration = lastMomentum - momentum; 
-	lastMomentum = momentum;
+	// Apply their momentum once for each frame that we've skipped
+	kinematics.Step( GetIDSlot( id ), framesSinceUpdate );
+}
+
+/**\brief Move every Sprite that StartMove was called on.
+ * \see KinematicsTable::Integrate
+ */
+void Sprite::Integrate( void ) {
+	kinematics.Integrate();
 }
 
 /**\brief Draw
@@ -104,8 +241,9 @@ void Sprite::Update( lua_State *L ) {
 void Sprite::Draw( void ) {
 	int wx, wy;
 
-	wx = worldPosition.GetScreenX();
-	wy = worldPosition.GetScreenY();
+	Coordinate position = GetWorldPosition();
+	wx = position.GetScreenX();
+	wy = position.GetScreenY();
 	
 	if( image ) {
 		image->DrawCentered( wx, wy, angle );
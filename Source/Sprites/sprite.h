@@ -13,6 +13,7 @@
 #include "Graphics/video.h"
 #include "Utilities/lua.h"
 #include "Utilities/coordinate.h"
+#include "Sprites/kinematics.h"
 
 // With the draw order, higher numbers are drawn later (on top)
 // By using non-overlapping bits we can bit mask during searches
@@ -24,19 +25,69 @@
 #define DRAW_ORDER_GATE_TOP            0x0020 ///< Draw order for Gate Sprites (Above all Ship Sprites)
 #define DRAW_ORDER_EFFECT              0x0040 ///< Draw order for Effect Sprites (Explosions)
 #define DRAW_ORDER_ALL                 0xFFFF ///< Default DRAW_ORDER for searches that filter.
+#define DRAW_ORDER_STATIC              (DRAW_ORDER_PLANET | DRAW_ORDER_GATE_BOTTOM | DRAW_ORDER_GATE_TOP) ///< Sprites that never move.
+
+// Sprite IDs are a slot number with a generation above it
+#define SPRITE_ID_SLOT_BITS            18     ///< Enough slots for 262144 Sprites at once.
+#define SPRITE_ID_SLOT_MASK            ((1 << SPRITE_ID_SLOT_BITS) - 1)
+#define SPRITE_ID_MAX_GENERATION       ((1 << (31 - SPRITE_ID_SLOT_BITS)) - 1)
+#define SPRITE_ID_MIN_FREE             1024   ///< Free slots are only reused once there are this many, so that stale IDs take longer to come around.
+
+class QuadTree;
+struct QuadLeafBucket;
+class Sprite;
+
+/**\brief Changes to the SpriteManager requested during the native Update.
+ * \details Sprites can't Add or Delete Sprites while the native Update runs
+ *          on several threads.  Each worker records them here instead, and the
+ *          SpriteManager applies them once every worker has finished.
+ * \see Sprite::UpdateNative
+ */
+struct SpriteCommands {
+	void Add( Sprite *sprite ) { added.push_back( sprite ); }
+	void Delete( Sprite *sprite ) { deleted.push_back( sprite ); }
+
+	vector<Sprite*> added;    ///< Sprites to Add, in the order they were requested.
+	vector<Sprite*> deleted;  ///< Sprites to Delete.
+};
+
+/**\brief Where a SpatialIndex is keeping a Sprite.
+ * \details Only the SpatialIndex holding the Sprite reads or writes this.
+ *          It lets the index unlink the Sprite without searching for it.
+ */
+struct SpatialHandle {
+	SpatialHandle() :leaf(NULL), bucket(NULL), cell(-1), slot(0) {}
+
+	QuadTree *leaf;          ///< The QuadTree Leaf holding this Sprite, or NULL.
+	QuadLeafBucket *bucket;  ///< The bucket of that Leaf holding this Sprite.
+	int cell;                ///< The SpatialHash cell holding this Sprite, or -1.
+	unsigned int slot;       ///< The position of this Sprite in its bucket or cell.
+};
 
 class Sprite {
 	public:
 		Sprite();
-		virtual ~Sprite() {};
+		Sprite( const Sprite& other );
+		Sprite& operator=( const Sprite& other );
+		virtual ~Sprite();
 
 		Coordinate GetWorldPosition( void ) const;
+		Coordinate GetPreviousWorldPosition( void ) const;
 		void SetWorldPosition( Coordinate coord );
 
-		virtual void Update( lua_State *L );
+		/// The part of the Update that uses Lua or other Sprites.  Run one Sprite at a time.
+		virtual void Update( lua_State *L ) {}
+		void StartMove( Uint32 currentFrame );
+		static void Integrate( void );
+		/// The part of the Update that only touches this Sprite, after it has moved.  Run on several threads at once, so Adds and Deletes go through the commands.
+		virtual void UpdateNative( SpriteCommands *commands ) {}
+		Uint32 GetLastUpdateFrame( void ) const { return lastUpdateFrame; }
 		virtual void Draw( void );
+		/// How far from its position this Sprite may draw.  Used for culling.
+		virtual int GetDrawRadius( void ) { return radarSize; }
 
 		int GetID( void ) { return id; }
+		static unsigned int GetIDSlot( int id ) { return id & SPRITE_ID_SLOT_MASK; }
 
 		float GetAngle( void ) const {
 			return( angle );
@@ -45,19 +96,15 @@ class Sprite {
 			this->angle = angle;
 		}
 		Coordinate GetMomentum( void ) const {
-			return momentum;
+			return kinematics.GetMomentum( GetIDSlot( id ) );
 		}
 		void SetMomentum( Coordinate momentum ) {
-			this->momentum = momentum;
+			kinematics.SetMomentum( GetIDSlot( id ), momentum );
 		}
 		Coordinate GetAcceleration( void ) const {
-			return acceleration;
-		}
-		void SetImage( Image *image ) {
-			assert(image);
-			this->image = image;
-			this->radarSize = ( image->GetWidth() + image->GetHeight() ) /(2);
+			return kinematics.GetAcceleration( GetIDSlot( id ) );
 		}
+		void SetImage( Image *image );
 		void SetRadarColor( Color col ){
 			this->radarColor = col;
 		}
@@ -68,19 +115,28 @@ class Sprite {
 		virtual Color GetRadarColor( void ) { return radarColor; }
 		virtual int GetDrawOrder( void ) = 0;
 
+		SpatialHandle& GetSpatialHandle( void ) { return spatialHandle; }
+		void SyncSpatialHandle( void );
+		unsigned int GetManagerSlot( void ) { return managerSlot; }
+		void SetManagerSlot( unsigned int slot ) { managerSlot = slot; }
+
 	private:
-		static long int sprite_ids; ///< The ID for the next Sprite.
+		static int AllocateID();
+		static void ReleaseID( int id );
+		void CopyFrom( const Sprite& other );
+
+		static vector<unsigned short> idGenerations; ///< The current generation of every ID slot.
+		static deque<unsigned int> freeIDSlots; ///< ID slots that are not in use, oldest first.
+		static KinematicsTable kinematics; ///< The position and motion of every Sprite, by ID slot.
 
-		int id; ///< The unique ID of this Sprite.
-		Coordinate worldPosition; ///< The Current position of this Sprite.
-		Coordinate momentum; ///< The current Speed and Direction that this Sprite is moving (not pointing).
-		Coordinate acceleration; ///< The ammount that the Sprite accelerated during the previous Update.
-		Coordinate lastMomentum; ///< The momentum that this Sprite had after the previous Update.
+		int id; ///< The unique ID of this Sprite.  Its slot is also this Sprite's row of the kinematics.
 		Image *image; ///< The current Image that this Sprite is using.
 		float angle; ///< The current direction that this Sprite is pointing (not moving).
 		int radarSize; ///< A Rough appoximation of this Sprite's size.
 		Color radarColor; ///< The color of this Sprite.
 		Uint32 lastUpdateFrame; ///< The # of the logical frame that this sprite was last updated
+		SpatialHandle spatialHandle; ///< Where the SpatialIndex is keeping this Sprite.
+		unsigned int managerSlot; ///< The position of this Sprite in the SpriteManager's list.
 
     protected:
         bool playerCheck;              ///< Flag for player Sprite, true if the Sprite is an instance of Player class
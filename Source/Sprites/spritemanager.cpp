@@ -9,9 +9,17 @@
 #include "common.h"
 #include "Sprites/ai.h"
 #include "Sprites/effects.h"
+#include "Sprites/ship.h"
 #include "Sprites/spritemanager.h"
+#include "Sprites/statemachine.h"
 #include "Utilities/log.h"
-#include "Utilities/quadtree.h"
+#include "Utilities/options.h"
+#include "Utilities/profiler.h"
+#include "Utilities/quadrantindex.h"
+#include "Utilities/spatialhash.h"
+#include "Utilities/staticindex.h"
+#include "Utilities/timer.h"
+#include "Utilities/workerpool.h"
 #include "Engine/camera.h"
 #include "Engine/simulation_lua.h"
 
@@ -27,54 +35,114 @@
  * The Sprites themselves are stored on the Heap, but are recorded by the
  * SpriteManager in three different structures.
  * - The SpriteManager has a list of all sprites.
- *   - This list is ordered by sprite creations, but the order is not enforced.
+ *   - This list is not ordered.  Each Sprite remembers its position in the
+ *     list so that it can be removed without a search.
  *   - This list can be requested as a whole, or filtered by requesting only a
  *     certain Sprite Type.
  *   \see GetSprites
- * - The SpriteManager has a set of QuadTrees.
- *   - The QuadTree is a recursive datastructure that stores the Sprites by their
- *     Universal location.  The Quadtree segments the Sprites based on how
- *     relativly close the Sprites are.
- *   - Each QuadTree is only a finite size, but can theoretically hold an infinte
- *     number of sprites.
- *   - The entire universe is broken up into a grid of QuadTrees.
- *     Only grid positions with Sprites in them are actually populated by QuadTrees.
- *   - The QuadTrees cannot be accessed directly, but are used implicitely when
+ * - The SpriteManager has a SpatialIndex.
+ *   - The SpatialIndex stores the Sprites by their Universal location.
+ *   - There are two kinds of index, chosen by the
+ *     "options/simulation/spatial-index" option:
+ *     - "quadtree": The universe is broken up into a grid of QuadTrees.
+ *       The Quadtree segments the Sprites based on how relativly close the
+ *       Sprites are.
+ *     - "hash": The universe is broken up into a uniform grid of small cells
+ *       found through a hash table.
+ *   - Planets and Gates never move, so they are kept apart in a StaticIndex
+ *     that is only rebuilt when they change.  Queries search whichever of
+ *     the two indexes their type mask needs.
+ *   - The index cannot be accessed directly, but is used implicitely when
  *     requesting sprites by a location.
- *   \see QuadTree
+ *   \see QuadrantIndex
+ *   \see SpatialHash
+ *   \see StaticIndex
+ *   \see ForEachSpriteNear
  *   \see GetSpritesNear
  *   \see GetNearestSprite
- * - The SpriteManager has a map of all Sprites by their unique ID.
+ * - The SpriteManager has a lookup of all Sprites by their unique ID.
  *   - Sprites can be queried by passing an ID.
+ *   - The lookup is an array indexed by the slot part of the ID.  Each
+ *     entry remembers the full ID, so stale IDs find nothing.
  *   \see GetSpriteByID
  *
+ * Each tick is Updated in two phases.  First the Sprites that are due run
+ * their Update(L) one at a time; this is where they think, use Lua and look
+ * at each other.  The AIs in batched states are queued as they think and
+ * Decide together at the end of this phase.  Then those Sprites are all
+ * moved together by a single pass over the Sprite kinematics.  Finally every one of them runs its
+ * UpdateNative, which only touches that Sprite, on a pool of worker threads.  Sprites that
+ * want to Add or Delete Sprites during the native phase leave commands for
+ * the SpriteManager, which carries them out once the workers are done.
+ *   \see Update
+ *
+ * Projectiles are not Sprites and are in none of these structures.  The
+ * SpriteManager keeps them in a ProjectileSystem, which moves them once
+ * every Sprite has moved and then lets them hit the Ships.
+ *   \see ProjectileSystem
+ *
+ * Hits and explosions are not Sprites either.  They are played by a
+ * ParticleSystem, which is drawn above all of the Sprites.
+ *   \see ParticleSystem
+ *
  * Sprites are never deleted immediately.  This is to prevent a Sprite from
  * being deleted during the middle of the Update Loop.  Instead, 'deleted'
  * Sprites are recorded in a list and deleted in a batch once per Update.
  *
  */
 
+/**\brief Runs the native Update of a range of Sprites, then refreshes their copies in the SpatialIndex.
+ * \see Sprite::UpdateNative
+ */
+class NativeUpdate : public WorkerTask {
+	public:
+		NativeUpdate( vector<Sprite*> *_sprites, vector<SpriteCommands> *_commands )
+			:sprites( _sprites ), commands( _commands ) {}
+
+		void Run( unsigned int begin, unsigned int end, unsigned int worker ) {
+			SpriteCommands *mine = &(*commands)[worker];
+			for( unsigned int s = begin; s < end; s++ ) {
+				(*sprites)[s]->UpdateNative( mine );
+				(*sprites)[s]->SyncSpatialHandle();
+			}
+		}
+
+	private:
+		vector<Sprite*> *sprites;
+		vector<SpriteCommands> *commands;
+};
+
 /**\brief Constructs a new sprite manager.
  */
-//initialise the tick stuff - these should probably be set by an option somewhere, hardcode for now
-SpriteManager::SpriteManager() :
-	 tickCount (0)
-	 , semiRegularPeriod (15)		//every 16 ticks we want to have updated the semi-regular distance quadrants
-	 , fullUpdatePeriod (120)		//update the full quadrant map every 120 ticks
-	 , numRegularBands (2)			//the regular (per-tick) updates are on this number of bands
-	 , numSemiRegularBands (5)		//the semi-regular updates are on this number of bands - this SHOULD be easily divisible into semiRegularPeriod
-{
+SpriteManager::SpriteManager() {
 	player = NULL;
 
-	spritelist = new list<Sprite*>();
-	spritelookup = new map<int,Sprite*>();
+	if( OPTION(string,"options/simulation/spatial-index") == "hash" ) {
+		index = new SpatialHash( OPTION(float,"options/simulation/spatial-hash-cellsize") );
+	} else {
+		index = new QuadrantIndex();
+	}
+	staticIndex = new StaticIndex();
 
-	//fill in the ticksToBandNum map based on the semiRegularPeriod and numSemiRegularBands
-	int updateGap = semiRegularPeriod / numSemiRegularBands;
+	spritelist = new vector<Sprite*>();
+	spritelookup = new vector<SpriteLookup>();
 
-	for (int i = 0; i < numSemiRegularBands; i ++) {
-		ticksToBandNum[(updateGap * i)] = numRegularBands + 1 + i;		//assign one of the semi-regular bands to a tick
+	// Without any tiers, the filter updates everything every tick.
+	if( OPTION(int,"options/simulation/lod") ) {
+		updateFilter.AddTier( OPTION(int,"options/simulation/lod-near-bands"), 1 );
+		updateFilter.AddTier( OPTION(int,"options/simulation/lod-middle-bands"), OPTION(Uint32,"options/simulation/lod-middle-period") );
+		updateFilter.AddTier( OPTION(int,"options/simulation/lod-far-bands"), OPTION(Uint32,"options/simulation/lod-far-period") );
+		updateFilter.AddTier( -1, OPTION(Uint32,"options/simulation/lod-distant-period") );
 	}
+	updateBudget = OPTION(Uint32,"options/simulation/lod-budget");
+
+	workers = new WorkerPool( OPTION(Uint32,"options/simulation/update-threads") );
+	commands.resize( workers->GetNumWorkers() );
+
+	maxShipRadarSize = 0;
+	maxShipRadarStale = false;
+
+	ResetPhaseTimes();
 }
 
 /**\brief Assignment operator for class SpriteManager.
@@ -83,24 +151,19 @@ SpriteManager::SpriteManager() :
 SpriteManager& SpriteManager::operator=( SpriteManager& object ){
 	if ( this == &object ) return * this; //block self assignment
 	
-	trees = object.trees;
+	index = object.index;
+	staticIndex = object.staticIndex;
 	spritelist = object.spritelist;
 	spritelookup = object.spritelookup;
 	
 	spritesToDelete = object.spritesToDelete;
-	
-	tickCount = object.tickCount;
-//	semiRegularPeriod = object.semiRegularPeriod;
-//	fullUpdatePeriod = object.fullUpdatePeriod;
-	
-//	numRegularBands = object.numRegularBands;
-//	numSemiRegularBands = object.numSemiRegularBands;
-	ticksToBandNum = object.ticksToBandNum;
 
-	northEdge = object.northEdge;
-	southEdge = object.southEdge;
-	eastEdge = object.eastEdge;
-	westEdge = object.westEdge;
+	workers = object.workers;
+	commands.resize( workers->GetNumWorkers() );
+
+	updateFilter = object.updateFilter;
+	updateBudget = object.updateBudget;
+	interesting = object.interesting;
 
 	return * this;
 }
@@ -121,9 +184,25 @@ SpriteManager *SpriteManager::Instance( void ) {
  * \param sprite Pointer to the sprite
  */
 void SpriteManager::Add( Sprite *sprite ) {
+	sprite->SetManagerSlot( spritelist->size() );
 	spritelist->push_back(sprite);
-	spritelookup->insert(make_pair(sprite->GetID(),sprite));
-	GetQuadrant( sprite->GetWorldPosition() )->Insert( sprite );
+	unsigned int slot = Sprite::GetIDSlot( sprite->GetID() );
+	if( slot >= spritelookup->size() ) {
+		spritelookup->resize( slot + 1 );
+	}
+	(*spritelookup)[slot].id = sprite->GetID();
+	(*spritelookup)[slot].sprite = sprite;
+
+	GetIndexFor( sprite )->Insert( sprite );
+	ShipRadarSizeChanged( sprite, 0, sprite->GetRadarSize() );
+}
+
+/**\brief Choose the SpatialIndex that holds a Sprite.
+ * \details Planets and Gates never move, so they are kept out of the way of
+ *          the moving Sprites in a StaticIndex.
+ */
+SpatialIndex *SpriteManager::GetIndexFor( Sprite *sprite ) {
+	return (sprite->GetDrawOrder() & DRAW_ORDER_STATIC) ? staticIndex : index;
 }
 
 /**\brief Adds player sprite to the manager.
@@ -142,9 +221,16 @@ void SpriteManager::AddPlayer( Sprite *sprite ) {
 bool SpriteManager::DeleteSprite( Sprite *sprite ) {
 	if(sprite == player) LogMsg(ALERT, "Deleting player sprite. Should we be doing this?");
 
-	spritelist->remove(sprite);
-	spritelookup->erase( sprite->GetID() );
-	GetQuadrant( sprite->GetWorldPosition() )->Delete( sprite );
+	// Fill the hole with the last Sprite
+	unsigned int slot = sprite->GetManagerSlot();
+	assert( (*spritelist)[slot] == sprite );
+	(*spritelist)[slot] = spritelist->back();
+	(*spritelist)[slot]->SetManagerSlot( slot );
+	spritelist->pop_back();
+
+	(*spritelookup)[ Sprite::GetIDSlot( sprite->GetID() ) ] = SpriteLookup();
+	GetIndexFor( sprite )->Delete( sprite );
+	ShipRadarSizeChanged( sprite, sprite->GetRadarSize(), 0 );
 	// Delete the sprite itself unless it is a Planet or Player.
 	// Planets and Players are special sprites since they are Components and get saved.
 	if( !(sprite->GetDrawOrder() & (DRAW_ORDER_PLAYER | DRAW_ORDER_PLANET | DRAW_ORDER_GATE_TOP | DRAW_ORDER_GATE_BOTTOM)) ) {
@@ -164,67 +250,62 @@ bool SpriteManager::Delete( Sprite *sprite ) {
 }
 
 /**\brief SpriteManager update function.
- * \details Update the sprites inside each quadrant
- * \param lowFps If true, forces the wave-update method to be used rather than the full-update
+ * \details Update the sprites inside each region that is due.  Regions are
+ *          due more often the closer they are to the camera, the player and
+ *          the interesting Sprites.
+ * \see SpatialUpdateFilter
  */
-void SpriteManager::Update( lua_State *L, bool lowFps) {
-	//this will contain every quadrant that we will potentially want to update
-	list<QuadTree*> quadList;
-	
-	//if update-all is given then we update every quadrant
-	//we do the same if tickCount == 0 even if update-all is not given
-	// (in wave update mode, tickCount == 0 is when we want to update all quadrants)
-	if( ! lowFps || tickCount == 0) {
-		//need to get all of the quadrants in our map
-		GetAllQuadrants(&quadList);
-	}
-	else
-	{
-		//wave update mode with tickCount != 0 -- update some quadrants
-		Camera* camera = Simulation_Lua::GetSimulation(L)->GetCamera();
-		Coordinate currentPoint (camera->GetFocusCoordinate());	//always update centered on where we're at
-
-		quadList.push_back (GetQuadrant (currentPoint)); //we ALWAYS update the current quadrant
-
-		//we also ALWAYS update the 'regular' bands
-		//	the first band is at index 1 - index 0 would be the single quadrant in the middle
-		//	when we get the list of quadrants back we splice them onto the end of our overall list
-		for (int i = 1; i <= numRegularBands; i ++) {
-			list<QuadTree*> tempBandList = GetQuadrantsInBand (currentPoint, i);
-			quadList.splice (quadList.end(), tempBandList);
-		}
+void SpriteManager::Update( lua_State *L ) {
+	Camera* camera = Simulation_Lua::GetSimulation(L)->GetCamera();
 
-		//now - we SOMETIMES update the semi-regular bands
-		//   the ticks that each band is updated in is stored in the map
-		//   so we get our semiRegular update modulus of the ticks and then check the map
-		//    - the map has the tick index as the key and the band to update as the value
-		int semiRegularTick = tickCount % semiRegularPeriod;
-		map<int,int>::iterator findBand = ticksToBandNum.find (semiRegularTick);
-		if (findBand != ticksToBandNum.end()) {		//found the key
-			//cout << "tick = " << tickCount << ", semiRegularTick = " << semiRegularTick << ", band = " << findBand->second << endl;
-			list<QuadTree*> tempBandList = GetQuadrantsInBand (currentPoint, findBand->second);
-			quadList.splice (quadList.end(), tempBandList);
-		}
-		else {
-			//no semi-regular bands to update at this tick, do nothing
+	updateFilter.ClearFoci();
+	updateFilter.AddFocus( camera->GetFocusCoordinate() );
+	if( player != NULL ) {
+		updateFilter.AddFocus( player->GetWorldPosition() );
+	}
+	unsigned int watched = 0;
+	while( watched < interesting.size() ) {
+		Sprite *sprite = GetSpriteByID( interesting[watched] );
+		if( sprite == NULL ) {
+			// The Sprite is gone; stop watching it.
+			interesting[watched] = interesting.back();
+			interesting.pop_back();
+			continue;
 		}
+		updateFilter.AddFocus( sprite->GetWorldPosition() );
+		++watched;
 	}
-
-	// Find and Fix any Sprites that have moved out of bounds.
-	list<Sprite *> all_oob;
-	list<QuadTree*>::iterator iter;
-	for ( iter = quadList.begin(); iter != quadList.end(); ++iter ) {
-		(*iter)->Update(L);
-		list<Sprite *>* oob = (*iter)->FixOutOfBounds();
-		all_oob.splice(all_oob.end(), *oob );
-		delete oob;
+	updateFilter.StartTick( updateBudget );
+
+	// Let the Sprites think, one at a time
+	Uint64 started = Timer::GetMicroseconds();
+	updatedSprites.clear();
+	staticIndex->Update( L, updateFilter, &updatedSprites );
+	index->Update( L, updateFilter, &updatedSprites );
+	StateMachine::RunBatches( L );
+	EndPhase( UPDATE_PHASE_THINK, &started );
+
+	// Then move them, all at once
+	Uint32 frame = Timer::GetLogicalFrameCount();
+	vector<Sprite*>::iterator moving;
+	for( moving = updatedSprites.begin(); moving != updatedSprites.end(); ++moving ) {
+		(*moving)->StartMove( frame );
 	}
+	Sprite::Integrate();
+	NativeUpdate native( &updatedSprites, &commands );
+	workers->Run( &native, updatedSprites.size(), SPRITE_UPDATE_CHUNK );
+	ApplyCommands();
+	EndPhase( UPDATE_PHASE_MOVE, &started );
+
+	// Now that everything has moved, fly the Projectiles and let them hit the Ships
+	projectiles.Update( this, frame );
+	projectiles.Collide( this, GetMaxShipTravel(), GetMaxShipRadarSize() );
+	EndPhase( UPDATE_PHASE_PROJECTILES, &started );
+
+	particles.Update( frame );
+	EndPhase( UPDATE_PHASE_PARTICLES, &started );
 
-	// Move sprites to adjacent Quadrants as they cross boundaries
 	list<Sprite *>::iterator i;
-	for( i = all_oob.begin(); i != all_oob.end(); ++i ) {
-		GetQuadrant( (*i)->GetWorldPosition() )->Insert( *i );
-	}
 
 	// Delete all sprites queued to be deleted
 	if (!spritesToDelete.empty()) {
@@ -243,94 +324,200 @@ void SpriteManager::Update( lua_State *L, bool lowFps) {
 		}
 		spritesToDelete.clear();
 	}
+	EndPhase( UPDATE_PHASE_DELETE, &started );
+
+	// Move the Sprites between regions as they cross boundaries
+	index->ReBallance();
+	staticIndex->ReBallance();
+	EndPhase( UPDATE_PHASE_REBALLANCE, &started );
 
-	for ( iter = quadList.begin(); iter != quadList.end(); ++iter ) {
-		(*iter)->ReBallance();
+	if( updateFilter.GetNumDeferred() > 0 ) {
+		LogMsg(DEBUG4, "Deferred %u regions to keep within the %u microsecond budget.", updateFilter.GetNumDeferred(), updateBudget );
 	}
+}
 
-	DeleteEmptyQuadrants();
+/**\brief The microseconds spent in one part of Update since the last ResetPhaseTimes.
+ * \param phase A SpriteUpdatePhase.
+ */
+Uint64 SpriteManager::GetPhaseTime( int phase ) {
+	if( phase < 0 || phase >= UPDATE_PHASES ) {
+		LogMsg(WARN, "There is no Update phase %d.", phase );
+		return 0;
+	}
+	return phaseTimes[phase];
+}
 
-	// Update the tick count after all updates for this tick are done
-	UpdateTickCount ();
+/**\brief The name of one part of Update, for printing.
+ * \param phase A SpriteUpdatePhase.
+ */
+const char* SpriteManager::GetPhaseName( int phase ) {
+	static const char* names[UPDATE_PHASES] = {
+		"Think", "Move", "Projectiles", "Particles", "Delete", "ReBallance"
+	};
+	if( phase < 0 || phase >= UPDATE_PHASES ) {
+		return "Unknown";
+	}
+	return names[phase];
 }
 
-/**\brief Deletes empty QuadTrees (Internal use)
+/**\brief Finish timing one part of Update.
+ * \param phase The SpriteUpdatePhase that just ended.
+ * \param started When it started.  Set to now, when the next part starts.
+ * \details The time is added to the totals of GetPhaseTime, and to the
+ *          ProfilePhase of the same name while the Profiler is running.
  */
-void SpriteManager::DeleteEmptyQuadrants() {
-	map<Coordinate,QuadTree*>::iterator iter;
-	// Delete QuadTrees that are empty
-	// TODO: Delete QuadTrees that are far away from 
-	list<QuadTree*> emptyTrees;
-	// Collect empty trees
-	for ( iter = trees.begin(); iter != trees.end(); ++iter ) { 
-		if ( iter->second->Count() == 0 ) {
-			emptyTrees.push_back(iter->second);
+void SpriteManager::EndPhase( int phase, Uint64 *started ) {
+	static const int profilePhases[UPDATE_PHASES] = {
+		PROFILE_THINK, PROFILE_MOVE, PROFILE_PROJECTILES,
+		PROFILE_PARTICLES, PROFILE_DELETE, PROFILE_REBALLANCE
+	};
+	Uint64 finished = Timer::GetMicroseconds();
+	phaseTimes[phase] += finished - *started;
+	Profiler::Add( profilePhases[phase], finished - *started );
+	*started = finished;
+}
+
+/**\brief Start timing the parts of Update from zero.
+ */
+void SpriteManager::ResetPhaseTimes() {
+	for( int phase = 0; phase < UPDATE_PHASES; phase++ ) {
+		phaseTimes[phase] = 0;
+	}
+}
+
+/**\brief Carry out the Adds and Deletes requested during the native Update.
+ * \details The workers are taken in order, but which Sprites each worker
+ *          Updated depends on the timing of the threads.
+ */
+void SpriteManager::ApplyCommands() {
+	vector<SpriteCommands>::iterator worker;
+	vector<Sprite*>::iterator i;
+	for( worker = commands.begin(); worker != commands.end(); ++worker ) {
+		for( i = worker->added.begin(); i != worker->added.end(); ++i ) {
+			Add( *i );
+		}
+		for( i = worker->deleted.begin(); i != worker->deleted.end(); ++i ) {
+			Delete( *i );
 		}
+		worker->added.clear();
+		worker->deleted.clear();
 	}
-	// Delete empty trees
-	list<QuadTree*>::iterator emptyIter;
-	for ( emptyIter = emptyTrees.begin(); emptyIter != emptyTrees.end(); ++emptyIter) {
-		//cout<<"Deleting the empty tree at "<<(*emptyIter)->GetCenter()<<endl;
-		trees.erase((*emptyIter)->GetCenter());
-		delete (*emptyIter);
+}
+
+/**\brief Update the universe around a Sprite as often as around the player.
+ * \param id The ID of the Sprite, such as a mission target or an escort.
+ * \param flag True to start watching the Sprite, false to stop.
+ * \details Sprites stop being interesting when they are deleted.
+ */
+void SpriteManager::SetInteresting( int id, bool flag ) {
+	vector<int>::iterator found = find( interesting.begin(), interesting.end(), id );
+	if( flag && found == interesting.end() ) {
+		interesting.push_back( id );
+	} else if( !flag && found != interesting.end() ) {
+		*found = interesting.back();
+		interesting.pop_back();
 	}
-	if( emptyTrees.size() ) {
-		AdjustBoundaries();
+}
+
+/**\brief The furthest that any Ship moved during this tick.
+ * \details This bounds how far from a Projectile's path a Ship it touched can be.
+ */
+double SpriteManager::GetMaxShipTravel() {
+	double furthest = 0;
+	vector<Sprite*>::iterator i;
+	for( i = updatedSprites.begin(); i != updatedSprites.end(); ++i ) {
+		if( !((*i)->GetDrawOrder() & (DRAW_ORDER_SHIP | DRAW_ORDER_PLAYER)) ) {
+			continue;
+		}
+		double travel = ((*i)->GetWorldPosition() - (*i)->GetPreviousWorldPosition()).GetMagnitudeSquared();
+		if( travel > furthest ) {
+			furthest = travel;
+		}
 	}
+	return sqrt( furthest );
 }
 
-/** \brief Comparator function for ordering Sprites
- *
- * \details The goal here is to order the sprites in a deterministic way.
- *          We also need the Sprites to be ordered by their DRAW_ORDER.
- *          Since the Sprite ID is unique, and monotonically increasing, this
- *          will sort older sprites below newer sprites.
- *
- * \param a A pointer to a Sprite.
- * \param b A pointer to another Sprite.
- * \returns True if Sprite a should be below Sprite b.
- *
- * \relates Sprite
+/**\brief The largest radar size of any Ship.
+ * \details This is kept up to date as Ships are Added and change their Image.
+ *          Every Ship is only checked again after the largest one left or
+ *          shrank.
  */
+double SpriteManager::GetMaxShipRadarSize() {
+	if( maxShipRadarStale ) {
+		maxShipRadarSize = 0;
+		vector<Sprite*>::iterator i;
+		for( i = spritelist->begin(); i != spritelist->end(); ++i ) {
+			if( ((*i)->GetDrawOrder() & (DRAW_ORDER_SHIP | DRAW_ORDER_PLAYER)) && (*i)->GetRadarSize() > maxShipRadarSize ) {
+				maxShipRadarSize = (*i)->GetRadarSize();
+			}
+		}
+		maxShipRadarStale = false;
+	}
+	return maxShipRadarSize;
+}
 
-bool compareSpritePtrs(Sprite* a, Sprite* b){
-	if(a->GetDrawOrder() != b->GetDrawOrder()) {
-		return a->GetDrawOrder() < b->GetDrawOrder();
-	} else {
-		return a->GetID() < b->GetID();
+/**\brief Keep track of the largest radar size as a Sprite comes, goes or changes.
+ * \param oldSize The radar size it had, or 0 if it was not here.
+ * \param newSize The radar size it has now, or 0 if it is leaving.
+ */
+void SpriteManager::ShipRadarSizeChanged( Sprite *sprite, int oldSize, int newSize ) {
+	if( !(sprite->GetDrawOrder() & (DRAW_ORDER_SHIP | DRAW_ORDER_PLAYER)) ) {
+		return;
+	}
+	if( newSize >= maxShipRadarSize ) {
+		maxShipRadarSize = newSize;
+	} else if( oldSize == maxShipRadarSize ) {
+		maxShipRadarStale = true;
 	}
 }
 
+/**\brief Tell the SpriteManager that a Sprite's radar size changed.
+ * \param oldSize The radar size it had before.
+ * \details Sprites that are not in the SpriteManager are ignored.
+ * \see Sprite::SetImage
+ */
+void SpriteManager::RadarSizeChanged( Sprite *sprite, int oldSize ) {
+	if( pInstance == 0 ) {
+		return;
+	}
+	vector<Sprite*> *sprites = pInstance->spritelist;
+	unsigned int slot = sprite->GetManagerSlot();
+	if( slot >= sprites->size() || (*sprites)[slot] != sprite ) {
+		return;
+	}
+	pInstance->ShipRadarSizeChanged( sprite, oldSize, sprite->GetRadarSize() );
+}
+
 /**\brief Draws the current sprites
+ * \details The Projectiles are drawn above the Planets and Gates, but below
+ *          the Ships.  The particles and engine flares are drawn on top.
+ * \see DrawList
  */
 void SpriteManager::Draw( Coordinate focus ) {
-	list<Sprite *>::iterator i;
-	list<Sprite*> *onscreen;
-	float r = (Video::GetHalfHeight() < Video::GetHalfWidth() ? Video::GetHalfWidth() : Video::GetHalfHeight()) *V_SQRT2;
-	onscreen = GetSpritesNear( focus, r, DRAW_ORDER_ALL);
-
-	onscreen->sort(compareSpritePtrs);
-
-	for( i = onscreen->begin(); i != onscreen->end(); ++i ) {
-		(*i)->Draw();
-	}
-	delete onscreen;
+	float halfWidth = static_cast<float>(Video::GetHalfWidth());
+	float halfHeight = static_cast<float>(Video::GetHalfHeight());
+	drawList.Build( this, focus, halfWidth, halfHeight );
+	drawList.Draw( DRAW_ORDER_PLANET, DRAW_ORDER_GATE_BOTTOM );
+	projectiles.Draw( focus, halfWidth, halfHeight );
+	drawList.Draw( DRAW_ORDER_SHIP, DRAW_ORDER_EFFECT );
+	particles.Draw( focus, halfWidth, halfHeight );
 }
 
 /**\brief Draws the current sprites
  */
 void SpriteManager::DrawQuadrantMap( Coordinate focus ) {
-	GetQuadrant( focus )->Draw( GetQuadrantCenter( focus ) );
+	index->Draw( focus );
+	staticIndex->Draw( focus );
 }
 
 /**\brief Retrieves a list of the current sprites.
  * \return std::list of Sprite pointers.
  */
 list<Sprite *> *SpriteManager::GetSprites(int type) {
-	list<Sprite *>::iterator i;
+	vector<Sprite *>::iterator i;
 	list<Sprite *> *filtered;
 	if( type==DRAW_ORDER_ALL ){
-		filtered = new list<Sprite*>(*spritelist);
+		filtered = new list<Sprite*>( spritelist->begin(), spritelist->end() );
 	} else {
 		filtered = new list<Sprite*>();
 		// Collect only the Sprites of this type
@@ -344,127 +531,20 @@ list<Sprite *> *SpriteManager::GetSprites(int type) {
 }
 
 /**\brief Queries for sprite by the ID
+ * \details The slot of the ID indexes straight into the lookup.  An ID whose
+ *          Sprite has been deleted no longer matches the generation stored in
+ *          its slot, so it safely finds nothing.
  * \param id Identification of the sprite.
+ * \returns The Sprite, or NULL if it is not in the SpriteManager.
  */
 Sprite *SpriteManager::GetSpriteByID(int id) {
-	map<int,Sprite*>::iterator val = spritelookup->find( id );
-	if( val != spritelookup->end() ){
-		return val->second;
+	unsigned int slot = Sprite::GetIDSlot( id );
+	if( id > 0 && slot < spritelookup->size() && (*spritelookup)[slot].id == id ) {
+		return (*spritelookup)[slot].sprite;
 	}
 	return NULL;
 }
 
-/**\brief Retrieves nearby QuadTrees in a square band at <bandIndex> quadrants distant from the coordinate
- * \param c Coordinate
- * \param bandIndex number of quadrants distant from c
- * \return std::list of QuadTree pointers.
- */
-list<QuadTree*> SpriteManager::GetQuadrantsInBand ( Coordinate c, int bandIndex) {
-	// The possibleQuadrants here are the quadrants that are in the square band
-	//  at distance bandIndex from the coordinate
-	// After we get the possible quadrants we prune them by making sure they exist
-	//  (ie that something is in them)
-
-	list<QuadTree*> nearbyQuadrants;
-	set<Coordinate> possibleQuadrants;
-
-	//note that the QUADRANTSIZE define is the
-	//	distance from the middle to the edge of a quadrant
-	//to get the square band of co-ordinates we have to
-	//		- start at bottom left 
-	//			loop over increasing Y (to get 'west' line)
-	//			loop over increasing X (to get 'south' line)
-	//		- start at top right
-	//			loop over decreasing Y (to get 'east' line)
-	//			loop over decreasing X (to get 'north' line)
-			
-	int edgeDistance = bandIndex * QUADRANTSIZE * 2;		//number of pixels from middle to the band
-	Coordinate bottomLeft (c - Coordinate (edgeDistance, edgeDistance));
-	Coordinate topLeft (c + Coordinate (-edgeDistance, edgeDistance));
-	Coordinate topRight (c + Coordinate (edgeDistance, edgeDistance));
-	Coordinate bottomRight (c + Coordinate (edgeDistance, -edgeDistance));
-
-	//the 'full' length of one of the lines is (bandindex * 2) + 1
-	//we don't need the +1 as we deal with the corners individually, separately
-	int bandLength = (bandIndex * 2);
-
-	//deal with the un-included corners first
-	//we're using bottomLeft and topRight as the anchors, 
-	// so topLeft and bottomRight are added here
-	possibleQuadrants.insert (GetQuadrantCenter (topLeft));
-	possibleQuadrants.insert (GetQuadrantCenter (bottomRight));
-	for (int i = 0; i < bandLength; i ++) {
-		int offset = ((QUADRANTSIZE * 2) * i);
-		Coordinate west, south, north, east;
-
-		west = GetQuadrantCenter (bottomLeft + Coordinate (0, offset));
-		south = GetQuadrantCenter (bottomLeft + Coordinate (offset, 0));
-		north = GetQuadrantCenter (topRight - Coordinate (offset, 0));
-		east = GetQuadrantCenter (topRight - Coordinate (0, offset));
-
-		possibleQuadrants.insert (west);		//west
-		possibleQuadrants.insert (south);		//south
-		possibleQuadrants.insert (north);		//north
-		possibleQuadrants.insert (east);		//east
-	}
-
-	//here we're checking to see if this possible quadrant is one of the existing quadrants
-	// and if it is then we add its QuadTree to the vector we're returning
-	// if it's not then there's nothing in it anyway so we don't care about it
-	set<Coordinate>::iterator it;
-	map<Coordinate,QuadTree*>::iterator iter;
-	for(it = possibleQuadrants.begin(); it != possibleQuadrants.end(); ++it) {
-		iter = trees.find(*it);
-		if(iter != trees.end()) {
-			nearbyQuadrants.push_back(iter->second);
-		}
-		
-	}
-	return nearbyQuadrants;
-}
-	
-
-/**\brief Retrieves nearby QuadTrees
- * \param c Coordinate
- * \param r Radius
- * \return std::list of QuadTree pointers.
- */
-list<QuadTree*> SpriteManager::GetQuadrantsNear( Coordinate c, float r) {
-	// The possibleQuadrants are those trees adjacent and within a radius r
-	// Gather more trees when r is greater than the size of a quadrant
-	map<Coordinate,QuadTree*>::iterator iter;
-	list<QuadTree*> nearbyQuadrants;
-	set<Coordinate> possibleQuadrants;
-
-	Coordinate center = GetQuadrantCenter(c);
-
-	possibleQuadrants.insert( center );
-	float R = r;
-	do{
-		possibleQuadrants.insert( GetQuadrantCenter(c + Coordinate(-R,-0)));
-		possibleQuadrants.insert( GetQuadrantCenter(c + Coordinate(-0,+R)));
-		possibleQuadrants.insert( GetQuadrantCenter(c + Coordinate(+0,-R)));
-		possibleQuadrants.insert( GetQuadrantCenter(c + Coordinate(+R,+0)));
-		possibleQuadrants.insert( GetQuadrantCenter(c + Coordinate(-R,-R)));
-		possibleQuadrants.insert( GetQuadrantCenter(c + Coordinate(-R,+R)));
-		possibleQuadrants.insert( GetQuadrantCenter(c + Coordinate(+R,-R)));
-		possibleQuadrants.insert( GetQuadrantCenter(c + Coordinate(+R,+R)));
-		R/=2;
-	} while(R>QUADRANTSIZE);
-	set<Coordinate>::iterator it;
-	for(it = possibleQuadrants.begin(); it != possibleQuadrants.end(); ++it) {
-		//here we're checking to see if this possible quadrant is one of the existing quadrants
-		// and if it is then we add its QuadTree to the vector we're returning
-		//how about we try creating the quadrant if it does not already exist
-		iter = trees.find(*it);
-		if(iter != trees.end() && iter->second->PossiblyNear(c,r)){
-			nearbyQuadrants.push_back(iter->second);
-		}
-	}
-	return nearbyQuadrants;
-}
-
-
 /**\brief Creates a binary comparison object that can be passed to stl sort.
  * Sprites will be sorted by distance from the point in ascending order.
  * \relates Sprite
@@ -490,27 +570,62 @@ struct compareSpriteDistFromPoint
 	Coordinate point;
 };
 
-/**\brief Returns a list of sprites that are near coordinate.
+/**\brief Visit every sprite that is near a coordinate.
+ * \details This is the cheapest way to look at nearby Sprites since nothing
+ *          is collected or sorted.  The Sprites are visited in no particular
+ *          order, and the visitor must not Add or Delete Sprites.
  * \param c Coordinate
  * \param r Radius
- * \return std::list of Sprite pointers.
+ * \param type A DRAW_ORDER mask of the Sprites to visit.
+ * \param visitor Receives each Sprite.
  */
-list<Sprite*> *SpriteManager::GetSpritesNear(Coordinate c, float r, int type) {
-	list<Sprite*> *sprites = new list<Sprite*>();
-	
-	// Search the possible quadrants
-	list<QuadTree*> nearbyQuadrants = GetQuadrantsNear(c,r);
-	list<QuadTree*>::iterator it;
-	for(it = nearbyQuadrants.begin(); it != nearbyQuadrants.end(); ++it) {
-			list<Sprite *>* nearby = new list<Sprite*>;
-			(*it)->GetSpritesNear(c,r,nearby,type);
-			sprites->splice(sprites->end(), *nearby);
-			delete nearby;
+void SpriteManager::ForEachSpriteNear(Coordinate c, float r, int type, SpriteVisitor& visitor) {
+	if( type & DRAW_ORDER_STATIC ) {
+		staticIndex->ForEachSpriteNear(c,r,type,visitor);
+	}
+	if( type & ~DRAW_ORDER_STATIC ) {
+		index->ForEachSpriteNear(c,r,type,visitor);
+	}
+}
+
+/**\brief Counts the sprites that are near coordinate.
+ * \param c Coordinate
+ * \param r Radius
+ * \param type A DRAW_ORDER mask of the Sprites to count.
+ */
+unsigned int SpriteManager::CountSpritesNear(Coordinate c, float r, int type) {
+	unsigned int count = 0;
+	if( type & DRAW_ORDER_STATIC ) {
+		count += staticIndex->CountSpritesNear(c,r,type);
 	}
+	if( type & ~DRAW_ORDER_STATIC ) {
+		count += index->CountSpritesNear(c,r,type);
+	}
+	return count;
+}
 
-	// Sort sprites by their distance from the coordinate c
-	sprites->sort(compareSpriteDistFromPoint(c));
-	return( sprites );
+/**\brief Collects the sprites that are near coordinate.
+ * \param c Coordinate
+ * \param r Radius
+ * \param nearby [out] Replaced with the Sprites that were found, in no
+ *        particular order.
+ * \param type A DRAW_ORDER mask of the Sprites to find.
+ * \see SortByDistance
+ */
+void SpriteManager::GetSpritesNear(Coordinate c, float r, vector<Sprite*> *nearby, int type) {
+	nearby->clear();
+	if( type & DRAW_ORDER_STATIC ) {
+		staticIndex->GetSpritesNear(c,r,nearby,type);
+	}
+	if( type & ~DRAW_ORDER_STATIC ) {
+		index->GetSpritesNear(c,r,nearby,type);
+	}
+}
+
+/**\brief Sort sprites by their distance from a coordinate, nearest first.
+ */
+void SpriteManager::SortByDistance(Coordinate c, vector<Sprite*> *sprites) {
+	sort( sprites->begin(), sprites->end(), compareSpriteDistFromPoint(c) );
 }
 
 /**\brief Get a Sprite nearest to another Sprite.
@@ -524,40 +639,52 @@ list<Sprite*> *SpriteManager::GetSpritesNear(Coordinate c, float r, int type) {
  	Sprite* found = GetNearestSprite(mySprite, 1000, DRAW_ORDER_SHIP);
 \endverbatim
  *
- *          Rather than re-implement this code for when the caller truely
- *          doesn't care about a Sprite, the caller can supply a dummy Sprite like:
-\verbatim
- 	Sprite* found = GetNearestSprite(Effect( Coordinate(0,0),"",0), 1000);
-\endverbatim
- *
- * \todo Build the Dummy example above into the SpriteManager.
- *
+ * \see GetNearestSprites
  */
 Sprite* SpriteManager::GetNearestSprite(Sprite* obj, float r, int type) {
-	float tmpdist;
-	Sprite* closest=NULL;
-	Sprite* possible=NULL;
 	if(obj==NULL)
 		return (Sprite*)NULL;
-	list<QuadTree*> nearbyQuadrants = GetQuadrantsNear(obj->GetWorldPosition(),r);
-	list<QuadTree*>::iterator it;
-	for(it = nearbyQuadrants.begin(); it != nearbyQuadrants.end(); ++it) {
-		possible = (*it)->GetNearestSprite(obj,r, type);
-		if(possible!=NULL) {
-			tmpdist = (obj->GetWorldPosition()-possible->GetWorldPosition()).GetMagnitude();
-			if(tmpdist<r) {
-				r = tmpdist;
-				closest = possible;
-			}
-		}
-	}
-	return closest;
+	NearestQuery query( obj->GetWorldPosition(), r, 1, type, obj );
+	FindNearest( query );
+	return query.GetFurthest();
 }
 
+/**\brief Get the Sprite nearest to a point.
+ * \see GetNearestSprites
+ */
 Sprite* SpriteManager::GetNearestSprite(Coordinate c, float r, int type) {
-	// This dummy variable is a local variable and will be deleted immediately after.
-	Effect dummy( c, "Resources/Animations/shield.ani", 0);
-	return GetNearestSprite( &dummy, r, type );
+	NearestQuery query( c, r, 1, type );
+	FindNearest( query );
+	return query.GetFurthest();
+}
+
+/**\brief Get the Sprites nearest to a point.
+ * \param c Coordinate
+ * \param r Radius
+ * \param count The maximum number of Sprites to return.
+ * \param nearest [out] Replaced with at most count Sprites, nearest first.
+ * \param type A DRAW_ORDER mask of the Sprites to find.
+ * \param exclude A Sprite to ignore, usually the one doing the search.
+ * \param predicate An extra condition that the Sprites must pass.
+ */
+void SpriteManager::GetNearestSprites(Coordinate c, float r, unsigned int count, vector<Sprite*> *nearest, int type, Sprite *exclude, SpritePredicate *predicate) {
+	NearestQuery query( c, r, count, type, exclude, predicate );
+	FindNearest( query );
+	nearest->clear();
+	query.TakeResults( nearest );
+}
+
+/**\brief Offer the Sprites of both indexes to a query.
+ * \details Static Sprites go first.  They are usually few and far apart, so
+ *          they cheaply tighten the bound before the busier index is searched.
+ */
+void SpriteManager::FindNearest( NearestQuery& query ) {
+	if( query.GetType() & DRAW_ORDER_STATIC ) {
+		staticIndex->GetNearestSprites( query );
+	}
+	if( query.GetType() & ~DRAW_ORDER_STATIC ) {
+		index->GetNearestSprites( query );
+	}
 }
 
 /**\brief Returns QuadTree center.
@@ -565,91 +692,40 @@ Sprite* SpriteManager::GetNearestSprite(Coordinate c, float r, int type) {
  * \return Coordinate of centerpointer
  */
 Coordinate SpriteManager::GetQuadrantCenter(Coordinate point){
-	// Figure out where the new Tree should go.
-	// Quadrants are tiled adjacent to the central Quadrant centered at (0,0).
-	double cx, cy;
-	cx = float(floor( (point.GetX()+QUADRANTSIZE)/(QUADRANTSIZE*2.0f)) * QUADRANTSIZE*2.f);
-	cy = float(floor( (point.GetY()+QUADRANTSIZE)/(QUADRANTSIZE*2.0f)) * QUADRANTSIZE*2.f);
-	return Coordinate(cx,cy);
+	return QuadrantIndex::GetQuadrantCenter(point);
 }
 
 /**\brief Gets the number of Sprites in the SpriteManager
  */
 int SpriteManager::GetNumSprites() {
-	unsigned int total = 0;
-	map<Coordinate,QuadTree*>::iterator iter;
-	for ( iter = trees.begin(); iter != trees.end(); ++iter ) { 
-		total += iter->second->Count();
-	}
+	unsigned int total = index->Count() + staticIndex->Count();
 	assert( total == spritelist->size() );
-	assert( total == spritelookup->size() );
 	return total;
 }
 
-/**\brief Returns QuadTree at Coordinate
- * \param point Coordinate
- */
-QuadTree* SpriteManager::GetQuadrant( Coordinate point ) {
-	Coordinate treeCenter = GetQuadrantCenter(point);
-
-	// Check in the known Quadrant
-	map<Coordinate,QuadTree*>::iterator iter;
-	iter = trees.find( treeCenter );
-	if( iter != trees.end() ) {
-		return iter->second;
-	}
-
-	// Create the new Tree and attach it to the universe
-	QuadTree *newTree = new QuadTree(treeCenter, QUADRANTSIZE);
-	assert(treeCenter == newTree->GetCenter() );
-	assert(newTree->Contains(point));
-	trees.insert(make_pair(treeCenter, newTree));
-	AdjustBoundaries();
-
-	// Debug
-	//cout<<"A Tree at "<<treeCenter<<" was created to contain "<<point<<". "<<trees.size()<<" Quadrants exist now."<<endl;
-
-	return newTree;
-}
-
 /**\brief Get the universe boundaries
  * \note Returns the values through the pointer arguments.
  */
 void SpriteManager::GetBoundaries(float *_northEdge, float *_southEdge, float *_eastEdge, float *_westEdge)
 {
-	*_northEdge = northEdge;
-	*_southEdge = southEdge;
-	*_eastEdge  = eastEdge;
-	*_westEdge  = westEdge;
-}
-
-/** Adjust the Edges based on the locations of the populated QuadTrees
- */
-void SpriteManager::AdjustBoundaries()
-{
-	Coordinate c;
-	map<Coordinate,QuadTree*>::iterator iter;
-
-	northEdge = southEdge = eastEdge = westEdge = 0;
-	for ( iter = trees.begin(); iter != trees.end(); ++iter ) { 
-		c = iter->first;
-		if( c.GetY() > northEdge) northEdge = c.GetY();
-		if( c.GetY() < southEdge) southEdge = c.GetY();
-		if( c.GetX() > eastEdge)  eastEdge  = c.GetX();
-		if( c.GetX() < westEdge)  westEdge  = c.GetX();
-	}
+	float north, south, east, west;
+	index->GetBoundaries(_northEdge, _southEdge, _eastEdge, _westEdge);
+	staticIndex->GetBoundaries(&north, &south, &east, &west);
+	if( north > *_northEdge ) *_northEdge = north;
+	if( south < *_southEdge ) *_southEdge = south;
+	if( east > *_eastEdge ) *_eastEdge = east;
+	if( west < *_westEdge ) *_westEdge = west;
 }
 
 /**\brief Save an XML file of all of the Sprites.
  * \details
- * Traverse each Quadtree looking for sprites.
+ * Traverse the SpatialIndex looking for sprites.
  * Each Sprite will be an XML node.
- * Each Quadtee Leaf or Node will be an XML Node.
+ * Each region of the index (Quadtee Leaf, Node or hash cell) will be an XML Node.
  *
- * The point of this is to create a file that could be useful for debugging quadtree problems.
+ * The point of this is to create a file that could be useful for debugging spatial index problems.
  */
 void SpriteManager::Save() {
-	map<Coordinate,QuadTree*>::iterator iter;
 	xmlDocPtr doc = NULL;       /* document pointer */
 	xmlNodePtr root_node = NULL;/* node pointers */
 
@@ -657,41 +733,12 @@ void SpriteManager::Save() {
 	root_node = xmlNewNode(NULL, BAD_CAST "Sprites" );
 	xmlDocSetRootElement(doc, root_node);
 
-	for ( iter = trees.begin(); iter != trees.end(); ++iter ) { 
-		xmlAddChild( root_node, iter->second->ToNode() );
-	}
+	xmlAddChild( root_node, index->ToNode() );
+	xmlAddChild( root_node, staticIndex->ToNode() );
 
 	xmlSaveFormatFileEnc( "Sprites.xml" , doc, "ISO-8859-1", 1);
 	xmlFreeDoc( doc );
 }
 
-/**\brief Count up to fullUpdatePeriod
- */
-void SpriteManager::UpdateTickCount ()
-{
-	tickCount ++;
-			//we could do a modulus here but I think this will average out more efficient
-	if (tickCount >= fullUpdatePeriod)
-		tickCount -= fullUpdatePeriod;
-}
-
-/**\brief Populate a list of all Quadtrees.
- * \details Used for looping between all Quadrants.
- * \warn
- * This is not very efficient, but std::transform doesn't work...
- * (if for some reason we got transform working, the idea would be to have
- *   a helper method to get map->second to pass as the 4th argument of transform
- *   with the third argument being a back_inserter into the list we want)
- */
-void SpriteManager::GetAllQuadrants (list<QuadTree*> *newList)
-{
-	map<Coordinate,QuadTree*>::iterator mapIter = trees.begin();
-	while (mapIter != trees.end())
-	{
-		newList->push_back (mapIter->second);
-		++ mapIter;
-	}
-}
-
 /** @} */
 
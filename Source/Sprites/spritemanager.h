@@ -8,8 +8,41 @@
 #ifndef __H_SPRITEMANAGER__
 #define __H_SPRITEMANAGER__
 
+#include "Sprites/drawlist.h"
+#include "Sprites/particlesystem.h"
+#include "Sprites/projectilesystem.h"
 #include "Sprites/sprite.h"
 #include "Utilities/quadtree.h"
+#include "Utilities/spatialindex.h"
+
+#define SPRITE_UPDATE_CHUNK 128 ///< The number of Sprites handed to a worker thread at a time during the native Update.
+
+class WorkerPool;
+
+/**\brief The parts of SpriteManager::Update that are timed separately.
+ * \details Each is also handed to the Profiler as the ProfilePhase of the
+ *          same name.
+ * \see SpriteManager::GetPhaseTime
+ */
+enum SpriteUpdatePhase {
+	UPDATE_PHASE_THINK,       ///< The Lua and AI Update of each Sprite.
+	UPDATE_PHASE_MOVE,        ///< Moving the Sprites and the native Update.
+	UPDATE_PHASE_PROJECTILES, ///< Flying the Projectiles and letting them hit.
+	UPDATE_PHASE_PARTICLES,   ///< Playing the hits and explosions.
+	UPDATE_PHASE_DELETE,      ///< Deleting the Sprites that were killed.
+	UPDATE_PHASE_REBALLANCE,  ///< Moving the Sprites between regions.
+	UPDATE_PHASES             ///< The number of phases.
+};
+
+/**\brief Where the SpriteManager looks up a Sprite by ID.
+ * \see SpriteManager::GetSpriteByID
+ */
+struct SpriteLookup {
+	SpriteLookup() :id(0), sprite(NULL) {}
+
+	int id;          ///< The full ID of the Sprite in this slot, or 0.
+	Sprite *sprite;  ///< The Sprite in this slot, or NULL.
+};
 
 class SpriteManager {
 	public:
@@ -19,22 +52,37 @@ class SpriteManager {
 		void Add( Sprite *sprite );
 		void AddPlayer( Sprite *sprite );
 		bool Delete( Sprite *sprite );
+		static void RadarSizeChanged( Sprite *sprite, int oldSize );
 		
-		void Update( lua_State *L, bool lowFps);
+		void Update( lua_State *L );
+		void SetInteresting( int id, bool flag );
 		void Draw( Coordinate focus );
 		void DrawQuadrantMap( Coordinate focus );
 
+		Sprite *GetPlayer() { return player; }
+		ProjectileSystem *GetProjectiles() { return &projectiles; }
+		ParticleSystem *GetParticles() { return &particles; }
 		Sprite *GetSpriteByID(int id);
 		list<Sprite*> *GetSprites(int type = DRAW_ORDER_ALL);
-		list<Sprite*> *GetSpritesNear(Coordinate c, float r, int type = DRAW_ORDER_ALL);
+		void ForEachSpriteNear(Coordinate c, float r, int type, SpriteVisitor& visitor);
+		unsigned int CountSpritesNear(Coordinate c, float r, int type = DRAW_ORDER_ALL);
+		void GetSpritesNear(Coordinate c, float r, vector<Sprite*> *nearby, int type = DRAW_ORDER_ALL);
+		static void SortByDistance(Coordinate c, vector<Sprite*> *sprites);
 		Sprite* GetNearestSprite(Sprite *obj, float r, int type = DRAW_ORDER_ALL);
 		Sprite* GetNearestSprite(Coordinate c, float r, int type = DRAW_ORDER_ALL);
+		void GetNearestSprites(Coordinate c, float r, unsigned int count, vector<Sprite*> *nearest, int type = DRAW_ORDER_ALL, Sprite *exclude = NULL, SpritePredicate *predicate = NULL);
 
 		Coordinate GetQuadrantCenter( Coordinate point );
-		int GetNumQuadrants() { return trees.size(); }
+		int GetNumQuadrants() { return index->GetNumRegions(); }
 		int GetNumSprites();
+		unsigned int GetNumDrawn() { return drawList.GetNumVisible(); }
+		unsigned int GetNumCulled() { return drawList.GetNumCulled(); }
 		void GetBoundaries(float *northEdge, float *southEdge, float *eastEdge, float *westEdge);
 
+		Uint64 GetPhaseTime( int phase );
+		static const char* GetPhaseName( int phase );
+		void ResetPhaseTimes();
+
 		void Save();
 		
 	protected:
@@ -42,34 +90,39 @@ class SpriteManager {
 	private:
 		// These structures each contain a complete list of all Sprites.
 		// Each one is useful for a different purpose, depending on the way that the sprites need to be accessed.
-		map<Coordinate,QuadTree*> trees;    ///< Collection of all Sprites.  Use the tree when referring to the sprites at a location.
-		list<Sprite*> *spritelist;          ///< Collection of all Sprites.  Use the list when referring to all sprites.
-		map<int,Sprite*> *spritelookup;     ///< Collection of all Sprites.  Use the map when referring to sprites by their unique ID.
+		SpatialIndex *index;                ///< Collection of all moving Sprites.  Use the indexes when referring to the sprites at a location.
+		SpatialIndex *staticIndex;          ///< Collection of all DRAW_ORDER_STATIC Sprites.
+		vector<Sprite*> *spritelist;        ///< Collection of all Sprites.  Use the list when referring to all sprites.
+		vector<SpriteLookup> *spritelookup; ///< Collection of all Sprites, by the slot of their ID.  Use the lookup when referring to sprites by their unique ID.
 
 		Sprite *player;                     ///< The Player Sprite.
 		
 		list<Sprite *> spritesToDelete;     ///< The list of Sprites that should be deleted at the end of this Update.
 		static SpriteManager *pInstance;    ///< The Static SpriteManager Instance.
 
-		int tickCount;                      ///< Counts number of ticks to track updates to quadrants.  Max value is the number of ticks to update all quadrants
-		const int semiRegularPeriod;        ///< The period at which every semi-regular quadrant is updated
-		const int fullUpdatePeriod;         ///< The period at which every quadrant is updated regardless of distance
+		SpatialUpdateFilter updateFilter;   ///< Chooses the regions that are Updated each tick.
+		Uint32 updateBudget;                ///< Microseconds per tick for Updating the regions beyond the nearest tier.
+		vector<int> interesting;            ///< IDs of Sprites that the universe is Updated around, like the player.
 
-		const int numRegularBands;          ///< The number of bands surrounding the centre point that are updated every tick
-		const int numSemiRegularBands;      ///< The number of bands surrounding the centre point that are updated semi-regularly
-		map<int, int> ticksToBandNum;       ///< The key is the tick# that the value band# will be updated at
+		WorkerPool *workers;                ///< Threads that run the native Update.
+		vector<Sprite*> updatedSprites;     ///< The Sprites Updated this tick.
+		vector<SpriteCommands> commands;    ///< The Adds and Deletes requested by each worker during the native Update.
 
-		float northEdge, southEdge, eastEdge, westEdge; ///< The Edges of the universe
+		ProjectileSystem projectiles;       ///< Every Projectile in flight.  These are not Sprites.
+		ParticleSystem particles;           ///< Every hit and explosion being played.  These are not Sprites either.
+		DrawList drawList;                  ///< The Sprites being drawn this frame.
+		Uint64 phaseTimes[UPDATE_PHASES];   ///< Microseconds spent in each SpriteUpdatePhase since the last ResetPhaseTimes.
+		int maxShipRadarSize;               ///< The largest radar size of any Ship, unless it is stale.
+		bool maxShipRadarStale;             ///< Whether the Ship with the largest radar size left or shrank since maxShipRadarSize was found.
 
+		SpatialIndex *GetIndexFor( Sprite *sprite );
+		void FindNearest( NearestQuery& query );
 		bool DeleteSprite( Sprite *sprite );
-		void DeleteEmptyQuadrants( void );
-		QuadTree* GetQuadrant( Coordinate point );
-		list<QuadTree*> GetQuadrantsNear( Coordinate c, float r);
-		list<QuadTree*> GetQuadrantsInBand ( Coordinate c, int bandIndex);
-		void AdjustBoundaries();
-		void UpdateTickCount();
-
-		void GetAllQuadrants( list<QuadTree*> *newTree);
+		void ApplyCommands();
+		void EndPhase( int phase, Uint64 *started );
+		double GetMaxShipTravel();
+		double GetMaxShipRadarSize();
+		void ShipRadarSizeChanged( Sprite *sprite, int oldSize, int newSize );
 };
 
 #endif // __H_SPRITEMANAGER__
@@ -0,0 +1,337 @@
+/**\file			statemachine.cpp
+ * \author			agent (agent@local)
+ * \date			Created: Sunday, October 18, 2026
+ * \date			Modified: Sunday, October 18, 2026
+ * \brief			Keeps the Lua AI state machines as references to their state functions.
+ * \details
+ */
+
+#include "includes.h"
+#include "Sprites/ai.h"
+#include "Sprites/statemachine.h"
+#include "Utilities/log.h"
+#include "Utilities/scriptprofiler.h"
+#include "Utilities/timer.h"
+
+#define BATCH_SHIP_FIELDS 7     ///< The values per ship handed to AIBatch: id, x, y, angle, speed, vector and state.
+#define BATCH_COMMAND_FIELDS 6  ///< The values per ship that AIBatch fills in: accelerate, rotate, fire, target, state and interval.
+
+/** \addtogroup Sprites
+ * @{
+ */
+
+map<string,StateMachine*> StateMachine::machines;
+vector<StateMachine*> StateMachine::pending;
+vector<AIDecision> StateMachine::decisions;
+int StateMachine::shipsRef = LUA_NOREF;
+int StateMachine::commandsRef = LUA_NOREF;
+
+StateMachine::StateMachine( const string& _name ) :
+	name( _name ),
+	namesRef( LUA_NOREF )
+{
+}
+
+/**\brief The state machine in the global Lua table with this name.
+ * \details The table is compiled the first time it is asked for.  The
+ *          StateMachine is never deleted, so AIs may keep the pointer.
+ * \return The StateMachine, or NULL if there is no such table.
+ */
+StateMachine* StateMachine::Get( lua_State *L, const string& name ) {
+	map<string,StateMachine*>::iterator found = machines.find( name );
+	if( found != machines.end() ) {
+		return found->second;
+	}
+
+	StateMachine *machine = new StateMachine( name );
+	if( !machine->Compile( L ) ) {
+		delete machine;
+		return NULL;
+	}
+	machines[name] = machine;
+	return machine;
+}
+
+/**\brief Compile every state machine again, after the scripts have changed.
+ * \details The states keep their numbers, so the AIs carry on in the state
+ *          they were in.  States that are gone leave the AIs in them to
+ *          fall back to the default state.
+ */
+void StateMachine::Reload( lua_State *L ) {
+	map<string,StateMachine*>::iterator iter;
+	for( iter = machines.begin(); iter != machines.end(); ++iter ) {
+		if( !iter->second->Compile( L ) ) {
+			LogMsg(WARN, "There is no longer a State Machine named '%s'. Keeping its old states.", iter->first.c_str() );
+		}
+	}
+	LogMsg(INFO, "Reloaded %d State Machines.", static_cast<int>( machines.size() ) );
+}
+
+/**\brief The number of a state.
+ * \return The number, or -1 if the machine has no such state.
+ */
+int StateMachine::GetState( const string& stateName ) {
+	map<string,int>::iterator found = numbers.find( stateName );
+	if( found == numbers.end() || stateRefs[found->second] == LUA_NOREF ) {
+		return -1;
+	}
+	return found->second;
+}
+
+/**\brief The number of the state named by a value on the Lua stack.
+ * \param index The absolute stack index of the name.
+ * \details A name that isn't known compiles the machine again once, in case
+ *          the state was added to the table after it was compiled.
+ * \return The number, or -1 if the machine has no such state.
+ */
+int StateMachine::GetStateAt( lua_State *L, int index ) {
+	for( int attempt = 0; attempt < 2; attempt++ ) {
+		lua_rawgeti( L, LUA_REGISTRYINDEX, namesRef );
+		lua_pushvalue( L, index );
+		lua_rawget( L, -2 );
+		if( lua_isnumber( L, -1 ) ) {
+			int state = lua_tointeger( L, -1 );
+			lua_pop( L, 2 );
+			return state;
+		}
+		lua_pop( L, 2 );
+
+		if( attempt == 0 && !Compile( L ) ) {
+			break;
+		}
+	}
+	return -1;
+}
+
+/**\brief Whether the machine still has a state.
+ * \details A state that was removed from the table keeps its number, but
+ *          is no longer usable.
+ */
+bool StateMachine::HasState( int state ) {
+	return ( state >= 0 && state < static_cast<int>( stateRefs.size() ) && stateRefs[state] != LUA_NOREF );
+}
+
+/**\brief Push the function of a state onto the Lua stack.
+ * \return false, with nothing pushed, if the machine has no such state.
+ */
+bool StateMachine::PushState( lua_State *L, int state ) {
+	if( !HasState( state ) ) {
+		return false;
+	}
+	lua_rawgeti( L, LUA_REGISTRYINDEX, stateRefs[state] );
+	return true;
+}
+
+/**\brief Take a reference to every state function in the Lua table.
+ * \details States seen before keep their numbers, and new states are
+ *          numbered after them.  The ThinkIntervals of the states are read
+ *          at the same time.
+ * \return false, leaving the old states alone, if there is no such table.
+ */
+bool StateMachine::Compile( lua_State *L ) {
+	const int initialStackTop = lua_gettop(L);
+
+	lua_getglobal( L, name.c_str() );
+	if( !lua_istable( L, -1 ) ) {
+		lua_settop( L, initialStackTop );
+		return false;
+	}
+	int machineIndex = lua_gettop(L);
+
+	// Forget the old functions, but not the numbers of their states
+	for( unsigned int s = 0; s < stateRefs.size(); s++ ) {
+		luaL_unref( L, LUA_REGISTRYINDEX, stateRefs[s] );
+		stateRefs[s] = LUA_NOREF;
+		intervals[s] = 0;
+		batched[s] = false;
+	}
+	luaL_unref( L, LUA_REGISTRYINDEX, namesRef );
+
+	lua_newtable( L );
+	int namesIndex = lua_gettop(L);
+	lua_getglobal( L, "ThinkIntervals" );
+	int intervalsIndex = lua_gettop(L);
+	lua_getfield( L, machineIndex, "Batch" );
+	int batchIndex = lua_gettop(L);
+
+	lua_pushnil( L );
+	while( lua_next( L, machineIndex ) != 0 ) {
+		// The name is at -2 and the function at -1
+		if( lua_type( L, -2 ) == LUA_TSTRING && lua_isfunction( L, -1 ) ) {
+			string stateName = lua_tostring( L, -2 );
+			int state;
+			map<string,int>::iterator found = numbers.find( stateName );
+			if( found == numbers.end() ) {
+				state = stateNames.size();
+				stateNames.push_back( stateName );
+				stateRefs.push_back( LUA_NOREF );
+				intervals.push_back( 0 );
+				batched.push_back( false );
+				numbers[stateName] = state;
+			} else {
+				state = found->second;
+			}
+
+			lua_pushvalue( L, -1 );
+			stateRefs[state] = luaL_ref( L, LUA_REGISTRYINDEX );
+
+			lua_pushvalue( L, -2 );
+			lua_pushinteger( L, state );
+			lua_rawset( L, namesIndex );
+
+			if( lua_istable( L, intervalsIndex ) ) {
+				lua_getfield( L, intervalsIndex, stateName.c_str() );
+				if( lua_isnumber( L, -1 ) && lua_tointeger( L, -1 ) >= 1 ) {
+					intervals[state] = lua_tointeger( L, -1 );
+				}
+				lua_pop( L, 1 );
+			}
+
+			if( lua_istable( L, batchIndex ) ) {
+				lua_getfield( L, batchIndex, stateName.c_str() );
+				batched[state] = lua_isfunction( L, -1 );
+				lua_pop( L, 1 );
+			}
+		}
+		lua_pop( L, 1 );
+	}
+
+	lua_pushvalue( L, namesIndex );
+	namesRef = luaL_ref( L, LUA_REGISTRYINDEX );
+
+	lua_settop( L, initialStackTop );
+	return true;
+}
+
+/**\brief Queue an AI to Decide in the next RunBatches.
+ * \param state The number of the AI's state, which must be batched.
+ */
+void StateMachine::Enqueue( AI *ai, int state ) {
+	if( queue.empty() ) {
+		pending.push_back( this );
+	}
+	queue.push_back( ai );
+	queuedStates.push_back( state );
+}
+
+/**\brief Decide every queued AI, with one Lua call for each machine.
+ * \details This runs once every AI has thought, and before any of them
+ *          move, so the batched AIs move on the same tick as the others.
+ *          The time taken is reported to AI::ChargeBatches.
+ */
+void StateMachine::RunBatches( lua_State *L ) {
+	if( pending.empty() ) {
+		return;
+	}
+	Uint64 started = Timer::GetMicroseconds();
+	unsigned int count = 0;
+	for( unsigned int m = 0; m < pending.size(); m++ ) {
+		count += pending[m]->queue.size();
+		pending[m]->RunBatch( L );
+	}
+	pending.clear();
+	AI::ChargeBatches( Timer::GetMicroseconds() - started, count );
+}
+
+/**\brief Hand the queued AIs to AIBatch and carry out what it decided.
+ * \details The arrays handed to AIBatch are kept in the Lua registry and
+ *          written over on every call, so a batch makes no Lua garbage.
+ *          If AIBatch fails, the AIs stay in their states and try again
+ *          after their state's interval.
+ */
+void StateMachine::RunBatch( lua_State *L ) {
+	const int initialStackTop = lua_gettop(L);
+	const unsigned int count = queue.size();
+
+	AIDecision stay = { false, 0.0f, 0, -1, -1, 0 };
+	decisions.assign( count, stay );
+
+	if( shipsRef == LUA_NOREF ) {
+		lua_newtable( L );
+		shipsRef = luaL_ref( L, LUA_REGISTRYINDEX );
+		lua_newtable( L );
+		commandsRef = luaL_ref( L, LUA_REGISTRYINDEX );
+	}
+
+	lua_getglobal( L, "AIBatch" );
+	if( !lua_isfunction( L, -1 ) ) {
+		LogMsg(ERR, "There is no AIBatch function to run the batched states of '%s'.", name.c_str() );
+	} else {
+		lua_getglobal( L, name.c_str() );
+
+		// Pack the kinematics of every queued AI into one array
+		lua_rawgeti( L, LUA_REGISTRYINDEX, shipsRef );
+		int shipsIndex = lua_gettop(L);
+		for( unsigned int a = 0; a < count; a++ ) {
+			AI *ai = queue[a];
+			Coordinate position = ai->GetWorldPosition();
+			Coordinate momentum = ai->GetMomentum();
+			const string& stateName = stateNames[ queuedStates[a] ];
+			int field = a * BATCH_SHIP_FIELDS;
+			lua_pushinteger( L, ai->GetID() );
+			lua_rawseti( L, shipsIndex, field + 1 );
+			lua_pushnumber( L, position.GetX() );
+			lua_rawseti( L, shipsIndex, field + 2 );
+			lua_pushnumber( L, position.GetY() );
+			lua_rawseti( L, shipsIndex, field + 3 );
+			lua_pushnumber( L, ai->GetAngle() );
+			lua_rawseti( L, shipsIndex, field + 4 );
+			lua_pushnumber( L, momentum.GetMagnitude() ); // Speed
+			lua_rawseti( L, shipsIndex, field + 5 );
+			lua_pushnumber( L, momentum.GetAngle() ); // Vector
+			lua_rawseti( L, shipsIndex, field + 6 );
+			lua_pushlstring( L, stateName.c_str(), stateName.size() );
+			lua_rawseti( L, shipsIndex, field + 7 );
+		}
+		lua_pushinteger( L, count );
+		lua_rawgeti( L, LUA_REGISTRYINDEX, commandsRef );
+
+		ScriptTimer timer( L );
+		int failed = lua_pcall( L, 4, 0, 0 );
+		timer.Stop( name, "AIBatch" );
+		if( failed != 0 ) {
+			LogMsg(ERR, "Failed to run the batched states of %s: %s", name.c_str(), lua_tostring(L, -1) );
+		} else {
+			lua_rawgeti( L, LUA_REGISTRYINDEX, commandsRef );
+			ReadDecisions( L, lua_gettop(L) );
+		}
+	}
+	lua_settop( L, initialStackTop );
+
+	for( unsigned int a = 0; a < count; a++ ) {
+		queue[a]->ApplyDecision( decisions[a] );
+	}
+	queue.clear();
+	queuedStates.clear();
+}
+
+/**\brief Read what AIBatch decided for each queued AI.
+ * \param commandsIndex The absolute stack index of the array of commands.
+ */
+void StateMachine::ReadDecisions( lua_State *L, int commandsIndex ) {
+	for( unsigned int a = 0; a < decisions.size(); a++ ) {
+		AIDecision& decision = decisions[a];
+		int field = a * BATCH_COMMAND_FIELDS;
+		for( int f = 1; f <= BATCH_COMMAND_FIELDS; f++ ) {
+			lua_rawgeti( L, commandsIndex, field + f );
+		}
+		int top = lua_gettop(L);
+
+		decision.accelerate = ( lua_toboolean( L, top - 5 ) != 0 );
+		decision.rotate = static_cast<float>( lua_tonumber( L, top - 4 ) );
+		decision.fire = lua_tointeger( L, top - 3 );
+		decision.target = lua_isnumber( L, top - 2 ) ? lua_tointeger( L, top - 2 ) : -1;
+		if( lua_isstring( L, top - 1 ) ) {
+			decision.state = GetStateAt( L, top - 1 );
+			if( decision.state < 0 ) {
+				LogMsg(ERR, "The State Machine '%s' has no state '%s'. Could not transition from '%s'. Resetting StateMachine.", name.c_str(), lua_tostring(L, top - 1), stateNames[ queuedStates[a] ].c_str() );
+				decision.state = GetState( "default" );
+			}
+		}
+		decision.interval = lua_tointeger( L, top );
+
+		lua_settop( L, top - BATCH_COMMAND_FIELDS );
+	}
+}
+
+/** @} */
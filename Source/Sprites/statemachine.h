@@ -0,0 +1,100 @@
+/**\file			statemachine.h
+ * \author			agent (agent@local)
+ * \date			Created: Sunday, October 18, 2026
+ * \date			Modified: Sunday, October 18, 2026
+ * \brief			Keeps the Lua AI state machines as references to their state functions.
+ * \details
+ */
+
+#ifndef __h_statemachine__
+#define __h_statemachine__
+
+#include "includes.h"
+#include "Utilities/lua.h"
+
+class AI;
+
+/**\brief Which weapons a batched state fires, as bits.
+ */
+enum AIFire {
+	AI_FIRE_PRIMARY = 1,    ///< Fire the primary group.
+	AI_FIRE_SECONDARY = 2   ///< Fire the secondary group.
+};
+
+/**\brief What a batched state decided for one AI.
+ * \see StateMachine::RunBatches
+ */
+struct AIDecision {
+	bool accelerate;  ///< Whether to Accelerate, after Rotating.
+	float rotate;     ///< Degrees to Rotate, like Ship::Rotate.
+	int fire;         ///< The AIFire bits of the weapons to fire.
+	int target;       ///< The ID of the Sprite to fire at, or -1.
+	int state;        ///< The number of the new state, or -1 to stay in the current one.
+	int interval;     ///< Ticks until the next Decide, or 0 to use the state's interval.
+};
+
+/**\class StateMachine
+ * \brief A Lua AI state machine, compiled into numbered states.
+ *
+ * \details
+ * A state machine is a global Lua table of state functions, like Hunter in
+ * ai.lua.  Rather than looking the table and the state up by name on every
+ * Decide, each state function is kept in the Lua registry and given a number.
+ * An AI then only holds its StateMachine and the number of its state.
+ *
+ * The names of the states are kept in a Lua table as well, so the name that a
+ * state function returns is turned back into a number without building any
+ * strings.
+ *
+ * A state keeps its number when the machine is compiled again, so Reload can
+ * pick up changes to the scripts while the AIs are using them.
+ *
+ * States that also have a version in the Batch table of the machine are
+ * batched: the AIs in them are queued as they become due, and RunBatches
+ * then Decides every queued AI of the machine with a single call to the Lua
+ * function AIBatch.  The kinematics go in and the AIDecisions come out as
+ * flat Lua arrays, so the states need not call back into the engine.
+ *
+ * \see AI::Decide
+ */
+class StateMachine {
+	public:
+		static StateMachine* Get( lua_State *L, const string& name );
+		static void Reload( lua_State *L );
+
+		int GetState( const string& stateName );
+		int GetStateAt( lua_State *L, int index );
+		bool HasState( int state );
+		bool PushState( lua_State *L, int state );
+		const string& GetName() { return name; }
+		const string& GetStateName( int state ) { return stateNames[state]; }
+		int GetInterval( int state ) { return intervals[state]; }
+
+		bool IsBatched( int state ) { return batched[state]; }
+		void Enqueue( AI *ai, int state );
+		static void RunBatches( lua_State *L );
+
+	private:
+		StateMachine( const string& _name );
+		bool Compile( lua_State *L );
+		void RunBatch( lua_State *L );
+		void ReadDecisions( lua_State *L, int commandsIndex );
+
+		string name;                ///< The name of the global Lua table.
+		vector<string> stateNames;  ///< The name of each state, by number.
+		vector<int> stateRefs;      ///< The registry reference to each state function, or LUA_NOREF if the state is gone.
+		vector<int> intervals;      ///< The ThinkIntervals entry of each state, or 0 if there is none.
+		vector<bool> batched;       ///< Whether each state has a version in the Batch table.
+		map<string,int> numbers;    ///< The number of each state, by name.
+		int namesRef;               ///< The registry reference to the Lua table of state numbers, by name.
+		vector<AI*> queue;          ///< The AIs waiting for RunBatches, in the order they became due.
+		vector<int> queuedStates;   ///< The state of each AI in the queue.
+
+		static map<string,StateMachine*> machines; ///< Every state machine that has been used, by name.
+		static vector<StateMachine*> pending;      ///< The machines with AIs in their queue.
+		static vector<AIDecision> decisions;       ///< The decisions of the current batch.
+		static int shipsRef;                       ///< The registry reference to the Lua array of kinematics handed to AIBatch.
+		static int commandsRef;                    ///< The registry reference to the Lua array of commands that AIBatch fills in.
+};
+
+#endif // __h_statemachine__
@@ -0,0 +1,149 @@
+/**\file		kinematics.cpp
+ * \author		agent (agent@local)
+ * \date		Created: Sunday, October 18, 2026
+ * \date		Modified: Sunday, October 18, 2026
+ * \brief		Benchmarks moving Sprites through the KinematicsTable.
+ * \details
+ * The same drifting bodies are moved two ways.  The reference keeps the
+ * position and momentum inside each heap object and moves them one virtual
+ * call at a time, the way Sprites used to.  The table moves real Sprites by
+ * marking them with StartMove and then Integrating them all at once.
+ *
+ * The timings are printed side by side, and the final positions of both are
+ * compared to make sure that they agree exactly.  An Integrate with nothing
+ * marked has to stay nearly free, however many rows the table has.
+ */
+
+#include "includes.h"
+#include "Sprites/sprite.h"
+#include "Utilities/timer.h"
+#include "Tests/testutil.h"
+
+#define KINEMATICS_UNIVERSE_SIZE  40000.0   ///< Bodies are scattered within this distance of the origin.
+#define KINEMATICS_MOVES          20000000  ///< The number of bodies moved in each run, split into ticks.
+#define KINEMATICS_IDLE_SHARE     0.1       ///< The most an Integrate with nothing to move may cost, relative to a tick that moves everything.
+
+/**\brief A Sprite that just drifts.*/
+class DriftingSprite : public Sprite {
+	public:
+		int GetDrawOrder( void ) { return DRAW_ORDER_SHIP; }
+		void Draw( void ) {}
+};
+
+/**\brief A body that moves itself, like a Sprite that keeps its own kinematics.*/
+class ReferenceBody {
+	public:
+		ReferenceBody( Coordinate _position, Coordinate _momentum ) :position( _position ), momentum( _momentum ) {}
+		virtual ~ReferenceBody() {}
+
+		virtual void Move( Uint32 frames ) {
+			previousPosition = position;
+			position += (momentum * frames);
+			acceleration = lastMomentum - momentum;
+			lastMomentum = momentum;
+		}
+
+		Coordinate GetPosition() const { return position; }
+		Coordinate GetAcceleration() const { return acceleration; }
+
+	private:
+		Coordinate position;
+		Coordinate previousPosition;
+		Coordinate momentum;
+		Coordinate acceleration;
+		Coordinate lastMomentum;
+};
+
+/**\brief Move the same bodies both ways and compare the timings.
+ * \returns false if the table and the reference disagree.
+ */
+static bool benchmark_kinematics( int numBodies, double *referenceMS, double *tableMS, double *integrateMS ) {
+	int ticks = KINEMATICS_MOVES / numBodies;
+	vector<ReferenceBody*> bodies;
+	vector<Sprite*> sprites;
+	clock_t start;
+
+	srand( numBodies );
+	for( int b = 0; b < numBodies; b++ ) {
+		Coordinate position( RandomOffset(KINEMATICS_UNIVERSE_SIZE), RandomOffset(KINEMATICS_UNIVERSE_SIZE) );
+		Coordinate momentum( RandomOffset(8.0), RandomOffset(8.0) );
+		bodies.push_back( new ReferenceBody( position, momentum ) );
+		Sprite *sprite = new DriftingSprite();
+		sprite->SetWorldPosition( position );
+		sprite->SetMomentum( momentum );
+		sprites.push_back( sprite );
+	}
+
+	start = clock();
+	for( int tick = 0; tick < ticks; tick++ ) {
+		for( int b = 0; b < numBodies; b++ ) {
+			bodies[b]->Move( 1 );
+		}
+	}
+	*referenceMS = ElapsedMS( start ) / ticks;
+
+	start = clock();
+	for( int tick = 0; tick < ticks; tick++ ) {
+		Timer::IncrementFrameCount();
+		Uint32 frame = Timer::GetLogicalFrameCount();
+		for( int s = 0; s < numBodies; s++ ) {
+			sprites[s]->StartMove( frame );
+		}
+		Sprite::Integrate();
+	}
+	*tableMS = ElapsedMS( start ) / ticks;
+
+	bool agree = true;
+	for( int b = 0; b < numBodies; b++ ) {
+		Coordinate expected = bodies[b]->GetPosition();
+		Coordinate found = sprites[b]->GetWorldPosition();
+		if( expected.GetX() != found.GetX() || expected.GetY() != found.GetY() ) {
+			agree = false;
+		}
+		expected = bodies[b]->GetAcceleration();
+		found = sprites[b]->GetAcceleration();
+		if( expected.GetX() != found.GetX() || expected.GetY() != found.GetY() ) {
+			agree = false;
+		}
+	}
+
+	// Nothing was started, so this is just the cost of the pass itself.
+	start = clock();
+	for( int tick = 0; tick < ticks; tick++ ) {
+		Sprite::Integrate();
+	}
+	*integrateMS = ElapsedMS( start ) / ticks;
+
+	for( int b = 0; b < numBodies; b++ ) {
+		delete bodies[b];
+		delete sprites[b];
+	}
+
+	return agree;
+}
+
+/**\brief Compare moving Sprites through the KinematicsTable with moving them one by one.*/
+int test_kinematics(int argc, char **argv){
+	const int sizes[] = { 1000, 10000, 100000 };
+	const int numSizes = sizeof(sizes) / sizeof(sizes[0]);
+
+	cout<<"Sprites  Objects(ms/tick)  Table(ms/tick)  Integrate(ms/tick)  Speedup"<<endl;
+	for( int n = 0; n < numSizes; n++ ) {
+		double referenceMS, tableMS, integrateMS;
+		bool agree = benchmark_kinematics( sizes[n], &referenceMS, &tableMS, &integrateMS );
+
+		cout<<setw(7)<<sizes[n]<<"  "<<fixed<<setprecision(4)
+			<<setw(16)<<referenceMS<<"  "<<setw(14)<<tableMS<<"  "<<setw(18)<<integrateMS<<"  "
+			<<setprecision(2)<<setw(6)<<( tableMS > 0. ? referenceMS / tableMS : 0. )<<"x"<<endl;
+
+		if( !agree ) {
+			return TestFailed( "The KinematicsTable moved the Sprites differently than the reference." );
+		}
+		if( integrateMS > KINEMATICS_IDLE_SHARE * tableMS ) {
+			stringstream why;
+			why<<"Integrating with nothing to move took "<<integrateMS<<" ms, but moving everything took "<<tableMS<<" ms.";
+			return TestFailed( why.str() );
+		}
+	}
+	return TestPassed( "The KinematicsTable moves the Sprites exactly like the reference." );
+}
@@ -0,0 +1,11 @@
+/**\file		kinematics.h
+ * \author		agent (agent@local)
+ * \date		Created: Sunday, October 18, 2026
+ * \date		Modified: Sunday, October 18, 2026
+ * \brief		Benchmarks moving Sprites through the KinematicsTable.
+ */
+
+#ifndef __H_TEST_KINEMATICS__
+#define __H_TEST_KINEMATICS__
+int test_kinematics(int argc, char **argv);
+#endif//__H_TEST_KINEMATICS__
@@ -0,0 +1,116 @@
+/**\file		projectiles.cpp
+ * \author		agent (agent@local)
+ * \date		Created: Sunday, October 18, 2026
+ * \date		Modified: Sunday, October 18, 2026
+ * \brief		Checks that the spatial indexes offer every Ship a Projectile hits.
+ * \details
+ * Fast Projectiles are fired past small Ships that are placed to be struck
+ * somewhere along the path, often near its ends, while the Ships drift for
+ * several skipped frames.  Each hit found by testing the Ship directly must
+ * also be found when the Ships are looked up the way ProjectileSystem::Collide
+ * does it, through each SpatialIndex.
+ */
+
+#include "includes.h"
+#include "Sprites/projectilesystem.h"
+#include "Sprites/sprite.h"
+#include "Utilities/quadrantindex.h"
+#include "Utilities/spatialhash.h"
+#include "Utilities/timer.h"
+#include "Tests/testutil.h"
+
+#define PROJECTILE_UNIVERSE_SIZE  40000.0  ///< Projectiles are fired within this distance of the origin.
+#define PROJECTILE_PATH           2000.0   ///< How far each Projectile flies in one tick.
+#define PROJECTILE_SHIP_SPEED     30.0     ///< The fastest a Ship drifts per frame.
+#define PROJECTILE_SKIPPED_FRAMES 8        ///< The most frames a Ship moves by at once.
+#define PROJECTILE_TRIALS         2000     ///< The number of shots taken at each index.
+
+/**\brief A small Ship.  Its radar size stays at the default of 1.*/
+class TargetSprite : public Sprite {
+	public:
+		int GetDrawOrder( void ) { return DRAW_ORDER_SHIP; }
+		void Draw( void ) {}
+};
+
+/**\brief Fire Projectiles past Ships in one index.
+ * \param hits [out] The number of shots that hit when tested directly.
+ * \param missedBefore [out] How many of those hits a query that is not
+ *        widened by the radar size would have missed.
+ * \returns The number of hits that the index did not offer.
+ */
+static int check_index( SpatialIndex *index, int *hits, int *missedBefore ) {
+	*hits = 0;
+	*missedBefore = 0;
+	int missed = 0;
+	srand( 17 );
+	for( int trial = 0; trial < PROJECTILE_TRIALS; trial++ ) {
+		Coordinate start( RandomOffset( PROJECTILE_UNIVERSE_SIZE ), RandomOffset( PROJECTILE_UNIVERSE_SIZE ) );
+		double heading = RandomOffset( M_PI );
+		Coordinate path( cos( heading ) * PROJECTILE_PATH, sin( heading ) * PROJECTILE_PATH );
+		Coordinate end = start + path;
+
+		// Put the Ship where the Projectile will be at some moment, give or take its radar size
+		TargetSprite *ship = new TargetSprite();
+		int frames = 1 + rand() % PROJECTILE_SKIPPED_FRAMES;
+		Coordinate momentum( RandomOffset( PROJECTILE_SHIP_SPEED ), RandomOffset( PROJECTILE_SHIP_SPEED ) );
+		Coordinate travel = momentum * frames;
+		double t = ( trial % 2 == 0 ) ? 0.5 + RandomOffset( 0.5 ) : ( trial % 4 == 1 ? 1.0 : 0.0 );
+		Coordinate offset( RandomOffset( ship->GetRadarSize() ), RandomOffset( ship->GetRadarSize() ) );
+		ship->SetWorldPosition( start + (path - travel) * t + offset );
+		ship->SetMomentum( momentum );
+		for( int f = 0; f < frames; f++ ) {
+			Timer::IncrementFrameCount();
+		}
+		ship->StartMove( Timer::GetLogicalFrameCount() );
+		Sprite::Integrate();
+		index->Insert( ship );
+
+		ProjectileHitTest direct( start, end, -1 );
+		direct.Visit( ship );
+		if( direct.hit != NULL ) {
+			(*hits)++;
+
+			double shipTravel = travel.GetMagnitude();
+			Coordinate middle = (start + end) * 0.5;
+			double reach = ProjectileSystem::GetCollisionReach( start, end, shipTravel, ship->GetRadarSize() );
+			ProjectileHitTest indexed( start, end, -1 );
+			index->ForEachSpriteNear( middle, static_cast<float>( reach ), DRAW_ORDER_SHIP | DRAW_ORDER_PLAYER, indexed );
+			if( indexed.hit != ship ) {
+				missed++;
+			}
+
+			ProjectileHitTest narrow( start, end, -1 );
+			index->ForEachSpriteNear( middle, static_cast<float>( reach - ship->GetRadarSize() ), DRAW_ORDER_SHIP | DRAW_ORDER_PLAYER, narrow );
+			if( narrow.hit != ship ) {
+				(*missedBefore)++;
+			}
+		}
+
+		index->Delete( ship );
+		delete ship;
+	}
+	index->ReBallance();
+	return missed;
+}
+
+/**\brief Check the Projectile broadphase against the QuadrantIndex and the SpatialHash.*/
+int test_projectiles(int argc, char **argv){
+	QuadrantIndex quadrants;
+	SpatialHash hash;
+	SpatialIndex *indexes[] = { &quadrants, &hash };
+	const char *names[] = { "quadtree", "hash" };
+
+	cout<<"Index     Hits  Missed  Missed without radar size"<<endl;
+	for( int i = 0; i < 2; i++ ) {
+		int hits, missedBefore;
+		int missed = check_index( indexes[i], &hits, &missedBefore );
+		cout<<setw(8)<<left<<names[i]<<right<<"  "<<setw(4)<<hits<<"  "<<setw(6)<<missed<<"  "<<setw(25)<<missedBefore<<endl;
+		if( hits == 0 ) {
+			return TestFailed( "No shot hit, so nothing was checked." );
+		}
+		if( missed != 0 ) {
+			return TestFailed( "The index did not offer a Ship that a Projectile hit." );
+		}
+	}
+	return TestPassed( "Every Ship that a Projectile hit was offered by the indexes." );
+}
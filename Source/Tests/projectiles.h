@@ -0,0 +1,11 @@
+/**\file		projectiles.h
+ * \author		agent (agent@local)
+ * \date		Created: Sunday, October 18, 2026
+ * \date		Modified: Sunday, October 18, 2026
+ * \brief		Checks that the spatial indexes offer every Ship a Projectile hits.
+ */
+
+#ifndef __H_TEST_PROJECTILES__
+#define __H_TEST_PROJECTILES__
+int test_projectiles(int argc, char **argv);
+#endif//__H_TEST_PROJECTILES__
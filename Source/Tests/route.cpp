@@ -0,0 +1,123 @@
+/**\file		route.cpp
+ * \author		agent (agent@local)
+ * \date		Created: Sunday, October 18, 2026
+ * \date		Modified: Sunday, October 18, 2026
+ * \brief		Checks the routes planned by the RoutePlanner.
+ * \details
+ * Randomly scattered Gate pairs are searched with the A* of the RoutePlanner,
+ * and with a plain Dijkstra search that looks at every Gate.  The timings
+ * are printed side by side, and the lengths of the routes are compared to
+ * make sure that A* finds the shortest.
+ */
+
+#include "includes.h"
+#include "Engine/routeplanner.h"
+#include "Tests/testutil.h"
+
+#define ROUTE_UNIVERSE_SIZE  40000.0   ///< Gates are scattered within this distance of the origin.
+#define ROUTE_QUERIES        500       ///< The number of routes planned for each universe.
+#define ROUTE_TOLERANCE      0.01f     ///< How far, relative to its length, a route may be off from the shortest.
+
+/**\brief A random point in the universe.*/
+static Coordinate RandomPoint() {
+	return Coordinate( RandomOffset( ROUTE_UNIVERSE_SIZE ), RandomOffset( ROUTE_UNIVERSE_SIZE ) );
+}
+
+/**\brief The length of the shortest route, found by visiting every Gate.*/
+static float shortest_route( const vector<RouteGate>& gates, Coordinate from, Coordinate to ) {
+	const int numGates = gates.size();
+	vector<float> cost( numGates, 0.0f ); // Arriving at each Gate exit
+	vector<bool> done( numGates, false );
+	for( int g = 0; g < numGates; g++ ) {
+		Coordinate position = gates[g].position;
+		cost[g] = (position - from).GetMagnitude();
+	}
+	float best = (to - from).GetMagnitude();
+	for( int visited = 0; visited < numGates; visited++ ) {
+		int nearest = -1;
+		for( int g = 0; g < numGates; g++ ) {
+			if( !done[g] && ( nearest < 0 || cost[g] < cost[nearest] ) ) {
+				nearest = g;
+			}
+		}
+		done[nearest] = true;
+		Coordinate exit = gates[nearest].exit;
+		best = min( best, cost[nearest] + (to - exit).GetMagnitude() );
+		for( int g = 0; g < numGates; g++ ) {
+			Coordinate position = gates[g].position;
+			cost[g] = min( cost[g], cost[nearest] + (position - exit).GetMagnitude() );
+		}
+	}
+	return best;
+}
+
+/**\brief The length of a route through the Gates.*/
+static float route_length( const vector<RouteGate>& gates, Coordinate from, Coordinate to, const vector<int>& through ) {
+	float length = 0.0f;
+	Coordinate here = from;
+	for( unsigned int g = 0; g < through.size(); g++ ) {
+		Coordinate position = gates[ through[g] ].position;
+		length += (position - here).GetMagnitude();
+		here = gates[ through[g] ].exit;
+	}
+	return length + (to - here).GetMagnitude();
+}
+
+int test_route(int argc, char **argv){
+	const int sizes[] = { 10, 100, 1000 };
+	const int numSizes = sizeof(sizes) / sizeof(sizes[0]);
+
+	srand( 42 );
+	cout<<"Gates  A*(us/route)  Dijkstra(us/route)"<<endl;
+	for( int n = 0; n < numSizes; n++ ) {
+		// Each Gate leads to its partner, like the pairs made by Epiar.NewGatePair
+		vector<RouteGate> gates;
+		for( int g = 0; g < sizes[n]; g += 2 ) {
+			RouteGate one, two;
+			one.position = two.exit = RandomPoint();
+			two.position = one.exit = RandomPoint();
+			gates.push_back( one );
+			gates.push_back( two );
+		}
+		RoutePlanner::MeasureGates( &gates );
+
+		vector<Coordinate> from, to;
+		for( int q = 0; q < ROUTE_QUERIES; q++ ) {
+			from.push_back( RandomPoint() );
+			to.push_back( RandomPoint() );
+		}
+
+		vector<float> found( ROUTE_QUERIES );
+		vector<float> lengths( ROUTE_QUERIES );
+		clock_t start = clock();
+		for( int q = 0; q < ROUTE_QUERIES; q++ ) {
+			vector<int> through;
+			found[q] = RoutePlanner::FindRoute( gates, from[q], to[q], &through );
+			lengths[q] = route_length( gates, from[q], to[q], through );
+		}
+		double aStarUS = 1000.0 * ElapsedMS( start ) / ROUTE_QUERIES;
+
+		vector<float> shortest( ROUTE_QUERIES );
+		start = clock();
+		for( int q = 0; q < ROUTE_QUERIES; q++ ) {
+			shortest[q] = shortest_route( gates, from[q], to[q] );
+		}
+		double dijkstraUS = 1000.0 * ElapsedMS( start ) / ROUTE_QUERIES;
+
+		cout<<setw(5)<<sizes[n]<<"  "<<fixed<<setprecision(2)<<setw(12)<<aStarUS<<"  "<<setw(18)<<dijkstraUS<<endl;
+
+		for( int q = 0; q < ROUTE_QUERIES; q++ ) {
+			if( fabs( found[q] - lengths[q] ) > ROUTE_TOLERANCE * lengths[q] ) {
+				stringstream why;
+				why<<"A* said a route was "<<found[q]<<" long, but it is "<<lengths[q]<<" long.";
+				return TestFailed( why.str() );
+			}
+			if( lengths[q] > shortest[q] * (1.0f + ROUTE_TOLERANCE) ) {
+				stringstream why;
+				why<<"A* found a route "<<lengths[q]<<" long, but there is one "<<shortest[q]<<" long.";
+				return TestFailed( why.str() );
+			}
+		}
+	}
+	return TestPassed( "A* found the shortest routes." );
+}
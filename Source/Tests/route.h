@@ -0,0 +1,11 @@
+/**\file		route.h
+ * \author		agent (agent@local)
+ * \date		Created: Sunday, October 18, 2026
+ * \date		Modified: Sunday, October 18, 2026
+ * \brief		Checks the routes planned by the RoutePlanner.
+ */
+
+#ifndef __H_TEST_ROUTE__
+#define __H_TEST_ROUTE__
+int test_route(int argc, char **argv);
+#endif//__H_TEST_ROUTE__
@@ -0,0 +1,227 @@
+/**\file		spatial.cpp
+ * \author		agent (agent@local)
+ * \date		Created: Sunday, October 18, 2026
+ * \date		Modified: Sunday, October 18, 2026
+ * \brief		Benchmarks the spatial indexes used by the SpriteManager.
+ * \details
+ * Every index is loaded with the same randomly scattered Sprites, flown
+ * around for a number of ticks, and then queried.  The timings for each
+ * index are printed side by side, and the query results of the indexes are
+ * compared to make sure that they agree.
+ *
+ * The StaticIndex is meant for Sprites that never move.  It is run through
+ * the same paces to check its answers, but since it has to be rebuilt after
+ * every tick its Update time is not representative.
+ */
+
+#include "includes.h"
+#include "Sprites/sprite.h"
+#include "Utilities/quadrantindex.h"
+#include "Utilities/spatialhash.h"
+#include "Utilities/staticindex.h"
+#include "Utilities/timer.h"
+#include "Tests/testutil.h"
+
+#define SPATIAL_UNIVERSE_SIZE  40000.0   ///< Sprites are scattered within this distance of the origin.
+#define SPATIAL_TICKS          100       ///< The number of Updates to run.
+#define SPATIAL_QUERIES        2000      ///< The number of each kind of query to run.
+#define SPATIAL_QUERY_RADIUS   1000.0f   ///< Radius of the queries (the AI's combat range).
+#define SPATIAL_NEAREST_COUNT  8         ///< The number of Sprites found by each k nearest query.
+#define SPATIAL_CHECKED        50        ///< The number of k nearest queries double checked by brute force.
+
+/**\brief A Sprite that just drifts.*/
+class BenchmarkSprite : public Sprite {
+	public:
+		BenchmarkSprite( int _type, int _number ) :type( _type ), number( _number ) {}
+		int GetDrawOrder( void ) { return type; }
+		void Draw( void ) {}
+		/// Sprite IDs depend on what was created before, so the results are compared by this instead.
+		int GetNumber( void ) { return number; }
+	private:
+		int type;
+		int number;
+};
+
+/**\brief Only accept Sprites with even IDs.*/
+class EvenIDPredicate : public SpritePredicate {
+	public:
+		bool Accept( Sprite *sprite ) { return sprite->GetID() % 2 == 0; }
+};
+
+/**\brief Results of running one index.*/
+struct SpatialResult {
+	double insertMS;
+	double updateMS;
+	double nearUS;
+	double nearestUS;
+	double kNearestUS;
+	unsigned long nearFound;
+	unsigned long nearestFound;
+	unsigned long kNearestFound;
+	bool kNearestCorrect;
+};
+
+/**\brief Check a k nearest query against every Sprite.*/
+static bool check_nearest( const vector<Sprite*>& sprites, Sprite *center, EvenIDPredicate *even, vector<Sprite*> *found ) {
+	vector< pair<double,int> > expected;
+	for( size_t s = 0; s < sprites.size(); s++ ) {
+		if( sprites[s] == center || sprites[s]->GetDrawOrder() != DRAW_ORDER_SHIP || !even->Accept( sprites[s] ) ) continue;
+		Coordinate offset = center->GetWorldPosition() - sprites[s]->GetWorldPosition();
+		double distance = offset.GetX()*offset.GetX() + offset.GetY()*offset.GetY();
+		if( distance < SPATIAL_QUERY_RADIUS*SPATIAL_QUERY_RADIUS ) {
+			expected.push_back( make_pair( distance, sprites[s]->GetID() ) );
+		}
+	}
+	sort( expected.begin(), expected.end() );
+	if( expected.size() > SPATIAL_NEAREST_COUNT ) {
+		expected.resize( SPATIAL_NEAREST_COUNT );
+	}
+
+	if( expected.size() != found->size() ) return false;
+	vector<Sprite*>::iterator f = found->begin();
+	for( size_t e = 0; e < expected.size(); e++, ++f ) {
+		if( (*f)->GetID() != expected[e].second ) return false;
+	}
+	return true;
+}
+
+/**\brief Time one index with a given number of Sprites.*/
+static SpatialResult benchmark_index( SpatialIndex *index, int numSprites ) {
+	SpatialResult result;
+	vector<Sprite*> sprites;
+	clock_t start;
+
+	// Every index gets exactly the same Sprites
+	srand( numSprites );
+	for( int s = 0; s < numSprites; s++ ) {
+		// One in ten is a stationary Planet, the rest are moving Ships.
+		Sprite* sprite = new BenchmarkSprite( (s%10 == 0) ? DRAW_ORDER_PLANET : DRAW_ORDER_SHIP, s );
+		sprite->SetWorldPosition( Coordinate( RandomOffset(SPATIAL_UNIVERSE_SIZE), RandomOffset(SPATIAL_UNIVERSE_SIZE) ) );
+		if( s%10 != 0 ) {
+			sprite->SetMomentum( Coordinate( RandomOffset(8.0), RandomOffset(8.0) ) );
+		}
+		sprites.push_back( sprite );
+	}
+
+	start = clock();
+	for( int s = 0; s < numSprites; s++ ) {
+		index->Insert( sprites[s] );
+	}
+	result.insertMS = ElapsedMS( start );
+
+	SpatialUpdateFilter everything;
+	vector<Sprite*> updated;
+	SpriteCommands commands;
+	start = clock();
+	for( int tick = 0; tick < SPATIAL_TICKS; tick++ ) {
+		Timer::IncrementFrameCount();
+		updated.clear();
+		index->Update( NULL, everything, &updated );
+		for( size_t s = 0; s < updated.size(); s++ ) {
+			updated[s]->StartMove( Timer::GetLogicalFrameCount() );
+		}
+		Sprite::Integrate();
+		for( size_t s = 0; s < updated.size(); s++ ) {
+			updated[s]->UpdateNative( &commands );
+			updated[s]->SyncSpatialHandle();
+		}
+		index->ReBallance();
+	}
+	result.updateMS = ElapsedMS( start ) / SPATIAL_TICKS;
+
+	vector<Sprite*> nearby;
+	result.nearFound = 0;
+	start = clock();
+	for( int q = 0; q < SPATIAL_QUERIES; q++ ) {
+		nearby.clear();
+		index->GetSpritesNear( sprites[ (q*7919) % numSprites ]->GetWorldPosition(), SPATIAL_QUERY_RADIUS, &nearby, DRAW_ORDER_SHIP );
+		result.nearFound += nearby.size();
+	}
+	result.nearUS = 1000.0 * ElapsedMS( start ) / SPATIAL_QUERIES;
+
+	result.nearestFound = 0;
+	start = clock();
+	for( int q = 0; q < SPATIAL_QUERIES; q++ ) {
+		Sprite* nearest = index->GetNearestSprite( sprites[ (q*104729) % numSprites ], SPATIAL_QUERY_RADIUS, DRAW_ORDER_SHIP );
+		if( nearest != NULL ) {
+			result.nearestFound += ((BenchmarkSprite*)nearest)->GetNumber() + 1;
+		}
+	}
+	result.nearestUS = 1000.0 * ElapsedMS( start ) / SPATIAL_QUERIES;
+
+	EvenIDPredicate even;
+	result.kNearestFound = 0;
+	result.kNearestCorrect = true;
+	start = clock();
+	for( int q = 0; q < SPATIAL_QUERIES; q++ ) {
+		Sprite* center = sprites[ (q*7727) % numSprites ];
+		NearestQuery query( center->GetWorldPosition(), SPATIAL_QUERY_RADIUS, SPATIAL_NEAREST_COUNT, DRAW_ORDER_SHIP, center, &even );
+		index->GetNearestSprites( query );
+		nearby.clear();
+		query.TakeResults( &nearby );
+
+		unsigned long rank = 1;
+		vector<Sprite*>::iterator i;
+		for( i = nearby.begin(); i != nearby.end(); ++i, ++rank ) {
+			result.kNearestFound += rank * ( ((BenchmarkSprite*)(*i))->GetNumber() + 1 );
+		}
+		if( q < SPATIAL_CHECKED ) {
+			// Pause the clock while checking the answer the slow way
+			clock_t paused = clock();
+			result.kNearestCorrect &= check_nearest( sprites, center, &even, &nearby );
+			start += clock() - paused;
+		}
+	}
+	result.kNearestUS = 1000.0 * ElapsedMS( start ) / SPATIAL_QUERIES;
+
+	// Empty the index again
+	for( int s = 0; s < numSprites; s++ ) {
+		index->Delete( sprites[s] );
+		delete sprites[s];
+	}
+	index->ReBallance();
+
+	return result;
+}
+
+/**\brief Compare the QuadrantIndex, SpatialHash and StaticIndex at several sizes.*/
+int test_spatial(int argc, char **argv){
+	const int sizes[] = { 1000, 10000, 50000 };
+	const int numSizes = sizeof(sizes) / sizeof(sizes[0]);
+
+	cout<<"Sprites  Index     Insert(ms)  Update(ms/tick)  Near(us/query)  Nearest(us/query)  "<<SPATIAL_NEAREST_COUNT<<"-Nearest(us/query)"<<endl;
+	for( int n = 0; n < numSizes; n++ ) {
+		QuadrantIndex quadrants;
+		SpatialHash hash;
+		StaticIndex kdtree;
+		SpatialResult q = benchmark_index( &quadrants, sizes[n] );
+		SpatialResult h = benchmark_index( &hash, sizes[n] );
+		SpatialResult k = benchmark_index( &kdtree, sizes[n] );
+
+		cout<<setw(7)<<sizes[n]<<"  quadtree "<<fixed<<setprecision(2)
+			<<setw(10)<<q.insertMS<<"  "<<setw(15)<<q.updateMS<<"  "<<setw(14)<<q.nearUS<<"  "<<setw(17)<<q.nearestUS<<"  "<<setw(19)<<q.kNearestUS<<endl;
+		cout<<setw(7)<<sizes[n]<<"  hash     "
+			<<setw(10)<<h.insertMS<<"  "<<setw(15)<<h.updateMS<<"  "<<setw(14)<<h.nearUS<<"  "<<setw(17)<<h.nearestUS<<"  "<<setw(19)<<h.kNearestUS<<endl;
+		cout<<setw(7)<<sizes[n]<<"  kdtree   "
+			<<setw(10)<<k.insertMS<<"  "<<setw(15)<<k.updateMS<<"  "<<setw(14)<<k.nearUS<<"  "<<setw(17)<<k.nearestUS<<"  "<<setw(19)<<k.kNearestUS<<endl;
+
+		if( quadrants.Count() != 0 || hash.Count() != 0 || kdtree.Count() != 0 ) {
+			return TestFailed( "Sprites were left behind in an index." );
+		}
+		if( q.nearFound != h.nearFound || q.nearFound != k.nearFound ) {
+			stringstream why;
+			why<<"GetSpritesNear found "<<q.nearFound<<" Sprites in the QuadTree, "<<h.nearFound<<" in the hash and "<<k.nearFound<<" in the KD-tree.";
+			return TestFailed( why.str() );
+		}
+		if( q.nearestFound != h.nearestFound || q.nearestFound != k.nearestFound ) {
+			return TestFailed( "GetNearestSprite disagrees between the indexes." );
+		}
+		if( !q.kNearestCorrect || !h.kNearestCorrect || !k.kNearestCorrect ) {
+			return TestFailed( "GetNearestSprites did not find the nearest Sprites." );
+		}
+		if( q.kNearestFound != h.kNearestFound || q.kNearestFound != k.kNearestFound ) {
+			return TestFailed( "GetNearestSprites disagrees between the indexes." );
+		}
+	}
+	return TestPassed( "The QuadTree, the hash and the KD-tree agree." );
+}
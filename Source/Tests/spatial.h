@@ -0,0 +1,11 @@
+/**\file		spatial.h
+ * \author		agent (agent@local)
+ * \date		Created: Sunday, October 18, 2026
+ * \date		Modified: Sunday, October 18, 2026
+ * \brief		Benchmarks the spatial indexes used by the SpriteManager.
+ */
+
+#ifndef __H_TEST_SPATIAL__
+#define __H_TEST_SPATIAL__
+int test_spatial(int argc, char **argv);
+#endif//__H_TEST_SPATIAL__
@@ -15,6 +15,10 @@
 #include "Tests/argparser.h"
 #include "Tests/ui.h"
 #include "Tests/font.h"
+#include "Tests/spatial.h"
+#include "Tests/kinematics.h"
+#include "Tests/projectiles.h"
+#include "Tests/route.h"
 // Header files for various subsystems
 #include "Audio/audio.h"
 #include "Graphics/font.h"
@@ -46,6 +50,10 @@ Test::Test( const string& testname ):testname( testname ){
 		REQUIRE_VIDEO|REQUIRE_AUDIO|REQUIRE_OPTIONS|REQUIRE_FONTS);
 	tests["font"]=make_pair(test_font,
 		REQUIRE_VIDEO|REQUIRE_OPTIONS|REQUIRE_FONTS);
+	tests["spatial"]=make_pair(test_spatial,0);
+	tests["kinematics"]=make_pair(test_kinematics,0);
+	tests["projectiles"]=make_pair(test_projectiles,0);
+	tests["route"]=make_pair(test_route,0);
 
 }
 
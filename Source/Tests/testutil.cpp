@@ -0,0 +1,38 @@
+/**\file		testutil.cpp
+ * \author		agent (agent@local)
+ * \date		Created: Sunday, October 18, 2026
+ * \date		Modified: Sunday, October 18, 2026
+ * \brief		Helpers shared by the benchmarking tests.
+ * \details
+ * The benchmarks time each contender with the processor clock, scatter their
+ * data with the same random offsets, and report the outcome the same way.
+ */
+
+#include "includes.h"
+#include "Tests/testutil.h"
+
+/**\brief Milliseconds of processor time since an earlier clock().*/
+double ElapsedMS( clock_t start ) {
+	return 1000.0 * double( clock() - start ) / double( CLOCKS_PER_SEC );
+}
+
+/**\brief A random number between -range and +range.*/
+double RandomOffset( double range ) {
+	return range * ( 2.0 * double( rand() ) / double( RAND_MAX ) - 1.0 );
+}
+
+/**\brief Report why a test failed.
+ * \returns The exit code of a failed test.
+ */
+int TestFailed( const string& why ) {
+	cout<<"Failed: "<<why<<endl;
+	return -1;
+}
+
+/**\brief Report what a test showed.
+ * \returns The exit code of a passed test.
+ */
+int TestPassed( const string& what ) {
+	cout<<"Success: "<<what<<endl;
+	return 0;
+}
@@ -0,0 +1,20 @@
+/**\file		testutil.h
+ * \author		agent (agent@local)
+ * \date		Created: Sunday, October 18, 2026
+ * \date		Modified: Sunday, October 18, 2026
+ * \brief		Helpers shared by the benchmarking tests.
+ */
+
+#ifndef __H_TEST_UTIL__
+#define __H_TEST_UTIL__
+
+#include "includes.h"
+#include <sstream>
+
+double ElapsedMS( clock_t start );
+double RandomOffset( double range );
+
+int TestFailed( const string& why );
+int TestPassed( const string& what );
+
+#endif//__H_TEST_UTIL__
@@ -0,0 +1,135 @@
+/**\file			pool.h
+ * \author			agent (agent@local)
+ * \date			Created: Sunday, October 18, 2026
+ * \date			Modified: Sunday, October 18, 2026
+ * \brief			Fixed size free-list allocator.
+ * \details
+ */
+
+#ifndef __h_pool__
+#define __h_pool__
+
+#include "includes.h"
+#include <new>
+
+/**\class Pool
+ * \brief A free-list of fixed size slots for objects of type T.
+ *
+ * \details
+ * Memory is requested from the heap in blocks of several slots at a time.
+ * Released slots are threaded onto a free-list and handed back out by the
+ * next Allocate, so once a Pool has grown to the size of the working set it
+ * never touches the heap again.  Blocks are only returned to the heap when
+ * the Pool itself is destroyed.
+ *
+ * The Pool only deals in raw memory.  Callers construct into the slot with
+ * placement new and must call the destructor before releasing it:
+\verbatim
+	Foo* foo = new (pool.Allocate()) Foo( bar );
+	...
+	foo->~Foo();
+	pool.Release( foo );
+\endverbatim
+ */
+
+template<class T>
+class Pool {
+	public:
+		Pool( unsigned int _blockSize = 64 );
+		~Pool();
+
+		void* Allocate();
+		void Release( void* ptr );
+
+		unsigned int GetInUse() const { return inUse; }         ///< Slots currently handed out.
+		unsigned int GetHighWater() const { return highWater; } ///< The most slots ever handed out at once.
+		unsigned int GetCapacity() const { return static_cast<unsigned int>(blocks.size()) * blockSize; } ///< Slots owned by this Pool.
+
+	private:
+		Pool( const Pool& );            // Not copyable
+		Pool& operator=( const Pool& ); // Not copyable
+
+		void Grow();
+
+		/// A single slot.  The extra members force the alignment of the storage.
+		union Slot {
+			Slot* next;
+			char storage[sizeof(T)];
+			double alignDouble;
+			long alignLong;
+			void* alignPointer;
+		};
+
+		vector<Slot*> blocks;   ///< Every block of slots that has been allocated.
+		Slot* freeList;         ///< Slots that are ready to be handed out.
+		unsigned int blockSize; ///< Number of slots allocated at a time.
+		unsigned int inUse;
+		unsigned int highWater;
+};
+
+/**\brief Create an empty Pool.
+ * \param _blockSize The number of slots to allocate each time the Pool runs dry.
+ */
+template<class T>
+Pool<T>::Pool( unsigned int _blockSize )
+	:freeList( NULL )
+	,blockSize( _blockSize>0 ? _blockSize : 1 )
+	,inUse( 0 )
+	,highWater( 0 )
+{
+}
+
+/**\brief Return every block to the heap.
+ * \warning Objects still living in the Pool are not destroyed.
+ */
+template<class T>
+Pool<T>::~Pool() {
+	typename vector<Slot*>::iterator i;
+	for( i = blocks.begin(); i != blocks.end(); ++i ) {
+		delete [] (*i);
+	}
+	blocks.clear();
+}
+
+/**\brief Get uninitialized memory for one T.
+ */
+template<class T>
+void* Pool<T>::Allocate() {
+	if( freeList == NULL ) {
+		Grow();
+	}
+	Slot* slot = freeList;
+	freeList = slot->next;
+	inUse++;
+	if( inUse > highWater ) {
+		highWater = inUse;
+	}
+	return static_cast<void*>( slot );
+}
+
+/**\brief Give a slot back to the Pool.
+ * \param ptr Memory previously returned by Allocate.  NULL is ignored.
+ */
+template<class T>
+void Pool<T>::Release( void* ptr ) {
+	if( ptr == NULL ) return;
+	assert( inUse > 0 );
+	Slot* slot = static_cast<Slot*>( ptr );
+	slot->next = freeList;
+	freeList = slot;
+	inUse--;
+}
+
+/**\brief Allocate another block of slots and thread it onto the free-list.
+ */
+template<class T>
+void Pool<T>::Grow() {
+	Slot* block = new Slot[blockSize];
+	blocks.push_back( block );
+	for( unsigned int s = 0; s < blockSize; s++ ) {
+		block[s].next = freeList;
+		freeList = &block[s];
+	}
+}
+
+#endif // __h_pool__
@@ -0,0 +1,134 @@
+/**\file			profiler.cpp
+ * \author			agent (agent@local)
+ * \date			Created: Sunday, October 18, 2026
+ * \date			Modified: Sunday, October 18, 2026
+ * \brief			Times the phases of each frame over the last few frames.
+ * \details
+ */
+
+#include "includes.h"
+#include "Utilities/log.h"
+#include "Utilities/options.h"
+#include "Utilities/profiler.h"
+
+/** \addtogroup Utilities
+ * @{
+ */
+
+bool Profiler::enabled = false;
+vector<Uint32> Profiler::samples;
+vector<Uint32> Profiler::sorted;
+unsigned int Profiler::current = 0;
+unsigned int Profiler::numFrames = 0;
+
+/**\brief Start or stop timing the phases.
+ * \details Starting forgets every frame timed before, since there is a gap
+ *          in the frames.  The number of frames remembered comes from
+ *          "options/development/profiler-frames".
+ */
+void Profiler::Enable( bool enable ) {
+	if( enable && !enabled ) {
+		unsigned int size = OPTION( Uint32, "options/development/profiler-frames" );
+		if( size < 2 ) {
+			size = 2;
+		}
+		samples.assign( size * PROFILE_PHASES, 0 );
+		current = size - 1; // The first frame goes in the first slot
+		numFrames = 0;
+		LogMsg(INFO, "Profiling the last %u frames.", size );
+	}
+	enabled = enable;
+}
+
+/**\brief Start timing a new frame, forgetting the oldest one.
+ */
+void Profiler::StartFrame() {
+	if( !enabled ) {
+		return;
+	}
+	unsigned int size = samples.size() / PROFILE_PHASES;
+	current = (current + 1) % size;
+	for( int phase = 0; phase < PROFILE_PHASES; phase++ ) {
+		samples[ current * PROFILE_PHASES + phase ] = 0;
+	}
+	if( numFrames < size ) {
+		numFrames++;
+	}
+}
+
+/**\brief Add some time to a phase of the current frame.
+ * \param phase A ProfilePhase.
+ * \param microseconds How long the phase took this time.
+ */
+void Profiler::Add( int phase, Uint64 microseconds ) {
+	if( !enabled || numFrames == 0 || phase < 0 || phase >= PROFILE_PHASES ) {
+		return;
+	}
+	samples[ current * PROFILE_PHASES + phase ] += static_cast<Uint32>( microseconds );
+}
+
+/**\brief Summarize one phase over the frames in the buffer.
+ * \param phase A ProfilePhase.
+ * \param min The fastest frame, in microseconds.
+ * \param avg The average frame, in microseconds.
+ * \param p99 The 99th percentile: only one frame in a hundred was slower.
+ * \details The current frame is left out since it is still being timed.
+ *          Everything is 0 until a frame has finished.
+ */
+void Profiler::GetStats( int phase, Uint32 *min, float *avg, Uint32 *p99 ) {
+	*min = 0;
+	*avg = 0.0f;
+	*p99 = 0;
+	if( phase < 0 || phase >= PROFILE_PHASES || numFrames < 2 ) {
+		return;
+	}
+
+	unsigned int size = samples.size() / PROFILE_PHASES;
+	sorted.clear();
+	Uint64 total = 0;
+	for( unsigned int f = 0; f < size; f++ ) {
+		// The slots after the current one are empty until the buffer wraps
+		if( f == current || ( numFrames < size && f > current ) ) {
+			continue;
+		}
+		Uint32 sample = samples[ f * PROFILE_PHASES + phase ];
+		sorted.push_back( sample );
+		total += sample;
+	}
+
+	unsigned int n = sorted.size();
+	unsigned int rank = (n * 99 + 99) / 100 - 1; // ceil( 0.99 * n ) - 1
+	nth_element( sorted.begin(), sorted.begin() + rank, sorted.end() );
+	*p99 = sorted[rank];
+	*min = *min_element( sorted.begin(), sorted.end() );
+	*avg = static_cast<float>( total ) / n;
+}
+
+/**\brief One line describing a phase, for the console and the overlay.
+ */
+string Profiler::Describe( int phase ) {
+	Uint32 min, p99;
+	float avg;
+	GetStats( phase, &min, &avg, &p99 );
+	char line[80];
+	snprintf( line, sizeof(line), "%-11s min %6u  avg %8.1f  p99 %6u us",
+		GetPhaseName( phase ), min, avg, p99 );
+	return line;
+}
+
+/**\brief The name of a phase, for printing.
+ * \param phase A ProfilePhase.
+ */
+const char* Profiler::GetPhaseName( int phase ) {
+	static const char* names[PROFILE_PHASES] = {
+		"Frame", "Input", "Update", "Think", "Move", "Projectiles",
+		"Particles", "Delete", "ReBallance",
+		"Starfield", "Sprites", "Hud", "UI", "Video"
+	};
+	if( phase < 0 || phase >= PROFILE_PHASES ) {
+		return "Unknown";
+	}
+	return names[phase];
+}
+
+/** @} */
@@ -0,0 +1,95 @@
+/**\file			profiler.h
+ * \author			agent (agent@local)
+ * \date			Created: Sunday, October 18, 2026
+ * \date			Modified: Sunday, October 18, 2026
+ * \brief			Times the phases of each frame over the last few frames.
+ * \details
+ */
+
+#ifndef __h_profiler__
+#define __h_profiler__
+
+#include "includes.h"
+#include "Utilities/timer.h"
+
+/**\brief The parts of a frame that the Profiler times.
+ * \details Think through ReBallance are the parts of Update, in the order of
+ *          SpriteUpdatePhase, and are fed from SpriteManager::Update.
+ */
+enum ProfilePhase {
+	PROFILE_FRAME,      ///< The whole frame.
+	PROFILE_INPUT,      ///< Handling the keyboard and mouse.
+	PROFILE_UPDATE,     ///< Every logical Update of the Sprites and the calendar.
+	PROFILE_THINK,      ///< The Lua and AI Update of the Sprites.
+	PROFILE_MOVE,       ///< Moving the Sprites and their native Update on the worker threads.
+	PROFILE_PROJECTILES,///< Flying the Projectiles and letting them hit.
+	PROFILE_PARTICLES,  ///< Playing the hits and explosions.
+	PROFILE_DELETE,     ///< Deleting the Sprites that were killed.
+	PROFILE_REBALLANCE, ///< Moving the Sprites between regions.
+	PROFILE_STARFIELD,  ///< Drawing the Starfield.
+	PROFILE_SPRITES,    ///< Drawing the Sprites.
+	PROFILE_HUD,        ///< Drawing the Hud.
+	PROFILE_UI,         ///< Drawing the UI and the console.
+	PROFILE_VIDEO,      ///< Swapping the buffers and waiting for the video card.
+	PROFILE_PHASES      ///< The number of phases.
+};
+
+/**\class Profiler
+ * \brief Remembers how long each phase of the last few frames took.
+ *
+ * \details
+ * Each frame gets one slot of a ring buffer, so the oldest frame is forgotten
+ * once the buffer is full.  The time of a phase is added to the current frame,
+ * so a phase that runs several times in one frame adds up.
+ *
+ * While the Profiler is disabled, nothing is timed or stored and a
+ * ProfileTimer costs one comparison.
+ *
+ * \see ProfileTimer
+ */
+class Profiler {
+	public:
+		static void Enable( bool enable );
+		static bool IsEnabled() { return enabled; }
+
+		static void StartFrame();
+		static void Add( int phase, Uint64 microseconds );
+
+		static unsigned int GetNumFrames() { return numFrames; }
+		static void GetStats( int phase, Uint32 *min, float *avg, Uint32 *p99 );
+		static string Describe( int phase );
+		static const char* GetPhaseName( int phase );
+
+	private:
+		static bool enabled;            ///< Whether the phases are being timed.
+		static vector<Uint32> samples;  ///< Microseconds of each phase of each frame, one frame after another.
+		static vector<Uint32> sorted;   ///< Frame times, for finding the slowest frames.
+		static unsigned int current;    ///< The frame being timed.
+		static unsigned int numFrames;  ///< The frames in the buffer, up to its size.
+};
+
+/**\brief Times a phase until it goes out of scope.
+ * \details
+ * \code
+ * {
+ *     ProfileTimer timer( PROFILE_HUD );
+ *     Hud::Draw( ... );
+ * }
+ * \endcode
+ */
+class ProfileTimer {
+	public:
+		ProfileTimer( int _phase ) :phase( _phase ), timing( Profiler::IsEnabled() ), started( 0 ) {
+			if( timing ) started = Timer::GetMicroseconds();
+		}
+		~ProfileTimer() {
+			if( timing ) Profiler::Add( phase, Timer::GetMicroseconds() - started );
+		}
+
+	private:
+		int phase;       ///< The ProfilePhase being timed.
+		bool timing;     ///< Whether the Profiler was enabled when the timer started.
+		Uint64 started;  ///< When the timer started, in microseconds.
+};
+
+#endif // __h_profiler__
@@ -0,0 +1,327 @@
+/**\file			quadrantindex.cpp
+ * \author			agent (agent@local)
+ * \date			Created: Sunday, October 18, 2026
+ * \date			Modified: Sunday, October 18, 2026
+ * \brief			SpatialIndex built from a grid of QuadTrees.
+ * \details
+ */
+
+#include "includes.h"
+#include "Utilities/log.h"
+#include "Utilities/quadrantindex.h"
+
+/**\class QuadrantIndex
+ * \brief A SpatialIndex that tiles the universe with QuadTrees.
+ *
+ * \details
+ * - The entire universe is broken up into a grid of QuadTrees.
+ *   Only grid positions with Sprites in them are actually populated by QuadTrees.
+ * - Each QuadTree is only a finite size, but can theoretically hold an infinte
+ *   number of sprites.
+ * - The QuadTree segments the Sprites based on how relativly close the Sprites are.
+ *
+ * \see QuadTree
+ */
+
+/**\brief Create an empty universe.
+ */
+QuadrantIndex::QuadrantIndex()
+	:numSprites( 0 )
+{
+}
+
+/**\brief Release every Quadrant.
+ * \note The Sprites themselves are not deleted.
+ */
+QuadrantIndex::~QuadrantIndex() {
+	map<Coordinate,QuadTree*>::iterator iter;
+	for ( iter = trees.begin(); iter != trees.end(); ++iter ) {
+		treePool.DeleteTree( iter->second );
+	}
+	trees.clear();
+	columns.clear();
+	rows.clear();
+}
+
+/**\brief Add a Sprite to the Quadrant at its position.
+ */
+void QuadrantIndex::Insert( Sprite *sprite ) {
+	GetQuadrant( sprite->GetWorldPosition() )->Insert( sprite );
+	numSprites++;
+}
+
+/**\brief Remove a Sprite from the Quadrant that holds it.
+ * \details The Sprite may have moved since it was last Updated, so its
+ *          SpatialHandle is used to find the Quadrant rather than its position.
+ */
+bool QuadrantIndex::Delete( Sprite *sprite ) {
+	QuadTree* leaf = sprite->GetSpatialHandle().leaf;
+	if( leaf == NULL ) {
+		return false;
+	}
+	QuadTree* root = leaf->GetRoot();
+	if( !root->Delete( sprite ) ) {
+		return false;
+	}
+	numSprites--;
+	CheckIfEmpty( root );
+	return true;
+}
+
+/**\brief Update the sprites inside each quadrant that is due
+ * \param L The Lua State that the Sprites should Update with.
+ * \param filter Selects the Quadrants to update.
+ * \param updated [out] Each Sprite that was Updated is appended.
+ */
+void QuadrantIndex::Update( lua_State *L, const SpatialUpdateFilter& filter, vector<Sprite*> *updated ) {
+	// Sprites may create Quadrants while they Update, so work from a copy.
+	// New Quadrants are not Updated until the next tick.
+	allQuadrants.clear();
+	GetAllQuadrants( &allQuadrants );
+	updateQuadrants.clear();
+
+	vector<QuadTree*>::iterator iter;
+	for ( iter = allQuadrants.begin(); iter != allQuadrants.end(); ++iter ) {
+		if( !filter.IsDue( (*iter)->GetCenter(), (*iter)->GetLastUpdate() ) ) {
+			continue;
+		}
+		(*iter)->SetLastUpdate( filter.GetTick() );
+		(*iter)->Update( L, updated );
+		updateQuadrants.push_back( *iter );
+	}
+}
+
+/**\brief Move the Sprites that left the updated Quadrants, balance those
+ *         Quadrants and delete the empty ones.
+ */
+void QuadrantIndex::ReBallance() {
+	// Find and Fix any Sprites that have moved out of bounds.
+	outOfBounds.clear();
+	vector<QuadTree*>::iterator iter;
+	for ( iter = updateQuadrants.begin(); iter != updateQuadrants.end(); ++iter ) {
+		(*iter)->FixOutOfBounds( &outOfBounds );
+		CheckIfEmpty( *iter );
+	}
+
+	// Move sprites to adjacent Quadrants as they cross boundaries
+	vector<Sprite *>::iterator oob;
+	for( oob = outOfBounds.begin(); oob != outOfBounds.end(); ++oob ) {
+		GetQuadrant( (*oob)->GetWorldPosition() )->Insert( *oob );
+	}
+
+	for ( iter = updateQuadrants.begin(); iter != updateQuadrants.end(); ++iter ) {
+		(*iter)->ReBallance();
+	}
+	updateQuadrants.clear();
+
+	DeleteEmptyQuadrants();
+}
+
+/**\brief Remember a Quadrant that may have been emptied (Internal use)
+ * \details The Quadrant is not deleted yet, since it may be in the middle of
+ *          an Update, or get a new Sprite before the next ReBallance.
+ */
+void QuadrantIndex::CheckIfEmpty( QuadTree *tree ) {
+	if( tree->Count() == 0 ) {
+		emptyQuadrants.push_back( tree->GetCenter() );
+	}
+}
+
+/**\brief Deletes empty QuadTrees (Internal use)
+ * \details Only the Quadrants that were emptied since the last ReBallance are
+ *          looked at.  A Quadrant may have been queued more than once, or
+ *          filled again since it was queued, so each one is looked up again.
+ */
+void QuadrantIndex::DeleteEmptyQuadrants() {
+	map<Coordinate,QuadTree*>::iterator iter;
+	vector<Coordinate>::iterator center;
+	for( center = emptyQuadrants.begin(); center != emptyQuadrants.end(); ++center ) {
+		iter = trees.find( *center );
+		if( iter == trees.end() || iter->second->Count() != 0 ) {
+			continue;
+		}
+		//cout<<"Deleting the empty tree at "<<(*center)<<endl;
+		columns.erase( columns.find( center->GetX() ) );
+		rows.erase( rows.find( center->GetY() ) );
+		treePool.DeleteTree( iter->second );
+		trees.erase( iter );
+	}
+	emptyQuadrants.clear();
+}
+
+/**\brief Draws the Quadrant containing a point.
+ */
+void QuadrantIndex::Draw( Coordinate focus ) {
+	GetQuadrant( focus )->Draw( GetQuadrantCenter( focus ) );
+}
+
+/**\brief Find the range of Quadrant positions within a square around a point.
+ * \param c Coordinate
+ * \param r Half the width of the square
+ * \param lowest [out] The center of the south west Quadrant in range.
+ * \param highest [out] The center of the north east Quadrant in range.
+ * \return True when looking up each position in range is cheaper than walking every populated Quadrant.
+ */
+bool QuadrantIndex::GetQuadrantRange( Coordinate c, float r, Coordinate *lowest, Coordinate *highest ) {
+	*lowest = GetQuadrantCenter( c - Coordinate(r,r) );
+	*highest = GetQuadrantCenter( c + Coordinate(r,r) );
+	double quadrantWidth = QUADRANTSIZE * 2.0;
+	double across = (highest->GetX() - lowest->GetX()) / quadrantWidth + 1;
+	double down = (highest->GetY() - lowest->GetY()) / quadrantWidth + 1;
+	return across * down < trees.size();
+}
+
+/**\brief Visit the sprites that are near coordinate.
+ * \param c Coordinate
+ * \param r Radius
+ * \param type A DRAW_ORDER mask of the Sprites to find.
+ * \param visitor Receives each Sprite that was found, in no particular order.
+ */
+void QuadrantIndex::ForEachSpriteNear(Coordinate c, float r, int type, SpriteVisitor& visitor) {
+	map<Coordinate,QuadTree*>::iterator iter;
+	Coordinate lowest, highest;
+	double quadrantWidth = QUADRANTSIZE * 2.0;
+
+	if( GetQuadrantRange( c, r, &lowest, &highest ) ) {
+		// Look up each Quadrant position in range
+		for( double x = lowest.GetX(); x <= highest.GetX(); x += quadrantWidth ) {
+			for( double y = lowest.GetY(); y <= highest.GetY(); y += quadrantWidth ) {
+				iter = trees.find( Coordinate(x,y) );
+				if( iter != trees.end() ) {
+					iter->second->ForEachSpriteNear(c,r,type,visitor);
+				}
+			}
+		}
+	} else {
+		// Huge queries are cheaper to answer by walking the populated Quadrants.
+		for ( iter = trees.begin(); iter != trees.end(); ++iter ) {
+			iter->second->ForEachSpriteNear(c,r,type,visitor);
+		}
+	}
+}
+
+/**\brief Find the Sprites nearest to a point.
+ * \details Every Quadrant that is close enough is queued, and then they are
+ *          searched together so that the closest branches of every Quadrant
+ *          are searched first.
+ * \see QuadTree::GetNearestSprites
+ */
+void QuadrantIndex::GetNearestSprites( NearestQuery& query ) {
+	Coordinate point = query.GetPoint();
+	map<Coordinate,QuadTree*>::iterator iter;
+	Coordinate lowest, highest;
+	double quadrantWidth = QUADRANTSIZE * 2.0;
+	searchQueue.clear();
+
+	if( GetQuadrantRange( point, query.GetRadius(), &lowest, &highest ) ) {
+		// Look up each Quadrant position in range
+		for( double x = lowest.GetX(); x <= highest.GetX(); x += quadrantWidth ) {
+			for( double y = lowest.GetY(); y <= highest.GetY(); y += quadrantWidth ) {
+				iter = trees.find( Coordinate(x,y) );
+				if( iter == trees.end() ) continue;
+				double distance = iter->second->DistanceSquaredTo( point );
+				if( distance <= query.GetBound() ) {
+					searchQueue.push_back( QuadSearchEntry( distance, iter->second ) );
+				}
+			}
+		}
+	} else {
+		// Huge queries are cheaper to answer by walking the populated Quadrants.
+		for ( iter = trees.begin(); iter != trees.end(); ++iter ) {
+			double distance = iter->second->DistanceSquaredTo( point );
+			if( distance <= query.GetBound() ) {
+				searchQueue.push_back( QuadSearchEntry( distance, iter->second ) );
+			}
+		}
+	}
+	make_heap( searchQueue.begin(), searchQueue.end(), greater<QuadSearchEntry>() );
+	QuadTree::GetNearestSprites( &searchQueue, query );
+}
+
+/**\brief Returns QuadTree center.
+ * \param point Coordinate
+ * \return Coordinate of centerpointer
+ */
+Coordinate QuadrantIndex::GetQuadrantCenter(Coordinate point){
+	// Figure out where the new Tree should go.
+	// Quadrants are tiled adjacent to the central Quadrant centered at (0,0).
+	double cx, cy;
+	cx = float(floor( (point.GetX()+QUADRANTSIZE)/(QUADRANTSIZE*2.0f)) * QUADRANTSIZE*2.f);
+	cy = float(floor( (point.GetY()+QUADRANTSIZE)/(QUADRANTSIZE*2.0f)) * QUADRANTSIZE*2.f);
+	return Coordinate(cx,cy);
+}
+
+/**\brief Returns QuadTree at Coordinate
+ * \param point Coordinate
+ */
+QuadTree* QuadrantIndex::GetQuadrant( Coordinate point ) {
+	Coordinate treeCenter = GetQuadrantCenter(point);
+
+	// Check in the known Quadrant
+	map<Coordinate,QuadTree*>::iterator iter;
+	iter = trees.find( treeCenter );
+	if( iter != trees.end() ) {
+		return iter->second;
+	}
+
+	// Create the new Tree and attach it to the universe
+	QuadTree *newTree = treePool.NewTree(treeCenter, QUADRANTSIZE);
+	assert(treeCenter == newTree->GetCenter() );
+	assert(newTree->Contains(point));
+	trees.insert(make_pair(treeCenter, newTree));
+	columns.insert( treeCenter.GetX() );
+	rows.insert( treeCenter.GetY() );
+	// Quadrants created just to look at a position may never get any Sprites
+	emptyQuadrants.push_back( treeCenter );
+
+	// Debug
+	//cout<<"A Tree at "<<treeCenter<<" was created to contain "<<point<<". "<<trees.size()<<" Quadrants exist now."<<endl;
+
+	return newTree;
+}
+
+/**\brief Get the universe boundaries
+ * \details The edges are the furthest populated Quadrant centers in each
+ *          direction, and always include the origin.
+ * \note Returns the values through the pointer arguments.
+ */
+void QuadrantIndex::GetBoundaries(float *_northEdge, float *_southEdge, float *_eastEdge, float *_westEdge)
+{
+	*_northEdge = *_southEdge = *_eastEdge = *_westEdge = 0;
+	if( trees.empty() ) {
+		return;
+	}
+	*_northEdge = TO_FLOAT( max( 0.0, *rows.rbegin() ) );
+	*_southEdge = TO_FLOAT( min( 0.0, *rows.begin() ) );
+	*_eastEdge  = TO_FLOAT( max( 0.0, *columns.rbegin() ) );
+	*_westEdge  = TO_FLOAT( min( 0.0, *columns.begin() ) );
+}
+
+/**\brief Generate an XML Node of every Quadrant.
+ */
+xmlNodePtr QuadrantIndex::ToNode() {
+	map<Coordinate,QuadTree*>::iterator iter;
+	xmlNodePtr thisNode = xmlNewNode(NULL, BAD_CAST "Quadrants" );
+	for ( iter = trees.begin(); iter != trees.end(); ++iter ) {
+		xmlAddChild( thisNode, iter->second->ToNode() );
+	}
+	return thisNode;
+}
+
+/**\brief Populate a list of all Quadtrees.
+ * \details Used for looping between all Quadrants.
+ * \warn
+ * This is not very efficient, but std::transform doesn't work...
+ * (if for some reason we got transform working, the idea would be to have
+ *   a helper method to get map->second to pass as the 4th argument of transform
+ *   with the third argument being a back_inserter into the list we want)
+ */
+void QuadrantIndex::GetAllQuadrants (vector<QuadTree*> *quadrants)
+{
+	map<Coordinate,QuadTree*>::iterator mapIter = trees.begin();
+	while (mapIter != trees.end())
+	{
+		quadrants->push_back (mapIter->second);
+		++ mapIter;
+	}
+}
@@ -0,0 +1,59 @@
+/**\file			quadrantindex.h
+ * \author			agent (agent@local)
+ * \date			Created: Sunday, October 18, 2026
+ * \date			Modified: Sunday, October 18, 2026
+ * \brief			SpatialIndex built from a grid of QuadTrees.
+ * \details
+ */
+
+#ifndef __h_quadrantindex__
+#define __h_quadrantindex__
+
+#include "includes.h"
+#include "Utilities/quadtree.h"
+#include "Utilities/spatialindex.h"
+
+class QuadrantIndex : public SpatialIndex {
+	public:
+		QuadrantIndex();
+		~QuadrantIndex();
+
+		void Insert( Sprite *sprite );
+		bool Delete( Sprite *sprite );
+
+		void Update( lua_State *L, const SpatialUpdateFilter& filter, vector<Sprite*> *updated );
+		void ReBallance();
+
+		void ForEachSpriteNear( Coordinate c, float r, int type, SpriteVisitor& visitor );
+		void GetNearestSprites( NearestQuery& query );
+
+		unsigned int Count() { return numSprites; }
+		int GetNumRegions() { return trees.size(); }
+		void GetBoundaries( float *northEdge, float *southEdge, float *eastEdge, float *westEdge );
+
+		void Draw( Coordinate focus );
+		xmlNodePtr ToNode();
+
+		static Coordinate GetQuadrantCenter( Coordinate point );
+
+	private:
+		QuadTreePool treePool;              ///< Recycled storage for every QuadTree node and leaf.
+		map<Coordinate,QuadTree*> trees;    ///< The populated Quadrants, by their center.
+		vector<QuadTree*> allQuadrants;     ///< Every Quadrant at the start of this tick.
+		vector<QuadTree*> updateQuadrants;  ///< The Quadrants being updated this tick.
+		vector<Sprite*> outOfBounds;        ///< Sprites that left their Quadrant this tick.
+		vector<QuadSearchEntry> searchQueue;///< The QuadTrees waiting to be searched by GetNearestSprites.
+		vector<Coordinate> emptyQuadrants;  ///< The centers of Quadrants that may have become empty since the last ReBallance.
+		multiset<double> columns;           ///< The x position of every Quadrant's center.  The ends are the east and west edges.
+		multiset<double> rows;              ///< The y position of every Quadrant's center.  The ends are the north and south edges.
+		unsigned int numSprites;            ///< The number of Sprites in all Quadrants.
+
+		void DeleteEmptyQuadrants( void );
+		void CheckIfEmpty( QuadTree *tree );
+		QuadTree* GetQuadrant( Coordinate point );
+		bool GetQuadrantRange( Coordinate c, float r, Coordinate *lowest, Coordinate *highest );
+
+		void GetAllQuadrants( vector<QuadTree*> *quadrants );
+};
+
+#endif // __h_quadrantindex__
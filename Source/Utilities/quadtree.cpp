@@ -9,8 +9,19 @@
 #include "includes.h"
 #include "Utilities/log.h"
 #include "Utilities/quadtree.h"
+#include "Utilities/spatialindex.h"
 #include "Graphics/video.h"
 
+// SSE2 is part of every x86-64 processor, so it needs no special build flags there.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define QUADTREE_SSE2
+#include <emmintrin.h>
+#endif
+
+#if QUADLEAFCAPACITY % 4 != 0 || QUADLEAFCAPACITY > 32
+#error "QuadLeafBucket::Filter needs QUADLEAFCAPACITY to be a multiple of 4, and at most 32."
+#endif
+
 const char* PositionNames[4] = { "UPPER_LEFT", "UPPER_RIGHT", "LOWER_LEFT", "LOWER_RIGHT"};
 
 /**\class QuadTree
@@ -39,25 +50,37 @@ const char* PositionNames[4] = { "UPPER_LEFT", "UPPER_RIGHT", "LOWER_LEFT", "LOW
    +--------+--------+
    \endverbatim
  *
- * \see GetNearestSprite
- * \see GetSpritesNear
+ * The searches never look at the Sprites in a Leaf one by one.  Each bucket
+ * of a Leaf is filtered as a whole against the search circle and type mask,
+ * and only the Sprites that pass are handed on.
+ *
+ * \see GetNearestSprites
+ * \see ForEachSpriteNear
+ * \see QuadLeafBucket::Filter
  *
  */
 
 /** \brief Constructor
  * By default there are no instantiated subtrees.
+ *
+ * QuadTrees should be created and destroyed through a QuadTreePool rather than new and delete.
+ * \see QuadTreePool::NewTree
  */
 
-QuadTree::QuadTree(Coordinate _center, float _radius){
+QuadTree::QuadTree(QuadTreePool* _pool, QuadTree* _parent, Coordinate _center, float _radius){
 	// cout<<"New QT at "<<_center<<" has R="<<_radius<<endl;
 	assert(_radius>MIN_QUAD_SIZE/2);
+	assert(_pool!=NULL);
 	for(int t=0;t<4;t++){
 		subtrees[t] = NULL;
 	}
-	this->objects = new list<Sprite*>();
+	this->pool = _pool;
+	this->parent = _parent;
+	this->objects = NULL;
 	this->radius = _radius;
 	this->center = _center;
 	this->objectcount = 0;
+	this->lastUpdate = 0;
 	this->isLeaf = true;
 	this->isDirty = false;
 }
@@ -66,12 +89,17 @@ QuadTree::QuadTree(Coordinate _center, float _radius){
  */
 
 QuadTree::~QuadTree(){
-	this->objects->clear();
-	delete objects;
+	// Any Sprites still here are no longer in a Leaf
+	for( QuadLeafBucket* b = objects; b != NULL; b = b->next ) {
+		for( unsigned int s = 0; s < b->count; s++ ) {
+			b->sprites[s]->GetSpatialHandle() = SpatialHandle();
+		}
+	}
+	ClearLeaf();
 	// Delete the Subtrees (Node)
 	for(int t=0;t<4;t++){
 		if(NULL != (subtrees[t])){
-			delete subtrees[t];
+			pool->DeleteTree( subtrees[t] );
 			this->subtrees[t] = NULL;
 		}
 	}
@@ -97,6 +125,17 @@ unsigned int QuadTree::Count(){
 	*/
 }
 
+/** \brief The top of the Quadrant containing this QuadTree.
+ */
+
+QuadTree* QuadTree::GetRoot(){
+	QuadTree* root = this;
+	while( root->parent != NULL ) {
+		root = root->parent;
+	}
+	return root;
+}
+
 /** \brief Check if a point is inside this QuadTree.
  * \arg point The point that we want to check.
  * \returns True if the point is inside the QuadTree.
@@ -110,6 +149,19 @@ bool QuadTree::Contains(Coordinate point){
 	return insideLeftBorder && insideRightBorder && insideTopBorder && insideBottomBorder;
 }
 
+/** \brief The squared distance from a point to the closest edge of this QuadTree.
+ * \arg point The point that we want to check.
+ * \returns Zero if the point is inside the QuadTree.
+ */
+
+double QuadTree::DistanceSquaredTo(Coordinate point){
+	double dx = fabs(point.GetX() - center.GetX()) - radius;
+	double dy = fabs(point.GetY() - center.GetY()) - radius;
+	dx = (dx > 0) ? dx : 0;
+	dy = (dy > 0) ? dy : 0;
+	return dx*dx + dy*dy;
+}
+
 /** \brief Add a Sprite to this Tree
  *
  * The Tree is marked as dirty if the Sprite is added to a Leaf.
@@ -122,7 +174,7 @@ void QuadTree::Insert(Sprite *obj){
 	if(! isLeaf ){ // Node
 		InsertSubTree(obj);
 	} else { // Leaf
-		objects->push_back(obj);
+		InsertLeaf(obj);
 		// An over Full Leaf should become a Node
 		isDirty=true;
 	}
@@ -131,80 +183,47 @@ void QuadTree::Insert(Sprite *obj){
 
 /** \brief Remove a Sprite from this Tree
  *
- * The Tree is marked as dirty if the Sprite if successfully found and removed.
+ * The Sprite's SpatialHandle leads straight to its Leaf, so this does not
+ * need to search for it.  Every Node above that Leaf is marked as dirty.
  *
  * \arg obj The Sprite to delete.
  * \returns TRUE if the Sprite is found and successfully removed.
  */
 
 bool QuadTree::Delete(Sprite* obj){
-	if(0 == this->Count())
-		return( false ); // No objects to delete.
+	QuadTree* leaf = obj->GetSpatialHandle().leaf;
 
-	if(!Contains(obj->GetWorldPosition()))
-		return( false ); // Out of bounds, nothing to delete.
-
-	if(!isLeaf){ // Node
-		QuadTree* dest = subtrees[SubTreeThatContains( obj->GetWorldPosition() )];
-		if(dest==NULL)
-			return( false ); // That branch is empty, nothing to delete.
-		if( dest->Delete(obj) ){
-			isDirty=true;
-			objectcount--;
-			return( true ); // Found that object.
-		} else {
-			return( false ); // Didn't find that object.
-		}
-	} else { // Leaf
-		list<Sprite *>::iterator i = std::find( objects->begin(), objects->end(), obj);
-		if(i != objects->end())
-		{
-			i = objects->erase( i );
-			// Note that leaves don't ReBallance on delete.
-			objectcount--;
-			return( true );
-		} else {
-			return( false );
-		}
+	// Make sure that the Sprite's Leaf is part of this Tree
+	QuadTree* tree = leaf;
+	while( tree != NULL && tree != this ) {
+		tree = tree->parent;
 	}
-}
+	if( tree == NULL )
+		return( false ); // Not in this Tree, nothing to delete.
 
-/** \brief Get all Sprites in this QuadTree
- *
- * \returns A list of Sprite pointers.
- */
+	if( !leaf->DeleteLeaf(obj) )
+		return( false );
 
-list<Sprite *> *QuadTree::GetSprites() {
-	if(!isLeaf){ // Node
-		list<Sprite*> *other;
-		list<Sprite*> *full = new list<Sprite*>();
-		for(int t=0;t<4;t++){
-			if(NULL != (subtrees[t])){
-				other = subtrees[t]->GetSprites();
-				full->splice(full->end(), *other );
-				delete other;
-			}
-		}
-		return full;
-	} else { // Leaf
-		return new list<Sprite*>(*objects);
+	// Note that leaves don't ReBallance on delete.
+	leaf->objectcount--;
+	for( tree = leaf->parent; tree != NULL; tree = tree->parent ) {
+		tree->isDirty = true;
+		tree->objectcount--;
 	}
+	return( true );
 }
 
-/** \brief Get all Sprites within a certain radius.
+/** \brief Visit all Sprites within a certain radius.
  *
  * \arg point The center of the search radius.
  * \arg distance The maximum search radius.
- * \arg nearby [out] The list of all Sprites found within the search radius.
  * \arg type A DRAW_ORDER mask used to filter for desired Sprite types.
- *
- * The nearby list is passed down the recursive call-stack rather than returned at by each call.
- * This limits the malloc calls.
+ * \arg visitor Receives each Sprite found within the search radius.
  *
  * \returns nothing.
  */
 
-void QuadTree::GetSpritesNear(Coordinate point, float distance, list<Sprite*> *nearby, int type){
+void QuadTree::ForEachSpriteNear(Coordinate point, float distance, int type, SpriteVisitor& visitor){
 	// The Maximum range is when the center and point are on a 45 degree angle.
 	//   Root-2 of the radius + the distance
 	const float maxrange = V_SQRT2*radius + distance;
@@ -218,77 +237,71 @@ void QuadTree::GetSpritesNear(Coordinate point, float distance, list<Sprite*> *n
 	if(!isLeaf){ // Node
 		for(int t=0;t<4;t++){
 			if(NULL != (subtrees[t])){
-				subtrees[t]->GetSpritesNear(point,distance,nearby,type);
+				subtrees[t]->ForEachSpriteNear(point,distance,type,visitor);
 			}
 		}
 	} else { // Leaf
-		list<Sprite*>::iterator i;
-		for( i = objects->begin(); i != objects->end(); ++i ) {
-			if( ((*i)->GetDrawOrder() & type) == 0) continue;
-			if( (point - (*i)->GetWorldPosition()).GetMagnitudeSquared() < distance*distance + (*i)->GetRadarSize()*(*i)->GetRadarSize() ) {
-				nearby->push_back( *i);
+		const double limit = distance*distance;
+		for( QuadLeafBucket* b = objects; b != NULL; b = b->next ) {
+			unsigned int hits = b->Filter( point, limit, true, false, type );
+			for( unsigned int s = 0; hits != 0; s++, hits >>= 1 ) {
+				if( hits & 1 ) {
+					visitor.Visit( b->sprites[s] );
+				}
 			}
 		}
 	}
 }
 
-/**\brief Find the Sprite that is closest to a known point.
+/**\brief Find the Sprites that are closest to a known point.
  *
- * \arg obj The Sprite at the center of the search radius.
- *          This Sprite is ignored while searching.
- *          Otherwise, a Sprite wouldn't be able to find other Sprites near them, they would always find themselves. )
- * \arg distance A Max radius to use while searching.
- *      	     Sprites outside of this radius are ignored.
- *               Each recurse of this function will use the smallest new radius.
- * \arg type A DRAW_ORDER mask used to filter for desired Sprite types.
+ * This is a best first search.  The queue is a min heap of QuadTrees ordered
+ * by how close their nearest edge is to the query point.  The closest
+ * QuadTree is always searched next: Leaves offer their Sprites to the query
+ * and Nodes add their subtrees to the queue.  The search stops as soon as the
+ * closest remaining QuadTree is further away than the query's bound, since
+ * nothing inside it could improve the results.
  *
- * \returns A pointer to the Sprite nearest the obj Sprite, within a certain distance, and of the correct type.
+ * \arg queue The QuadTrees to search, already in heap order.  It is empty
+ *      when this returns.
+ * \arg query The query that collects the results.
  */
 
-Sprite* QuadTree::GetNearestSprite(Sprite* obj, float distance, int type){
-	// The Maximum range is when the center and point are on a 45 degree angle.
-	//   Root-2 of the radius + the distance
-	const float maxrange = V_SQRT2*radius + distance;
-	Sprite* closest=NULL;
-	Sprite* possible=NULL;
-	float tmpdist;
-	float mindist=distance;
-	Coordinate point = obj->GetWorldPosition();
+void QuadTree::GetNearestSprites(vector<QuadSearchEntry> *queue, NearestQuery& query){
+	Coordinate point = query.GetPoint();
+	while( !queue->empty() ) {
+		pop_heap( queue->begin(), queue->end(), greater<QuadSearchEntry>() );
+		QuadSearchEntry entry = queue->back();
+		queue->pop_back();
 
-	// If the distance to the point is greater than the max range,
-	//   then no collisions are possible
-	if( (point-center).GetMagnitudeSquared() > maxrange*maxrange){
-		return NULL;
-	}
-	if(!isLeaf){ // Node
-		// Nodes work in linear space
-		mindist=distance;
-		for(int t=0;t<4;t++){
-			if(NULL != (subtrees[t])){
-				possible = subtrees[t]->GetNearestSprite(obj,distance,type);
-				if(possible==NULL) continue; // This tree short circuited
-				tmpdist = (point-possible->GetWorldPosition()).GetMagnitude();
-				if( tmpdist < mindist ){
-					mindist = tmpdist;
-					closest = possible;
+		if( entry.first > query.GetBound() ) {
+			break; // Everything left is further away
+		}
+
+		QuadTree* tree = entry.second;
+		if(!tree->isLeaf){ // Node
+			for(int t=0;t<4;t++){
+				if(NULL != (tree->subtrees[t])){
+					double distance = tree->subtrees[t]->DistanceSquaredTo(point);
+					if( distance <= query.GetBound() ) {
+						queue->push_back( QuadSearchEntry(distance, tree->subtrees[t]) );
+						push_heap( queue->begin(), queue->end(), greater<QuadSearchEntry>() );
+					}
 				}
 			}
-		}
-	} else { // Leaf
-		// Leaves work in square space
-		mindist=distance*distance;
-		list<Sprite*>::iterator i;
-		for( i = objects->begin(); i != objects->end(); ++i ) {
-			if(((*i) == obj) || (((*i)->GetDrawOrder() & type) == 0))
-				continue;
-			tmpdist = (point - (*i)->GetWorldPosition()).GetMagnitudeSquared();
-			if( tmpdist < mindist ) {
-				mindist = tmpdist;
-				closest = (*i);
+		} else { // Leaf
+			for( QuadLeafBucket* b = tree->objects; b != NULL; b = b->next ) {
+				// The bound only shrinks as Sprites are Offered, so this never drops a better Sprite.
+				unsigned int hits = b->Filter( point, query.GetBound(), false, true, query.GetType() );
+				for( unsigned int s = 0; hits != 0; s++, hits >>= 1 ) {
+					if( hits & 1 ) {
+						query.Offer( b->sprites[s] );
+					}
+				}
 			}
 		}
 	}
-	return closest;
+	queue->clear();
 }
 
 /** \brief  Check and remove any Sprites are not contained in this QuadTree.
@@ -297,68 +310,69 @@ Sprite* QuadTree::GetNearestSprite(Sprite* obj, float distance, int type){
  * Any Sprites that can be re-inserted into this QuadTree will be re-inserted.
  * Sprites that are outside of this this QuadTree are removed and forgotten.
  *
- * \returns List of all Sprites outside of this QuadTree.
+ * \arg outofbounds [out] All Sprites outside of this QuadTree are appended here.
  */
 
-list<Sprite*> *QuadTree::FixOutOfBounds(){
-	list<Sprite*>::iterator i;
-	list<Sprite*> *other;
-	list<Sprite*> *stillinside = new list<Sprite*>();
-	list<Sprite*> *outofbounds = new list<Sprite*>();
+void QuadTree::FixOutOfBounds(vector<Sprite*> *outofbounds){
+	const size_t first = outofbounds->size();
+	size_t escaped;
 	if(!isLeaf){ // Node
 		// Collect out of bound sprites from sub-trees
 		for(int t=0;t<4;t++){
 			if(NULL != (subtrees[t])){
-				other = subtrees[t]->FixOutOfBounds();
-				outofbounds->splice(outofbounds->end(),*other);
-				delete other;
+				subtrees[t]->FixOutOfBounds(outofbounds);
 			}
 		}
-		objectcount-= outofbounds->size();
-		if(outofbounds->size()) isDirty=true;
+		escaped = outofbounds->size() - first;
+		objectcount-= escaped;
 		// Insert any sprites that are inside of this Tree
-		for( i = outofbounds->begin(); i != outofbounds->end(); ++i ) {
-			if( this->Contains((*i)->GetWorldPosition()) ) {
-				stillinside->push_back(*i);
+		size_t s = first;
+		while( s < outofbounds->size() ) {
+			Sprite* sprite = (*outofbounds)[s];
+			if( this->Contains(sprite->GetWorldPosition()) ) {
+				this->Insert(sprite);
+				(*outofbounds)[s] = outofbounds->back();
+				outofbounds->pop_back();
+			} else {
+				s++;
 			}
 		}
-		for( i = stillinside->begin(); i != stillinside->end(); ++i ) {
-			this->Insert(*i);
-			outofbounds->remove(*i);
-		}
 	} else { // Leaf
 		// Collect and forget any out of bound sprites from object list
-		for( i = objects->begin(); i != objects->end(); ++i ) {
-			if(! this->Contains((*i)->GetWorldPosition()) ) {
-				outofbounds->push_back( *i );
+		for( QuadLeafBucket* b = objects; b != NULL; b = b->next ) {
+			for( unsigned int s = 0; s < b->count; s++ ) {
+				if(! this->Contains( Coordinate( b->x[s], b->y[s] ) ) ) {
+					outofbounds->push_back( b->sprites[s] );
+				}
 			}
 		}
-		for( i = outofbounds->begin(); i != outofbounds->end(); ++i ) {
-			objects->remove(*i);
+		escaped = outofbounds->size() - first;
+		for( size_t s = first; s < outofbounds->size(); s++ ) {
+			DeleteLeaf( (*outofbounds)[s] );
 		}
-		objectcount-= outofbounds->size();
+		objectcount-= escaped;
 	}
-	delete stillinside;
-	if(outofbounds->size()) isDirty=true;
-	// Return any sprites that couldn't be re-inserted
-	return outofbounds;
+	if(escaped) isDirty=true;
 }
 
 /** \brief Update all Sprites in this QuadTree
+ * \arg updated [out] Each Sprite that was Updated is appended.
  */
 
-void QuadTree::Update( lua_State *L ){
-	list<Sprite*>::iterator i;
+void QuadTree::Update( lua_State *L, vector<Sprite*> *updated ){
 	// Update all internal sprites
 	if(!isLeaf){ // Node
 		for(int t=0;t<4;t++){
 			if(NULL != (subtrees[t])){
-				subtrees[t]->Update( L );
+				subtrees[t]->Update( L, updated );
 			}
 		}
 	} else { // Leaf
-		for( i = objects->begin(); i != objects->end(); ++i ) {
-			(*i)->Update( L );
+		for( QuadLeafBucket* b = objects; b != NULL; b = b->next ) {
+			for( unsigned int s = 0; s < b->count; s++ ) {
+				b->sprites[s]->Update( L );
+				updated->push_back( b->sprites[s] );
+			}
 		}
 	}
 }
@@ -387,14 +401,16 @@ void QuadTree::Draw(Coordinate root){
 			if(NULL != (subtrees[t])) subtrees[t]->Draw(root);
 		}
 	} else { // Leaf
-		list<Sprite *>::iterator i;
-		for( i = objects->begin(); i != objects->end(); ++i ) {
-			Coordinate pos = (*i)->GetWorldPosition() - root;
-			int posx = static_cast<int>((scale* (float)pos.GetX() / QUADRANTSIZE) + (float)Video::GetHalfWidth());
-			int posy = static_cast<int>((scale* (float)pos.GetY() / QUADRANTSIZE) + (float)Video::GetHalfHeight());
-			Color col = (*i)->GetRadarColor();
-			// The 17 is here because it looks nice.  I can't explain why.
-			Video::DrawCircle( posx, posy, static_cast<int>(17.f*(*i)->GetRadarSize()/scale),2, col.r,col.g,col.b );
+		for( QuadLeafBucket* b = objects; b != NULL; b = b->next ) {
+			for( unsigned int s = 0; s < b->count; s++ ) {
+				Sprite* sprite = b->sprites[s];
+				Coordinate pos = sprite->GetWorldPosition() - root;
+				int posx = static_cast<int>((scale* (float)pos.GetX() / QUADRANTSIZE) + (float)Video::GetHalfWidth());
+				int posy = static_cast<int>((scale* (float)pos.GetY() / QUADRANTSIZE) + (float)Video::GetHalfHeight());
+				Color col = sprite->GetRadarColor();
+				// The 17 is here because it looks nice.  I can't explain why.
+				Video::DrawCircle( posx, posy, static_cast<int>(17.f*sprite->GetRadarSize()/scale),2, col.r,col.g,col.b );
+			}
 		}
 	}
 }
@@ -429,7 +445,7 @@ void QuadTree::CreateSubTree(QuadPosition pos){
 		default: assert(0);
 	}
 	assert(subtrees[pos]==NULL);
-	subtrees[pos] = new QuadTree(center+offset,half);
+	subtrees[pos] = pool->NewTree(center+offset,half,this);
 	assert(subtrees[pos]!=NULL);
 }
 
@@ -447,6 +463,84 @@ void QuadTree::InsertSubTree(Sprite *obj){
 	subtrees[pos]->Insert(obj);
 }
 
+/** \brief Store a Sprite in this Leaf's buckets.
+ *  This doesn't do any accounting for this Tree.
+ */
+
+void QuadTree::InsertLeaf(Sprite *obj){
+	// Only the first bucket may have room, so start a new chain link when it is full.
+	if( objects == NULL || objects->count == QUADLEAFCAPACITY ) {
+		QuadLeafBucket* bucket = pool->NewBucket();
+		bucket->next = objects;
+		objects = bucket;
+	}
+	SpatialHandle& handle = obj->GetSpatialHandle();
+	handle.leaf = this;
+	handle.bucket = objects;
+	handle.slot = objects->count;
+	objects->Store( objects->count++, obj );
+}
+
+/** \brief Remove a Sprite from this Leaf's buckets.
+ *  The hole is filled with the last Sprite of the first bucket so that the buckets stay packed.
+ *  This doesn't do any accounting for this Tree.
+ * \returns TRUE if the Sprite was in this Leaf.
+ */
+
+bool QuadTree::DeleteLeaf(Sprite *obj){
+	SpatialHandle& handle = obj->GetSpatialHandle();
+	if( handle.leaf != this )
+		return( false );
+
+	Sprite* last = objects->sprites[ --objects->count ];
+	handle.bucket->Copy( handle.slot, objects, objects->count );
+	SpatialHandle& lastHandle = last->GetSpatialHandle();
+	lastHandle.bucket = handle.bucket;
+	lastHandle.slot = handle.slot;
+	handle = SpatialHandle();
+
+	if( objects->count == 0 ) {
+		QuadLeafBucket* empty = objects;
+		objects = objects->next;
+		pool->DeleteBucket( empty );
+	}
+	return( true );
+}
+
+/** \brief Release all of this Leaf's buckets back to the pool.
+ *  The Sprites in them should already have been moved elsewhere.
+ */
+
+void QuadTree::ClearLeaf(){
+	while( objects != NULL ) {
+		QuadLeafBucket* next = objects->next;
+		pool->DeleteBucket( objects );
+		objects = next;
+	}
+}
+
+/** \brief Move every Sprite in this QuadTree into the buckets of another Leaf.
+ *  This is used when a Node collapses back into a Leaf.
+ *  It doesn't do any accounting for either Tree.
+ */
+
+void QuadTree::MoveSpritesInto(QuadTree* leaf){
+	if(!isLeaf){ // Node
+		for(int t=0;t<4;t++){
+			if(NULL != (subtrees[t])){
+				subtrees[t]->MoveSpritesInto(leaf);
+			}
+		}
+	} else { // Leaf
+		for( QuadLeafBucket* b = objects; b != NULL; b = b->next ) {
+			for( unsigned int s = 0; s < b->count; s++ ) {
+				leaf->InsertLeaf( b->sprites[s] );
+			}
+		}
+		ClearLeaf();
+	}
+}
+
 /** \brief Ballance the QuadTree by splitting and merging subtrees
  *
  * If this is a Leaf that contains more than QUADMAXOBJECTS Sprites, it splits itself.
@@ -458,31 +552,28 @@ void QuadTree::InsertSubTree(Sprite *obj){
 
 void QuadTree::ReBallance(){
 	unsigned int numObjects = this->Count();
-	list<Sprite*>::iterator i;
 	
 	if( isDirty && isLeaf && numObjects>QUADMAXOBJECTS && radius>MIN_QUAD_SIZE){
 		//cout << "LEAF at "<<center<<" is becoming a NODE.\n";
 		isLeaf = false;
 
-		assert(0 != objects->size()); // The Leaf list should not be empty
+		assert(NULL != objects); // The Leaf list should not be empty
 		
-		for( i = objects->begin(); i != objects->end(); ++i ) {
-			InsertSubTree(*i);
+		for( QuadLeafBucket* b = objects; b != NULL; b = b->next ) {
+			for( unsigned int s = 0; s < b->count; s++ ) {
+				InsertSubTree( b->sprites[s] );
+			}
 		}
 		assert(!isLeaf); // Still a Node
-		this->objects->clear();
+		ClearLeaf();
 	} else if(isDirty && !isLeaf && numObjects<=QUADMAXOBJECTS ){
-		assert(0 == objects->size()); // The Leaf list should be empty
+		assert(NULL == objects); // The Leaf list should be empty
 		//cout << "NODE at "<<center<<" is becoming a LEAF.\n";
 		isLeaf = true;
 		for(int t=0;t<4;t++){
 			if(NULL != (subtrees[t])){
-				list<Sprite*> *other = subtrees[t]->GetSprites();
-				for( i = other->begin(); i != other->end(); ++i ) {
-					objects->push_back( *i );
-				}
-				delete other;
-				delete subtrees[t];
+				subtrees[t]->MoveSpritesInto(this);
+				pool->DeleteTree( subtrees[t] );
 				subtrees[t] = NULL;
 			}
 		}
@@ -492,7 +583,7 @@ void QuadTree::ReBallance(){
 	for(int t=0;t<4;t++){
 		if(NULL != (subtrees[t])){
 			if(subtrees[t]->Count()==0){
-				delete subtrees[t];
+				pool->DeleteTree( subtrees[t] );
 				subtrees[t] = NULL;
 			} else {
 				subtrees[t]->ReBallance();
@@ -513,7 +604,6 @@ void QuadTree::ReBallance(){
 xmlNodePtr QuadTree::ToNode() {
 	xmlNodePtr thisNode, objNode;
 	char buff[256];
-	list<Sprite*>::iterator i;
 
 	thisNode = xmlNewNode(NULL, BAD_CAST "QuadTree" );
 
@@ -531,44 +621,166 @@ xmlNodePtr QuadTree::ToNode() {
 			}
 		}
 	} else { // Leaf
-		for( i = objects->begin(); i != objects->end(); ++i ) {
-			switch((*i)->GetDrawOrder()) {
-				case DRAW_ORDER_PLANET:
-					snprintf(buff, sizeof(buff), "%s", "Planet" );
-					break;
-				case DRAW_ORDER_PROJECTILE:
-					snprintf(buff, sizeof(buff), "%s", "Weapon" );
-					break;
-				case DRAW_ORDER_SHIP:
-					snprintf(buff, sizeof(buff), "%s", "Ship" );
-					break;
-				case DRAW_ORDER_PLAYER:
-					snprintf(buff, sizeof(buff), "%s", "Player" );
-					break;
-				case DRAW_ORDER_GATE_TOP:
-					snprintf(buff, sizeof(buff), "%s", "Gate" );
-					break;
-				case DRAW_ORDER_EFFECT:
-					snprintf(buff, sizeof(buff), "%s", "Effect" );
-					break;
-				case DRAW_ORDER_GATE_BOTTOM: // Ignore
-					continue;
-				default:
-					LogMsg(ERR,"Unknown Sprite Type: %d",(*i)->GetDrawOrder());
-					assert(0);
-					break;
+		for( QuadLeafBucket* b = objects; b != NULL; b = b->next ) {
+			for( unsigned int s = 0; s < b->count; s++ ) {
+				Sprite* sprite = b->sprites[s];
+				switch(sprite->GetDrawOrder()) {
+					case DRAW_ORDER_PLANET:
+						snprintf(buff, sizeof(buff), "%s", "Planet" );
+						break;
+					case DRAW_ORDER_PROJECTILE:
+						snprintf(buff, sizeof(buff), "%s", "Weapon" );
+						break;
+					case DRAW_ORDER_SHIP:
+						snprintf(buff, sizeof(buff), "%s", "Ship" );
+						break;
+					case DRAW_ORDER_PLAYER:
+						snprintf(buff, sizeof(buff), "%s", "Player" );
+						break;
+					case DRAW_ORDER_GATE_TOP:
+						snprintf(buff, sizeof(buff), "%s", "Gate" );
+						break;
+					case DRAW_ORDER_EFFECT:
+						snprintf(buff, sizeof(buff), "%s", "Effect" );
+						break;
+					case DRAW_ORDER_GATE_BOTTOM: // Ignore
+						continue;
+					default:
+						LogMsg(ERR,"Unknown Sprite Type: %d",sprite->GetDrawOrder());
+						assert(0);
+						break;
+				}
+				objNode = xmlNewNode(NULL, BAD_CAST buff);
+				snprintf(buff, sizeof(buff), "%d", (int) sprite->GetWorldPosition().GetX() );
+				xmlSetProp( objNode, BAD_CAST "x", BAD_CAST buff );
+				snprintf(buff, sizeof(buff), "%d", (int) sprite->GetWorldPosition().GetY() );
+				xmlSetProp( objNode, BAD_CAST "y", BAD_CAST buff );
+				snprintf(buff, sizeof(buff), "%d", (int) sprite->GetAngle() );
+				xmlSetProp( objNode, BAD_CAST "angle", BAD_CAST buff );
+				xmlAddChild(thisNode, objNode);
 			}
-			objNode = xmlNewNode(NULL, BAD_CAST buff);
-			snprintf(buff, sizeof(buff), "%d", (int) (*i)->GetWorldPosition().GetX() );
-			xmlSetProp( objNode, BAD_CAST "x", BAD_CAST buff );
-			snprintf(buff, sizeof(buff), "%d", (int) (*i)->GetWorldPosition().GetY() );
-			xmlSetProp( objNode, BAD_CAST "y", BAD_CAST buff );
-			snprintf(buff, sizeof(buff), "%d", (int) (*i)->GetAngle() );
-			xmlSetProp( objNode, BAD_CAST "angle", BAD_CAST buff );
-			xmlAddChild(thisNode, objNode);
 		}
 	}
 
 	return thisNode;
 }
 
+/**\class QuadLeafBucket
+ * \brief Contiguous, fixed capacity storage for the Sprites in a Leaf.
+ */
+
+/** \brief Find the Sprites of this bucket that are inside a circle and match a type mask.
+ *
+ * Every slot is tested at once from the copies kept in the bucket, without
+ * touching the Sprites.  With SSE2, two positions are measured per
+ * instruction and four types are masked per instruction.
+ *
+ * \arg point The center of the circle.
+ * \arg limit The squared radius of the circle.
+ * \arg withReach Add each Sprite's squared radar size to limit, as ForEachSpriteNear does.
+ * \arg inclusive Also accept Sprites exactly on the edge of the circle.
+ * \arg type A DRAW_ORDER mask of the Sprites to accept.
+ * \returns A bit for each accepted slot, slot 0 in the lowest bit.
+ */
+
+unsigned int QuadLeafBucket::Filter(Coordinate point, double limit, bool withReach, bool inclusive, int type) const {
+	unsigned int hits = 0;
+	unsigned int misses = 0;
+
+#ifdef QUADTREE_SSE2
+	const __m128d px = _mm_set1_pd( point.GetX() );
+	const __m128d py = _mm_set1_pd( point.GetY() );
+	const __m128d radius = _mm_set1_pd( limit );
+	for( unsigned int s = 0; s < count; s += 2 ) {
+		__m128d dx = _mm_sub_pd( px, _mm_loadu_pd( &x[s] ) );
+		__m128d dy = _mm_sub_pd( py, _mm_loadu_pd( &y[s] ) );
+		__m128d distance = _mm_add_pd( _mm_mul_pd( dx, dx ), _mm_mul_pd( dy, dy ) );
+		__m128d edge = withReach ? _mm_add_pd( radius, _mm_loadu_pd( &reach[s] ) ) : radius;
+		__m128d inside = inclusive ? _mm_cmple_pd( distance, edge ) : _mm_cmplt_pd( distance, edge );
+		hits |= _mm_movemask_pd( inside ) << s;
+	}
+
+	const __m128i mask = _mm_set1_epi32( type );
+	const __m128i zero = _mm_setzero_si128();
+	for( unsigned int s = 0; s < count; s += 4 ) {
+		__m128i matched = _mm_and_si128( _mm_loadu_si128( reinterpret_cast<const __m128i*>( &types[s] ) ), mask );
+		misses |= _mm_movemask_ps( _mm_castsi128_ps( _mm_cmpeq_epi32( matched, zero ) ) ) << s;
+	}
+#else
+	for( unsigned int s = 0; s < count; s++ ) {
+		double dx = point.GetX() - x[s];
+		double dy = point.GetY() - y[s];
+		double distance = dx*dx + dy*dy;
+		double edge = withReach ? limit + reach[s] : limit;
+		if( inclusive ? distance <= edge : distance < edge ) {
+			hits |= 1u << s;
+		}
+		if( (types[s] & type) == 0 ) {
+			misses |= 1u << s;
+		}
+	}
+#endif
+
+	// The slots past the count hold leftovers from earlier Sprites.
+	unsigned int used = (count == 32) ? ~0u : (1u << count) - 1;
+	return hits & ~misses & used;
+}
+
+/**\class QuadTreePool
+ * \brief Recycles QuadTree nodes and QuadLeafBuckets.
+ *
+ * Quadrants split, merge and get deleted constantly as Sprites fly around.
+ * Rather than going to the heap each time, all QuadTree nodes and their leaf
+ * storage are carved out of a pair of free-lists owned by the SpriteManager.
+ * Once the pool has grown to fit the universe, a steady-state tick does not
+ * allocate at all.
+ *
+ * \see Pool
+ */
+
+/** \brief Constructor
+ */
+
+QuadTreePool::QuadTreePool()
+	:treePool( 256 )
+	,bucketPool( 512 )
+{
+}
+
+/** \brief Build a QuadTree inside of a recycled node.
+ * \arg center The center of the new QuadTree.
+ * \arg radius The half-width of the new QuadTree.
+ * \arg parent The Node that the new QuadTree belongs to, or NULL for a new Quadrant.
+ * \returns The new QuadTree.  Release it with DeleteTree.
+ */
+
+QuadTree* QuadTreePool::NewTree(Coordinate center, float radius, QuadTree* parent){
+	return new (treePool.Allocate()) QuadTree(this, parent, center, radius);
+}
+
+/** \brief Destroy a QuadTree and all of its subtrees.
+ * \arg tree A QuadTree created by NewTree.
+ */
+
+void QuadTreePool::DeleteTree(QuadTree* tree){
+	if(tree == NULL) return;
+	tree->~QuadTree();
+	treePool.Release( tree );
+}
+
+/** \brief Get an empty QuadLeafBucket.
+ */
+
+QuadLeafBucket* QuadTreePool::NewBucket(){
+	QuadLeafBucket* bucket = static_cast<QuadLeafBucket*>( bucketPool.Allocate() );
+	bucket->count = 0;
+	bucket->next = NULL;
+	return bucket;
+}
+
+/** \brief Return a QuadLeafBucket to the pool.
+ */
+
+void QuadTreePool::DeleteBucket(QuadLeafBucket* bucket){
+	bucketPool.Release( bucket );
+}
@@ -13,34 +13,86 @@
 #include "includes.h"
 #include "common.h"
 #include "Sprites/sprite.h"
+#include "Utilities/pool.h"
 
 #define MIN_QUAD_SIZE 10.0f
 #define QUADRANTSIZE 4096.0f
-#define QUADMAXOBJECTS 3
+#define QUADLEAFCAPACITY 8 ///< The number of Sprites held by one QuadLeafBucket.  A multiple of 4, for QuadLeafBucket::Filter.
+#define QUADMAXOBJECTS QUADLEAFCAPACITY ///< Leaves split once they outgrow one bucket, which is filtered in a single pass.
 
 enum QuadPosition{ UPPER_LEFT, UPPER_RIGHT,
                    LOWER_LEFT, LOWER_RIGHT };
 
+class QuadTreePool;
+class QuadTree;
+class NearestQuery;
+class SpriteVisitor;
+
+/// A QuadTree waiting to be searched, and its squared distance from the search point.
+typedef pair<double,QuadTree*> QuadSearchEntry;
+
+/**\brief Contiguous, fixed capacity storage for the Sprites in a Leaf.
+ * \details Leaves chain buckets together when they overflow.  Only the first
+ *          bucket of a chain may be partially filled.
+ *
+ *          Next to each Sprite pointer the bucket keeps a copy of what the
+ *          searches look at, so that a whole bucket can be filtered without
+ *          touching the Sprites.  Only the Sprites that pass are dereferenced.
+ *          The copy is refreshed by Store whenever the Sprite moves.
+ * \see Sprite::SyncSpatialHandle
+ */
+struct QuadLeafBucket {
+	Sprite* sprites[QUADLEAFCAPACITY];
+	double x[QUADLEAFCAPACITY];      ///< The position of each Sprite.
+	double y[QUADLEAFCAPACITY];
+	double reach[QUADLEAFCAPACITY];  ///< The square of each Sprite's radar size.
+	int types[QUADLEAFCAPACITY];     ///< The draw order of each Sprite.
+	unsigned int count;
+	QuadLeafBucket* next;
+
+	/// Put a Sprite in a slot, or refresh the copy of it that is already there.
+	void Store( unsigned int slot, Sprite* sprite ) {
+		Coordinate position = sprite->GetWorldPosition();
+		sprites[slot] = sprite;
+		x[slot] = position.GetX();
+		y[slot] = position.GetY();
+		reach[slot] = double( sprite->GetRadarSize() * sprite->GetRadarSize() );
+		types[slot] = sprite->GetDrawOrder();
+	}
+	/// Copy another slot of this or another bucket into a slot.
+	void Copy( unsigned int slot, const QuadLeafBucket* from, unsigned int fromSlot ) {
+		sprites[slot] = from->sprites[fromSlot];
+		x[slot] = from->x[fromSlot];
+		y[slot] = from->y[fromSlot];
+		reach[slot] = from->reach[fromSlot];
+		types[slot] = from->types[fromSlot];
+	}
+	unsigned int Filter( Coordinate point, double limit, bool withReach, bool inclusive, int type ) const;
+};
+
 class QuadTree {
 	public:
-		QuadTree(Coordinate center, float radius);
+		QuadTree(QuadTreePool* pool, QuadTree* parent, Coordinate center, float radius);
 		~QuadTree();
 
 		unsigned int Count();
 		const Coordinate GetCenter() {return center;}
+		QuadTree* GetRoot();
 
 		bool Contains(Coordinate point);
 		inline bool PossiblyNear(Coordinate, float distance);
+		double DistanceSquaredTo(Coordinate point);
 
 		void Insert(Sprite* obj);
 		bool Delete(Sprite* obj);
 
-		list<Sprite*> *GetSprites();
-		void GetSpritesNear(Coordinate point, float distance, list<Sprite*> *returnList, int type = DRAW_ORDER_ALL);
-		Sprite* GetNearestSprite(Sprite* obj, float distance, int type = DRAW_ORDER_ALL);
-		list<Sprite*> *FixOutOfBounds();
+		void ForEachSpriteNear(Coordinate point, float distance, int type, SpriteVisitor& visitor);
+		static void GetNearestSprites(vector<QuadSearchEntry> *queue, NearestQuery& query);
+		void FixOutOfBounds(vector<Sprite*> *outofbounds);
 
-		void Update( lua_State *L );
+		void Update( lua_State *L, vector<Sprite*> *updated );
+		Uint32 GetLastUpdate() const { return lastUpdate; }
+		void SetLastUpdate( Uint32 tick ) { lastUpdate = tick; }
 		void Draw(Coordinate root);
 		void ReBallance();
 
@@ -50,12 +102,19 @@ class QuadTree {
 		QuadPosition SubTreeThatContains(Coordinate point);
 		void CreateSubTree(QuadPosition pos);
 		void InsertSubTree(Sprite* obj);
+		void InsertLeaf(Sprite* obj);
+		bool DeleteLeaf(Sprite* obj);
+		void ClearLeaf();
+		void MoveSpritesInto(QuadTree* leaf);
 
+		QuadTreePool* pool;
+		QuadTree* parent;            ///< The Node containing this tree, NULL for the root of a Quadrant.
 		QuadTree* subtrees[4];
-		list<Sprite*> *objects;
+		QuadLeafBucket* objects;     ///< Leaf storage, NULL when the Leaf is empty.
 		Coordinate center;
 		float radius;
 		unsigned int objectcount;
+		Uint32 lastUpdate;           ///< The SpatialUpdateFilter tick when this Quadrant was last Updated, or 0 for never.
 		union{
 			// Unnamed struct so that these flags can be accessed directly
 			struct{
@@ -67,6 +126,27 @@ class QuadTree {
 		};
 };
 
+/**\brief Recycles QuadTree nodes and leaf buckets.
+ * \see Pool
+ */
+class QuadTreePool {
+	public:
+		QuadTreePool();
+
+		QuadTree* NewTree(Coordinate center, float radius, QuadTree* parent = NULL);
+		void DeleteTree(QuadTree* tree);
+
+		QuadLeafBucket* NewBucket();
+		void DeleteBucket(QuadLeafBucket* bucket);
+
+		unsigned int GetNumTrees() const { return treePool.GetInUse(); }
+		unsigned int GetNumBuckets() const { return bucketPool.GetInUse(); }
+
+	private:
+		Pool<QuadTree> treePool;
+		Pool<QuadLeafBucket> bucketPool;
+};
+
 inline bool QuadTree::PossiblyNear(Coordinate point, float distance) {
 	// The Maximum range is when the center and point are on a 45 degree angle.
 	//   Root-2 of the radius + the distance
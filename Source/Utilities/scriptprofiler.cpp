@@ -0,0 +1,128 @@
+/**\file			scriptprofiler.cpp
+ * \author			agent (agent@local)
+ * \date			Created: Sunday, October 18, 2026
+ * \date			Modified: Sunday, October 18, 2026
+ * \brief			Counts what each Lua state machine state and Mission function costs.
+ * \details
+ */
+
+#include "includes.h"
+#include "Utilities/file.h"
+#include "Utilities/log.h"
+#include "Utilities/options.h"
+#include "Utilities/scriptprofiler.h"
+
+/** \addtogroup Utilities
+ * @{
+ */
+
+bool ScriptProfiler::enabled = false;
+map< pair<string,string>, ScriptCost > ScriptProfiler::costs;
+
+typedef pair< pair<string,string>, ScriptCost > NamedCost;
+
+/**\brief Orders the functions from the most to the least total time.
+ */
+static bool compareTotalTime( const NamedCost& a, const NamedCost& b ) {
+	return a.second.total > b.second.total;
+}
+
+/**\brief The measured functions, most expensive first.
+ */
+static void SortCosts( const map< pair<string,string>, ScriptCost >& costs, vector<NamedCost> *sorted ) {
+	sorted->assign( costs.begin(), costs.end() );
+	sort( sorted->begin(), sorted->end(), compareTotalTime );
+}
+
+/**\brief Start or stop measuring the Lua functions.
+ * \details The costs measured so far are kept, so they add up across pauses.
+ */
+void ScriptProfiler::Enable( bool enable ) {
+	if( enable != enabled ) {
+		LogMsg(INFO, "%s profiling the Lua scripts.", enable ? "Started" : "Stopped" );
+	}
+	enabled = enable;
+}
+
+/**\brief Forget every cost measured so far.
+ */
+void ScriptProfiler::Reset() {
+	costs.clear();
+}
+
+/**\brief Add one call to the cost of a Lua function.
+ * \param table The table holding the function, like the name of a state machine.
+ * \param function The name of the function, like the name of a state.
+ * \param microseconds How long the call took.
+ * \param allocated How much the Lua heap grew during the call, in bytes.
+ */
+void ScriptProfiler::Add( const string& table, const string& function, Uint64 microseconds, Sint64 allocated ) {
+	ScriptCost& cost = costs[ make_pair( table, function ) ];
+	cost.calls++;
+	cost.total += microseconds;
+	if( microseconds > cost.max ) {
+		cost.max = microseconds;
+	}
+	cost.allocated += allocated;
+}
+
+/**\brief Describe the most expensive functions, one line each.
+ * \param lines The descriptions are appended here.
+ * \param count The number of functions to describe.
+ */
+void ScriptProfiler::Describe( vector<string> *lines, unsigned int count ) {
+	vector<NamedCost> sorted;
+	SortCosts( costs, &sorted );
+
+	char line[160];
+	for( unsigned int i = 0; i < sorted.size() && i < count; i++ ) {
+		const ScriptCost& cost = sorted[i].second;
+		snprintf( line, sizeof(line), "%s.%s: %u calls, %.1f ms, avg %.1f us, max %u us, %+.1f KB",
+			sorted[i].first.first.c_str(), sorted[i].first.second.c_str(),
+			cost.calls, cost.total / 1000.0, double( cost.total ) / cost.calls,
+			static_cast<Uint32>( cost.max ), cost.allocated / 1024.0 );
+		lines->push_back( line );
+	}
+}
+
+/**\brief Write every cost to the file named by "options/development/ai-profile-file".
+ * \details The file is comma separated, with the most expensive function first.
+ *          Nothing is written if nothing was measured.
+ * \return true if the file was written or there was nothing to write
+ */
+bool ScriptProfiler::Save() {
+	if( costs.empty() ) {
+		return true;
+	}
+	string filename = OPTION( string, "options/development/ai-profile-file" );
+	LogMsg(INFO, "Saving the Lua script profile to '%s'.", filename.c_str() );
+
+	vector<NamedCost> sorted;
+	SortCosts( costs, &sorted );
+
+	string csv = "table,function,calls,total_us,avg_us,max_us,allocated_bytes\n";
+	char line[256];
+	for( unsigned int i = 0; i < sorted.size(); i++ ) {
+		const ScriptCost& cost = sorted[i].second;
+		snprintf( line, sizeof(line), "%s,%s,%u,%llu,%.2f,%llu,%lld\n",
+			sorted[i].first.first.c_str(), sorted[i].first.second.c_str(), cost.calls,
+			static_cast<unsigned long long>( cost.total ), double( cost.total ) / cost.calls,
+			static_cast<unsigned long long>( cost.max ), static_cast<long long>( cost.allocated ) );
+		csv += line;
+	}
+
+	File saved = File( filename, true );
+	if( saved.Write( (char *)csv.c_str(), csv.size() ) != true ) {
+		LogMsg(ERR, "Could not save the Lua script profile to '%s'.", filename.c_str() );
+		return false;
+	}
+	return true;
+}
+
+/**\brief The size of the Lua heap, in bytes.
+ */
+Sint64 ScriptProfiler::GetLuaMemory( lua_State *L ) {
+	return static_cast<Sint64>( lua_gc( L, LUA_GCCOUNT, 0 ) ) * 1024 + lua_gc( L, LUA_GCCOUNTB, 0 );
+}
+
+/** @} */
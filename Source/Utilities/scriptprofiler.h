@@ -0,0 +1,85 @@
+/**\file			scriptprofiler.h
+ * \author			agent (agent@local)
+ * \date			Created: Sunday, October 18, 2026
+ * \date			Modified: Sunday, October 18, 2026
+ * \brief			Counts what each Lua state machine state and Mission function costs.
+ * \details
+ */
+
+#ifndef __h_scriptprofiler__
+#define __h_scriptprofiler__
+
+#include "includes.h"
+#include "Utilities/lua.h"
+#include "Utilities/timer.h"
+
+/**\brief What one Lua function has cost so far.
+ */
+struct ScriptCost {
+	ScriptCost() :calls( 0 ), total( 0 ), max( 0 ), allocated( 0 ) {}
+
+	Uint32 calls;      ///< The number of times it was run.
+	Uint64 total;      ///< Microseconds spent in it.
+	Uint64 max;        ///< Microseconds spent in the slowest call.
+	Sint64 allocated;  ///< Bytes the Lua heap grew by during the calls.  Collections during a call make this smaller.
+};
+
+/**\class ScriptProfiler
+ * \brief Measures the Lua functions that the engine runs over and over.
+ *
+ * \details
+ * The AI state functions, like Hunter.default, and the Mission functions,
+ * like ReturnAmbassador.Update, are counted by the table that owns them and
+ * the name of the function.
+ *
+ * While the ScriptProfiler is disabled, a ScriptTimer costs one comparison
+ * and no names are copied.
+ *
+ * \see ScriptTimer
+ */
+class ScriptProfiler {
+	public:
+		static void Enable( bool enable );
+		static bool IsEnabled() { return enabled; }
+		static void Reset();
+
+		static void Add( const string& table, const string& function, Uint64 microseconds, Sint64 allocated );
+
+		static void Describe( vector<string> *lines, unsigned int count );
+		static bool Save();
+
+		static Sint64 GetLuaMemory( lua_State *L );
+
+	private:
+		static bool enabled;                               ///< Whether the Lua functions are being measured.
+		static map< pair<string,string>, ScriptCost > costs; ///< The cost of each function, by table and function name.
+};
+
+/**\brief Measures one call of a Lua function.
+ * \details Start it just before the lua_pcall and Stop it right after, since
+ *          the state of an AI may change during the call.
+ */
+class ScriptTimer {
+	public:
+		ScriptTimer( lua_State *_L ) :L( _L ), timing( ScriptProfiler::IsEnabled() ), started( 0 ), memory( 0 ) {
+			if( timing ) {
+				memory = ScriptProfiler::GetLuaMemory( L );
+				started = Timer::GetMicroseconds();
+			}
+		}
+		void Stop( const string& table, const string& function ) {
+			if( timing ) {
+				Uint64 elapsed = Timer::GetMicroseconds() - started;
+				ScriptProfiler::Add( table, function, elapsed, ScriptProfiler::GetLuaMemory( L ) - memory );
+				timing = false;
+			}
+		}
+
+	private:
+		lua_State *L;    ///< The Lua state running the function.
+		bool timing;     ///< Whether the call is being measured.
+		Uint64 started;  ///< When the call started, in microseconds.
+		Sint64 memory;   ///< The size of the Lua heap when the call started, in bytes.
+};
+
+#endif // __h_scriptprofiler__
@@ -0,0 +1,548 @@
+/**\file			spatialhash.cpp
+ * \author			agent (agent@local)
+ * \date			Created: Sunday, October 18, 2026
+ * \date			Modified: Sunday, October 18, 2026
+ * \brief			SpatialIndex built from a uniform hash grid.
+ * \details
+ */
+
+#include "includes.h"
+#include "Utilities/log.h"
+#include "Utilities/spatialhash.h"
+#include "Graphics/video.h"
+
+/**\class SpatialHash
+ * \brief A SpatialIndex that buckets Sprites into a uniform grid of square cells.
+ *
+ * \details
+ * Each cell is identified by a pair of integers, so finding the cell for a
+ * position is a pair of floors and a hash table probe.  Only occupied cells
+ * exist.  They are stored in a flat vector and found through an open
+ * addressed hash table keyed on the integer cell coordinates.
+ *
+ * Cells should be about as wide as a typical query radius.  Then a radius
+ * query only has to touch a handful of cells, and a Sprite only changes cells
+ * once every few dozen ticks.
+ *
+ * Compared to the QuadrantIndex this trades the adaptivity of the QuadTree
+ * for cheaper bookkeeping: there is nothing to ReBallance, and moving a Sprite
+ * never touches more than two cells.
+ *
+ * \see QuadrantIndex
+ */
+
+/**\brief Create an empty grid.
+ * \param _cellSize The width of each cell in world units.
+ */
+SpatialHash::SpatialHash( float _cellSize )
+	:cellSize( _cellSize > 1.0f ? _cellSize : SPATIALHASH_DEFAULT_CELLSIZE )
+	,numCells( 0 )
+	,numSprites( 0 )
+	,maxRadarSize( 0 )
+	,boundariesDirty( false )
+	,northEdge( 0 )
+	,southEdge( 0 )
+	,eastEdge( 0 )
+	,westEdge( 0 )
+{
+	Rehash( 64 );
+}
+
+/**\brief Destructor
+ * \note The Sprites themselves are not deleted.
+ */
+SpatialHash::~SpatialHash() {
+	vector<SpatialHashCell>::iterator cell;
+	for( cell = cells.begin(); cell != cells.end(); ++cell ) {
+		vector<Sprite*>::iterator i;
+		for( i = cell->sprites.begin(); i != cell->sprites.end(); ++i ) {
+			(*i)->GetSpatialHandle() = SpatialHandle();
+		}
+	}
+}
+
+/**\brief Convert a world position into a cell coordinate.
+ */
+int SpatialHash::CellCoordinate( double position ) const {
+	return static_cast<int>( floor( position / cellSize ) );
+}
+
+/**\brief The world position of the center of a cell.
+ */
+Coordinate SpatialHash::CellCenter( const SpatialHashCell& cell ) const {
+	return Coordinate( (cell.x + 0.5) * cellSize, (cell.y + 0.5) * cellSize );
+}
+
+/**\brief Hash a cell coordinate into the table.
+ */
+unsigned int SpatialHash::Hash( int x, int y ) const {
+	return ( (static_cast<unsigned int>(x) * 73856093u) ^ (static_cast<unsigned int>(y) * 19349663u) )
+		& static_cast<unsigned int>( table.size() - 1 );
+}
+
+/**\brief Find the cell at a cell coordinate.
+ * \returns The index of the cell, or -1 if that cell is empty.
+ */
+int SpatialHash::FindCell( int x, int y ) const {
+	const unsigned int mask = static_cast<unsigned int>( table.size() - 1 );
+	unsigned int slot = Hash( x, y );
+	while( table[slot] != -1 ) {
+		const SpatialHashCell& cell = cells[ table[slot] ];
+		if( cell.x == x && cell.y == y ) {
+			return table[slot];
+		}
+		slot = (slot + 1) & mask;
+	}
+	return -1;
+}
+
+/**\brief Find or create the cell at a cell coordinate.
+ * \warning Creating a cell may move the cell storage.  Don't keep references into it.
+ * \returns The index of the cell.
+ */
+int SpatialHash::GetCell( int x, int y ) {
+	int index = FindCell( x, y );
+	if( index != -1 ) {
+		return index;
+	}
+
+	// Keep the table at most half full so that probes stay short.
+	if( (numCells + 1) * 2 > table.size() ) {
+		Rehash( static_cast<unsigned int>( table.size() * 2 ) );
+	}
+
+	if( freeCells.empty() ) {
+		index = static_cast<int>( cells.size() );
+		cells.push_back( SpatialHashCell() );
+	} else {
+		index = freeCells.back();
+		freeCells.pop_back();
+	}
+	SpatialHashCell& cell = cells[index];
+	cell.x = x;
+	cell.y = y;
+	cell.active = true;
+	cell.lastUpdate = 0;
+	assert( cell.sprites.empty() );
+
+	const unsigned int mask = static_cast<unsigned int>( table.size() - 1 );
+	unsigned int slot = Hash( x, y );
+	while( table[slot] != -1 ) {
+		slot = (slot + 1) & mask;
+	}
+	table[slot] = index;
+
+	numCells++;
+	boundariesDirty = true;
+	return index;
+}
+
+/**\brief Remove an empty cell from the table and recycle it.
+ */
+void SpatialHash::RemoveCell( int index ) {
+	SpatialHashCell& cell = cells[index];
+	assert( cell.active );
+	assert( cell.sprites.empty() );
+
+	const unsigned int mask = static_cast<unsigned int>( table.size() - 1 );
+	unsigned int hole = Hash( cell.x, cell.y );
+	while( table[hole] != index ) {
+		hole = (hole + 1) & mask;
+	}
+
+	// Backward shift deletion: pull later members of the probe run into the
+	// hole unless they would end up before their home slot.
+	unsigned int next = hole;
+	while( true ) {
+		next = (next + 1) & mask;
+		if( table[next] == -1 ) {
+			break;
+		}
+		unsigned int home = Hash( cells[ table[next] ].x, cells[ table[next] ].y );
+		bool homeBetween = (hole <= next)
+			? ( (hole < home) && (home <= next) )
+			: ( (hole < home) || (home <= next) );
+		if( homeBetween ) {
+			continue;
+		}
+		table[hole] = table[next];
+		hole = next;
+	}
+	table[hole] = -1;
+
+	cell.active = false;
+	freeCells.push_back( index );
+	numCells--;
+	boundariesDirty = true;
+}
+
+/**\brief Rebuild the hash table at a new size.
+ * \param tableSize The new number of slots.  Must be a power of two.
+ */
+void SpatialHash::Rehash( unsigned int tableSize ) {
+	assert( (tableSize & (tableSize - 1)) == 0 );
+	table.assign( tableSize, -1 );
+	const unsigned int mask = tableSize - 1;
+	for( unsigned int index = 0; index < cells.size(); index++ ) {
+		if( !cells[index].active ) continue;
+		unsigned int slot = Hash( cells[index].x, cells[index].y );
+		while( table[slot] != -1 ) {
+			slot = (slot + 1) & mask;
+		}
+		table[slot] = index;
+	}
+}
+
+/**\brief Put a Sprite into the cell at its position.
+ *  This doesn't do any accounting.
+ */
+void SpatialHash::InsertIntoCell( Sprite *sprite ) {
+	Coordinate pos = sprite->GetWorldPosition();
+	int index = GetCell( CellCoordinate( pos.GetX() ), CellCoordinate( pos.GetY() ) );
+	SpatialHandle& handle = sprite->GetSpatialHandle();
+	handle.cell = index;
+	handle.slot = static_cast<unsigned int>( cells[index].sprites.size() );
+	cells[index].sprites.push_back( sprite );
+}
+
+/**\brief Take a Sprite out of a cell.
+ *  The hole is filled with the last Sprite of the cell.
+ *  This doesn't do any accounting.
+ */
+void SpatialHash::DeleteFromCell( int index, unsigned int slot ) {
+	vector<Sprite*>& sprites = cells[index].sprites;
+	sprites[slot]->GetSpatialHandle() = SpatialHandle();
+	if( slot + 1 < sprites.size() ) {
+		sprites[slot] = sprites.back();
+		sprites[slot]->GetSpatialHandle().slot = slot;
+	}
+	sprites.pop_back();
+	if( sprites.empty() ) {
+		emptyCells.push_back( index );
+	}
+}
+
+/**\brief Add a Sprite to the grid.
+ */
+void SpatialHash::Insert( Sprite *sprite ) {
+	InsertIntoCell( sprite );
+	numSprites++;
+	if( sprite->GetRadarSize() > maxRadarSize ) {
+		maxRadarSize = sprite->GetRadarSize();
+	}
+}
+
+/**\brief Remove a Sprite from the grid.
+ * \details The Sprite may have moved since it was last Updated, so its
+ *          SpatialHandle is used to find the cell rather than its position.
+ */
+bool SpatialHash::Delete( Sprite *sprite ) {
+	SpatialHandle& handle = sprite->GetSpatialHandle();
+	if( handle.cell == -1 ) {
+		return false;
+	}
+	DeleteFromCell( handle.cell, handle.slot );
+	numSprites--;
+	return true;
+}
+
+/**\brief Update the Sprites in the cells that are due.
+ * \param L The Lua State that the Sprites should Update with.
+ * \param filter Selects the cells to update.
+ * \param updated [out] Each Sprite that was Updated is appended.
+ */
+void SpatialHash::Update( lua_State *L, const SpatialUpdateFilter& filter, vector<Sprite*> *updated ) {
+	// Cells created while the Sprites Update wait for the next tick.
+	updatedCells.clear();
+	for( int index = 0; index < static_cast<int>( cells.size() ); index++ ) {
+		if( cells[index].active ) {
+			updatedCells.push_back( index );
+		}
+	}
+
+	// Sprites may Add new Sprites while they Update, which can move the cell
+	// storage, so always go back through the index.
+	vector<int>::iterator cell;
+	vector<int>::iterator kept = updatedCells.begin();
+	for( cell = updatedCells.begin(); cell != updatedCells.end(); ++cell ) {
+		if( !filter.IsDue( CellCenter( cells[*cell] ), cells[*cell].lastUpdate ) ) {
+			continue;
+		}
+		cells[*cell].lastUpdate = filter.GetTick();
+		size_t count = cells[*cell].sprites.size();
+		for( size_t s = 0; s < count; s++ ) {
+			cells[*cell].sprites[s]->Update( L );
+			updated->push_back( cells[*cell].sprites[s] );
+		}
+		*kept++ = *cell;
+	}
+	updatedCells.erase( kept, updatedCells.end() );
+}
+
+/**\brief Move the Sprites that changed cells and reclaim any cells that were
+ *         emptied since the last call.
+ */
+void SpatialHash::ReBallance() {
+	// Collect the Sprites that left their cell
+	vector<int>::iterator cell;
+	moved.clear();
+	for( cell = updatedCells.begin(); cell != updatedCells.end(); ++cell ) {
+		SpatialHashCell& current = cells[*cell];
+		unsigned int s = 0;
+		while( s < current.sprites.size() ) {
+			Sprite* sprite = current.sprites[s];
+			Coordinate pos = sprite->GetWorldPosition();
+			if( sprite->GetRadarSize() > maxRadarSize ) {
+				maxRadarSize = sprite->GetRadarSize();
+			}
+			if( CellCoordinate( pos.GetX() ) != current.x || CellCoordinate( pos.GetY() ) != current.y ) {
+				moved.push_back( sprite );
+				DeleteFromCell( *cell, s );
+			} else {
+				s++;
+			}
+		}
+	}
+
+	// Drop them into their new cells
+	vector<Sprite*>::iterator sprite;
+	for( sprite = moved.begin(); sprite != moved.end(); ++sprite ) {
+		InsertIntoCell( *sprite );
+	}
+	updatedCells.clear();
+
+	for( cell = emptyCells.begin(); cell != emptyCells.end(); ++cell ) {
+		// A cell may be listed twice, or refilled since it was listed.
+		if( cells[*cell].active && cells[*cell].sprites.empty() ) {
+			RemoveCell( *cell );
+		}
+	}
+	emptyCells.clear();
+
+	if( boundariesDirty ) {
+		AdjustBoundaries();
+	}
+}
+
+/**\brief Visit the matching Sprites of one cell that are within a radius.
+ * \see QuadTree::ForEachSpriteNear
+ */
+void SpatialHash::SearchCell( const SpatialHashCell& cell, Coordinate c, float r, int type, SpriteVisitor& visitor ) {
+	vector<Sprite*>::const_iterator i;
+	for( i = cell.sprites.begin(); i != cell.sprites.end(); ++i ) {
+		if( ((*i)->GetDrawOrder() & type) == 0) continue;
+		if( (c - (*i)->GetWorldPosition()).GetMagnitudeSquared() < r*r + (*i)->GetRadarSize()*(*i)->GetRadarSize() ) {
+			visitor.Visit( *i );
+		}
+	}
+}
+
+/**\brief Visit the sprites that are near coordinate.
+ * \param c Coordinate
+ * \param r Radius
+ * \param type A DRAW_ORDER mask of the Sprites to find.
+ * \param visitor Receives each Sprite that was found, in no particular order.
+ */
+void SpatialHash::ForEachSpriteNear( Coordinate c, float r, int type, SpriteVisitor& visitor ) {
+	// A Sprite counts as near when its distance squared is under r*r plus its radar size squared,
+	// so searching out to r plus the largest radar size finds every one of them.
+	const float reach = r + static_cast<float>( maxRadarSize );
+	const int x0 = CellCoordinate( c.GetX() - reach );
+	const int x1 = CellCoordinate( c.GetX() + reach );
+	const int y0 = CellCoordinate( c.GetY() - reach );
+	const int y1 = CellCoordinate( c.GetY() + reach );
+
+	// Huge queries are cheaper to answer by walking the occupied cells.
+	if( double(x1 - x0 + 1) * double(y1 - y0 + 1) > double(numCells) ) {
+		vector<SpatialHashCell>::iterator cell;
+		for( cell = cells.begin(); cell != cells.end(); ++cell ) {
+			if( !cell->active ) continue;
+			if( cell->x < x0 || cell->x > x1 || cell->y < y0 || cell->y > y1 ) continue;
+			SearchCell( *cell, c, r, type, visitor );
+		}
+		return;
+	}
+
+	for( int x = x0; x <= x1; x++ ) {
+		for( int y = y0; y <= y1; y++ ) {
+			int index = FindCell( x, y );
+			if( index != -1 ) {
+				SearchCell( cells[index], c, r, type, visitor );
+			}
+		}
+	}
+}
+
+/**\brief The squared distance from a point to the closest edge of a cell.
+ * \see QuadTree::DistanceSquaredTo
+ */
+double SpatialHash::DistanceSquaredTo( const SpatialHashCell& cell, Coordinate point ) const {
+	double dx = 0, dy = 0;
+	double left = cell.x * cellSize, bottom = cell.y * cellSize;
+	if( point.GetX() < left ) dx = left - point.GetX();
+	else if( point.GetX() > left + cellSize ) dx = point.GetX() - left - cellSize;
+	if( point.GetY() < bottom ) dy = bottom - point.GetY();
+	else if( point.GetY() > bottom + cellSize ) dy = point.GetY() - bottom - cellSize;
+	return dx*dx + dy*dy;
+}
+
+/**\brief Offer every Sprite in one cell to a query.
+ */
+void SpatialHash::OfferCell( int x, int y, NearestQuery& query ) {
+	int index = FindCell( x, y );
+	if( index == -1 ) {
+		return;
+	}
+	const SpatialHashCell& cell = cells[index];
+	if( DistanceSquaredTo( cell, query.GetPoint() ) > query.GetBound() ) {
+		return;
+	}
+	vector<Sprite*>::const_iterator i;
+	for( i = cell.sprites.begin(); i != cell.sprites.end(); ++i ) {
+		query.Offer( *i );
+	}
+}
+
+/**\brief Find the Sprites nearest to a point.
+ * \details Cells are searched in square rings moving out from the point's
+ *          cell.  The search stops as soon as a ring is further away than
+ *          the query's bound.
+ * \see SpatialIndex::GetNearestSprites
+ */
+void SpatialHash::GetNearestSprites( NearestQuery& query ) {
+	Coordinate point = query.GetPoint();
+	const int px = CellCoordinate( point.GetX() );
+	const int py = CellCoordinate( point.GetY() );
+
+	// Every cell in ring k is at least (k-1) cells away from the point.
+	const int maxRing = static_cast<int>( query.GetRadius() / cellSize ) + 1;
+
+	// Huge queries are cheaper to answer by walking the occupied cells.
+	if( double(2*maxRing + 1) * double(2*maxRing + 1) > double(numCells) ) {
+		vector<SpatialHashCell>::iterator cell;
+		for( cell = cells.begin(); cell != cells.end(); ++cell ) {
+			if( !cell->active ) continue;
+			if( DistanceSquaredTo( *cell, point ) > query.GetBound() ) continue;
+			vector<Sprite*>::const_iterator i;
+			for( i = cell->sprites.begin(); i != cell->sprites.end(); ++i ) {
+				query.Offer( *i );
+			}
+		}
+		return;
+	}
+
+	for( int ring = 0; ring <= maxRing; ring++ ) {
+		if( ring > 0 ) {
+			double ringDist = (ring - 1) * cellSize;
+			if( ringDist*ringDist > query.GetBound() ) break;
+		}
+		for( int x = px - ring; x <= px + ring; x++ ) {
+			// The top and bottom rows of the ring (or the single center cell)
+			OfferCell( x, py - ring, query );
+			if( ring == 0 ) continue;
+			OfferCell( x, py + ring, query );
+		}
+		for( int y = py - ring + 1; y <= py + ring - 1; y++ ) {
+			// The left and right columns of the ring
+			OfferCell( px - ring, y, query );
+			OfferCell( px + ring, y, query );
+		}
+	}
+}
+
+/**\brief Get the universe boundaries
+ * \note Returns the values through the pointer arguments.
+ */
+void SpatialHash::GetBoundaries( float *_northEdge, float *_southEdge, float *_eastEdge, float *_westEdge ) {
+	*_northEdge = northEdge;
+	*_southEdge = southEdge;
+	*_eastEdge  = eastEdge;
+	*_westEdge  = westEdge;
+}
+
+/**\brief Adjust the Edges based on the locations of the occupied cells
+ */
+void SpatialHash::AdjustBoundaries() {
+	northEdge = southEdge = eastEdge = westEdge = 0;
+	vector<SpatialHashCell>::iterator cell;
+	for( cell = cells.begin(); cell != cells.end(); ++cell ) {
+		if( !cell->active ) continue;
+		Coordinate c = CellCenter( *cell );
+		if( c.GetY() > northEdge) northEdge = c.GetY();
+		if( c.GetY() < southEdge) southEdge = c.GetY();
+		if( c.GetX() > eastEdge)  eastEdge  = c.GetX();
+		if( c.GetX() < westEdge)  westEdge  = c.GetX();
+	}
+	boundariesDirty = false;
+}
+
+/**\brief Draw the cells around a point.
+ *
+ * (Useful for debugging.)
+ *
+ * \see QuadTree::Draw
+ */
+void SpatialHash::Draw( Coordinate focus ) {
+	// Draw one Quadrant's worth of the grid so that this matches the QuadTree map.
+	float scale = (Video::GetHalfHeight() > Video::GetHalfWidth() ?
+		static_cast<float>(Video::GetHalfWidth()) : static_cast<float>(Video::GetHalfHeight()) -5);
+	float r = scale * (cellSize/2) / QUADRANTSIZE;
+
+	vector<SpatialHashCell>::iterator cell;
+	for( cell = cells.begin(); cell != cells.end(); ++cell ) {
+		if( !cell->active ) continue;
+		Coordinate center = CellCenter( *cell ) - focus;
+		if( fabs(center.GetX()) > QUADRANTSIZE || fabs(center.GetY()) > QUADRANTSIZE ) continue;
+
+		float x = (scale* static_cast<float>(center.GetX()) / QUADRANTSIZE) + static_cast<float>(Video::GetHalfWidth()) -r;
+		float y = (scale* static_cast<float>(center.GetY()) / QUADRANTSIZE) + static_cast<float>(Video::GetHalfHeight()) -r;
+		Video::DrawRect( static_cast<int>(x),static_cast<int>(y),
+			static_cast<int>(2*r),static_cast<int>(2*r), 0,255.f,0.f, .1f);
+
+		vector<Sprite*>::iterator i;
+		for( i = cell->sprites.begin(); i != cell->sprites.end(); ++i ) {
+			Coordinate pos = (*i)->GetWorldPosition() - focus;
+			int posx = static_cast<int>((scale* (float)pos.GetX() / QUADRANTSIZE) + (float)Video::GetHalfWidth());
+			int posy = static_cast<int>((scale* (float)pos.GetY() / QUADRANTSIZE) + (float)Video::GetHalfHeight());
+			Color col = (*i)->GetRadarColor();
+			Video::DrawCircle( posx, posy, static_cast<int>(17.f*(*i)->GetRadarSize()/scale),2, col.r,col.g,col.b );
+		}
+	}
+}
+
+/**\brief Generate an XML Node of every occupied cell.
+ *
+ * (Useful for debugging.)
+ */
+xmlNodePtr SpatialHash::ToNode() {
+	char buff[256];
+	xmlNodePtr thisNode = xmlNewNode(NULL, BAD_CAST "SpatialHash" );
+	snprintf(buff, sizeof(buff), "%d", (int) cellSize );
+	xmlSetProp( thisNode, BAD_CAST "cellsize", BAD_CAST buff );
+
+	vector<SpatialHashCell>::iterator cell;
+	for( cell = cells.begin(); cell != cells.end(); ++cell ) {
+		if( !cell->active ) continue;
+		xmlNodePtr cellNode = xmlNewNode(NULL, BAD_CAST "Cell" );
+		snprintf(buff, sizeof(buff), "%d", cell->x );
+		xmlSetProp( cellNode, BAD_CAST "x", BAD_CAST buff );
+		snprintf(buff, sizeof(buff), "%d", cell->y );
+		xmlSetProp( cellNode, BAD_CAST "y", BAD_CAST buff );
+
+		vector<Sprite*>::iterator i;
+		for( i = cell->sprites.begin(); i != cell->sprites.end(); ++i ) {
+			xmlNodePtr objNode = xmlNewNode(NULL, BAD_CAST "Sprite" );
+			snprintf(buff, sizeof(buff), "%d", (*i)->GetID() );
+			xmlSetProp( objNode, BAD_CAST "id", BAD_CAST buff );
+			snprintf(buff, sizeof(buff), "%d", (*i)->GetDrawOrder() );
+			xmlSetProp( objNode, BAD_CAST "type", BAD_CAST buff );
+			snprintf(buff, sizeof(buff), "%d", (int) (*i)->GetWorldPosition().GetX() );
+			xmlSetProp( objNode, BAD_CAST "x", BAD_CAST buff );
+			snprintf(buff, sizeof(buff), "%d", (int) (*i)->GetWorldPosition().GetY() );
+			xmlSetProp( objNode, BAD_CAST "y", BAD_CAST buff );
+			xmlAddChild( cellNode, objNode );
+		}
+		xmlAddChild( thisNode, cellNode );
+	}
+	return thisNode;
+}
@@ -0,0 +1,82 @@
+/**\file			spatialhash.h
+ * \author			agent (agent@local)
+ * \date			Created: Sunday, October 18, 2026
+ * \date			Modified: Sunday, October 18, 2026
+ * \brief			SpatialIndex built from a uniform hash grid.
+ * \details
+ */
+
+#ifndef __h_spatialhash__
+#define __h_spatialhash__
+
+#include "includes.h"
+#include "Utilities/spatialindex.h"
+
+#define SPATIALHASH_DEFAULT_CELLSIZE 512.0f
+
+/**\brief One occupied square of a SpatialHash.
+ */
+struct SpatialHashCell {
+	int x, y;                ///< The integer grid position of this cell.
+	bool active;             ///< False while this cell is on the free list.
+	Uint32 lastUpdate;       ///< The SpatialUpdateFilter tick when this cell was last Updated, or 0 for never.
+	vector<Sprite*> sprites; ///< The Sprites inside this cell, in no particular order.
+};
+
+class SpatialHash : public SpatialIndex {
+	public:
+		SpatialHash( float cellSize = SPATIALHASH_DEFAULT_CELLSIZE );
+		~SpatialHash();
+
+		void Insert( Sprite *sprite );
+		bool Delete( Sprite *sprite );
+
+		void Update( lua_State *L, const SpatialUpdateFilter& filter, vector<Sprite*> *updated );
+		void ReBallance();
+
+		void ForEachSpriteNear( Coordinate c, float r, int type, SpriteVisitor& visitor );
+		void GetNearestSprites( NearestQuery& query );
+
+		unsigned int Count() { return numSprites; }
+		int GetNumRegions() { return numCells; }
+		void GetBoundaries( float *northEdge, float *southEdge, float *eastEdge, float *westEdge );
+
+		void Draw( Coordinate focus );
+		xmlNodePtr ToNode();
+
+		float GetCellSize() { return cellSize; }
+
+	private:
+		int CellCoordinate( double position ) const;
+		Coordinate CellCenter( const SpatialHashCell& cell ) const;
+		unsigned int Hash( int x, int y ) const;
+
+		int FindCell( int x, int y ) const;
+		int GetCell( int x, int y );
+		void RemoveCell( int index );
+		void Rehash( unsigned int tableSize );
+
+		void InsertIntoCell( Sprite *sprite );
+		void DeleteFromCell( int index, unsigned int slot );
+		void SearchCell( const SpatialHashCell& cell, Coordinate c, float r, int type, SpriteVisitor& visitor );
+		double DistanceSquaredTo( const SpatialHashCell& cell, Coordinate point ) const;
+		void OfferCell( int x, int y, NearestQuery& query );
+		void AdjustBoundaries();
+
+		float cellSize;               ///< The width of each cell.
+		vector<SpatialHashCell> cells;///< Cell storage.  Inactive cells are recycled through freeCells.
+		vector<int> freeCells;        ///< Indexes of inactive cells.
+		vector<int> table;            ///< Open addressed (linear probing) table of cell indexes, -1 when empty.
+		unsigned int numCells;        ///< The number of active cells.
+		unsigned int numSprites;      ///< The number of Sprites in all cells.
+		int maxRadarSize;             ///< The largest radar size ever inserted.  Queries are widened by this much.
+
+		vector<int> updatedCells;     ///< The cells updated this tick.
+		vector<int> emptyCells;       ///< Cells that have become empty and should be reclaimed.
+		vector<Sprite*> moved;        ///< Sprites that left their cell this tick.
+		bool boundariesDirty;         ///< Set when cells are created or reclaimed.
+
+		float northEdge, southEdge, eastEdge, westEdge; ///< The Edges of the universe
+};
+
+#endif // __h_spatialhash__
@@ -0,0 +1,234 @@
+/**\file			spatialindex.cpp
+ * \author			agent (agent@local)
+ * \date			Created: Sunday, October 18, 2026
+ * \date			Modified: Sunday, October 18, 2026
+ * \brief			Common interface for the SpriteManager's spatial indexes.
+ * \details
+ */
+
+#include "includes.h"
+#include "Utilities/spatialindex.h"
+#include "Utilities/timer.h"
+
+/**\brief Create a filter that includes the entire universe.
+ * \details Add tiers and foci to Update the distant universe less often.
+ */
+SpatialUpdateFilter::SpatialUpdateFilter()
+	:tick( 0 )
+	,deadline( 0 )
+	,numDeferred( 0 )
+{
+}
+
+/**\brief Add the next distance tier.
+ * \param bands The furthest band in this tier, or -1 to include every band beyond the previous tier.
+ * \param period The number of ticks between Updates of this tier.
+ * \details Tiers must be added nearest first.  The last tier also covers
+ *          everything beyond its bands.
+ */
+void SpatialUpdateFilter::AddTier( int bands, Uint32 period ) {
+	UpdateTier tier;
+	tier.bands = bands;
+	tier.period = (period < 1) ? 1 : period;
+	tiers.push_back( tier );
+}
+
+/**\brief Begin choosing the regions for a tick.
+ * \param budget The microseconds that may be spent Updating this tick.
+ */
+void SpatialUpdateFilter::StartTick( Uint32 budget ) {
+	if( ++tick == 0 ) tick = 1; // 0 means never
+	deadline = Timer::GetMicroseconds() + budget;
+	numDeferred = 0;
+}
+
+/**\brief Get the band that contains a point.
+ * \param point A position in the universe.
+ * \returns The number of Quadrants between the point's Quadrant and the nearest focus Quadrant.
+ */
+int SpatialUpdateFilter::GetBand( Coordinate point ) const {
+	// Quadrants are tiled adjacent to the central Quadrant centered at (0,0).
+	double quadrantWidth = QUADRANTSIZE * 2.0;
+	double px = floor( (point.GetX()+QUADRANTSIZE) / quadrantWidth );
+	double py = floor( (point.GetY()+QUADRANTSIZE) / quadrantWidth );
+	int nearest = -1;
+	vector<Coordinate>::const_iterator focus;
+	for( focus = foci.begin(); focus != foci.end(); ++focus ) {
+		int dx = static_cast<int>( px - floor( (focus->GetX()+QUADRANTSIZE) / quadrantWidth ) );
+		int dy = static_cast<int>( py - floor( (focus->GetY()+QUADRANTSIZE) / quadrantWidth ) );
+		dx = (dx < 0) ? -dx : dx;
+		dy = (dy < 0) ? -dy : dy;
+		int band = (dx > dy) ? dx : dy;
+		if( nearest == -1 || band < nearest ) {
+			nearest = band;
+		}
+	}
+	return nearest;
+}
+
+/**\brief Get the tier that contains a point.
+ * \returns The index of the tier, or 0 when there are no foci.
+ */
+int SpatialUpdateFilter::GetTier( Coordinate point ) const {
+	if( tiers.empty() ) return 0;
+	int band = GetBand( point );
+	if( band < 0 ) return 0;
+	for( unsigned int t = 0; t + 1 < tiers.size(); t++ ) {
+		if( tiers[t].bands < 0 || band <= tiers[t].bands ) {
+			return t;
+		}
+	}
+	return tiers.size() - 1;
+}
+
+/**\brief Check if a region should be Updated this tick.
+ * \param point The center of the region.
+ * \param lastUpdate The tick when the region was last Updated, or 0 for never.
+ * \details Call this just before Updating the region, so that the time
+ *          already spent this tick is counted against the budget.
+ */
+bool SpatialUpdateFilter::IsDue( Coordinate point, Uint32 lastUpdate ) const {
+	if( IncludesEverything() ) return true;
+	Uint32 elapsed = tick - lastUpdate;
+
+	int tier = GetTier( point );
+	Uint32 period = tiers[tier].period;
+	if( elapsed < period ) return false;
+	if( tier == 0 || elapsed >= period * 2 ) return true;
+
+	if( Timer::GetMicroseconds() >= deadline ) {
+		numDeferred++;
+		return false;
+	}
+	return true;
+}
+
+/**\brief Start a search for the Sprites nearest a point.
+ * \param _point The center of the search.
+ * \param _radius Sprites further than this are ignored.
+ * \param _count The maximum number of Sprites to find.
+ * \param _type A DRAW_ORDER mask of the Sprites to find.
+ * \param _exclude A Sprite to ignore, or NULL.
+ * \param _predicate An extra condition that Sprites must pass, or NULL.
+ */
+NearestQuery::NearestQuery( Coordinate _point, float _radius, unsigned int _count, int _type, Sprite *_exclude, SpritePredicate *_predicate )
+	:point( _point )
+	,radius( _radius )
+	,count( _count )
+	,type( _type )
+	,exclude( _exclude )
+	,predicate( _predicate )
+{
+}
+
+/**\brief The squared distance that a Sprite must be closer than to be accepted.
+ * \details Regions whose closest edge is further than this can be skipped.
+ */
+double NearestQuery::GetBound() const {
+	if( heap.empty() || heap.size() < count ) {
+		return double(radius) * double(radius);
+	}
+	return heap.front().distance;
+}
+
+/**\brief Consider a Sprite for the results.
+ */
+void NearestQuery::Offer( Sprite *sprite ) {
+	if( count == 0 || sprite == exclude || (sprite->GetDrawOrder() & type) == 0 ) {
+		return;
+	}
+
+	Candidate candidate;
+	Coordinate offset = point - sprite->GetWorldPosition();
+	candidate.distance = offset.GetX()*offset.GetX() + offset.GetY()*offset.GetY();
+	candidate.id = sprite->GetID();
+	candidate.sprite = sprite;
+
+	if( candidate.distance >= double(radius) * double(radius) ) {
+		return;
+	}
+	if( heap.size() == count && !(candidate < heap.front()) ) {
+		return;
+	}
+	// Only check the predicate once nothing cheaper has rejected the Sprite
+	if( predicate != NULL && !predicate->Accept( sprite ) ) {
+		return;
+	}
+
+	if( heap.size() == count ) {
+		pop_heap( heap.begin(), heap.end() );
+		heap.pop_back();
+	}
+	heap.push_back( candidate );
+	push_heap( heap.begin(), heap.end() );
+}
+
+/**\brief The furthest Sprite found, which is the only one when count is 1.
+ * \returns The Sprite or NULL if nothing was found.
+ */
+Sprite* NearestQuery::GetFurthest() const {
+	return heap.empty() ? NULL : heap.front().sprite;
+}
+
+/**\brief Get the Sprites that were found.
+ * \details This ends the query; nothing is left in it afterwards.
+ * \param results [out] The Sprites are appended nearest first.
+ */
+void NearestQuery::TakeResults( vector<Sprite*> *results ) {
+	sort_heap( heap.begin(), heap.end() );
+	vector<Candidate>::iterator i;
+	for( i = heap.begin(); i != heap.end(); ++i ) {
+		results->push_back( i->sprite );
+	}
+	heap.clear();
+}
+
+/**\brief Get a Sprite nearest to another Sprite.
+ * \see SpriteManager::GetNearestSprite
+ */
+Sprite* SpatialIndex::GetNearestSprite( Sprite *obj, float r, int type ) {
+	if( obj == NULL )
+		return NULL;
+	NearestQuery query( obj->GetWorldPosition(), r, 1, type, obj );
+	GetNearestSprites( query );
+	return query.GetFurthest();
+}
+
+/**\brief Appends every visited Sprite to a vector.*/
+class CollectingVisitor : public SpriteVisitor {
+	public:
+		CollectingVisitor( vector<Sprite*> *_sprites ) :sprites( _sprites ) {}
+		void Visit( Sprite *sprite ) { sprites->push_back( sprite ); }
+	private:
+		vector<Sprite*> *sprites;
+};
+
+/**\brief Counts the visited Sprites.*/
+class CountingVisitor : public SpriteVisitor {
+	public:
+		CountingVisitor() :count( 0 ) {}
+		void Visit( Sprite *sprite ) { count++; }
+		unsigned int count;
+};
+
+/**\brief Collect the Sprites that are near a coordinate.
+ * \param c Coordinate
+ * \param r Radius
+ * \param nearby [out] The Sprites that were found are appended here, in no
+ *        particular order.
+ * \param type A DRAW_ORDER mask of the Sprites to find.
+ * \see ForEachSpriteNear
+ */
+void SpatialIndex::GetSpritesNear( Coordinate c, float r, vector<Sprite*> *nearby, int type ) {
+	CollectingVisitor collector( nearby );
+	ForEachSpriteNear( c, r, type, collector );
+}
+
+/**\brief Count the Sprites that are near a coordinate.
+ * \see ForEachSpriteNear
+ */
+unsigned int SpatialIndex::CountSpritesNear( Coordinate c, float r, int type ) {
+	CountingVisitor counter;
+	ForEachSpriteNear( c, r, type, counter );
+	return counter.count;
+}
@@ -0,0 +1,182 @@
+/**\file			spatialindex.h
+ * \author			agent (agent@local)
+ * \date			Created: Sunday, October 18, 2026
+ * \date			Modified: Sunday, October 18, 2026
+ * \brief			Common interface for the SpriteManager's spatial indexes.
+ * \details
+ */
+
+#ifndef __h_spatialindex__
+#define __h_spatialindex__
+
+#include "includes.h"
+#include "Sprites/sprite.h"
+#include "Utilities/quadtree.h"
+
+/**\brief How often one distance tier of the universe is Updated.
+ * \see SpatialUpdateFilter
+ */
+struct UpdateTier {
+	int bands;      ///< The furthest band in this tier, or -1 for every band beyond the previous tier.
+	Uint32 period;  ///< The number of ticks between Updates.
+};
+
+/**\class SpatialUpdateFilter
+ * \brief Chooses which parts of the universe are Updated during a tick.
+ *
+ * \details
+ * The universe is measured in bands of Quadrants around the focus points.
+ * Band 0 is the Quadrant containing a focus, band 1 is the ring of Quadrants
+ * surrounding it, and so on.  A region's band is its distance to the closest
+ * focus.  The foci are the camera, the player and any interesting Sprites.
+ *
+ * The bands are grouped into tiers, nearest first.  Each tier has a period,
+ * and a region is due once that many ticks have passed since it was last
+ * Updated.  The first tier is Updated whenever it is due.  The other tiers
+ * share what is left of the tick's time budget; once it is spent, the rest
+ * wait for a later tick.  A region that has waited twice its period is
+ * Updated regardless, so that the budget can't starve the distant universe.
+ *
+ * Each region remembers the tick of its last Update, starting from 0 for
+ * never.  The Sprites themselves make up for the logical frames they skipped.
+ *
+ * A filter without any tiers includes everything, every tick.
+ *
+ * \see Sprite::Update
+ */
+class SpatialUpdateFilter {
+	public:
+		SpatialUpdateFilter();
+
+		void AddTier( int bands, Uint32 period );
+		void ClearFoci() { foci.clear(); }
+		void AddFocus( Coordinate focus ) { foci.push_back( focus ); }
+		void StartTick( Uint32 budget );
+
+		bool IncludesEverything() const { return tiers.empty() || foci.empty(); }
+		Uint32 GetTick() const { return tick; }
+		unsigned int GetNumDeferred() const { return numDeferred; }
+
+		int GetBand( Coordinate point ) const;
+		int GetTier( Coordinate point ) const;
+		bool IsDue( Coordinate point, Uint32 lastUpdate ) const;
+
+	private:
+		vector<UpdateTier> tiers;   ///< The distance tiers, nearest first.
+		vector<Coordinate> foci;    ///< The points that the bands are measured from.
+		Uint32 tick;                ///< Counts the ticks started by this filter.  Regions remember the tick of their last Update.
+		Uint64 deadline;            ///< When the time budget for this tick runs out, in microseconds.
+		mutable unsigned int numDeferred; ///< Regions that were due this tick but did not fit in the budget.
+};
+
+/**\class SpriteVisitor
+ * \brief Receives each Sprite found by a location query.
+ * \details The Sprites are visited in no particular order.  A visitor must
+ *          not Add or Delete Sprites while it is being visited.
+ */
+class SpriteVisitor {
+	public:
+		virtual ~SpriteVisitor() {}
+		virtual void Visit( Sprite *sprite ) = 0;
+};
+
+/**\class SpritePredicate
+ * \brief An extra condition on the Sprites accepted by a NearestQuery.
+ */
+class SpritePredicate {
+	public:
+		virtual ~SpritePredicate() {}
+		virtual bool Accept( Sprite *sprite ) = 0;
+};
+
+/**\class NearestQuery
+ * \brief Collects the Sprites nearest to a point.
+ *
+ * \details
+ * A SpatialIndex visits its regions nearest first and Offers every Sprite in
+ * them to the query.  The query keeps the best Sprites in a bounded heap with
+ * the furthest of them on top.  Once the heap is full, that furthest Sprite
+ * bounds the search: any region further away than it can be skipped.
+ *
+ * Sprites are only accepted when they are within the radius, match the type
+ * mask, are not the excluded Sprite and pass the predicate (if there is one).
+ * Ties in distance are broken by Sprite ID so that every index returns the
+ * same answer.
+ */
+class NearestQuery {
+	public:
+		NearestQuery( Coordinate point, float radius, unsigned int count = 1, int type = DRAW_ORDER_ALL, Sprite *exclude = NULL, SpritePredicate *predicate = NULL );
+
+		Coordinate GetPoint() const { return point; }
+		float GetRadius() const { return radius; }
+		int GetType() const { return type; }
+		double GetBound() const;
+
+		void Offer( Sprite *sprite );
+
+		unsigned int GetNumFound() const { return heap.size(); }
+		Sprite* GetFurthest() const;
+		void TakeResults( vector<Sprite*> *results );
+
+	private:
+		/// A Sprite found by the query and its squared distance from the point.
+		struct Candidate {
+			double distance;
+			int id;
+			Sprite *sprite;
+			bool operator<( const Candidate& other ) const {
+				return (distance != other.distance) ? (distance < other.distance) : (id < other.id);
+			}
+		};
+
+		Coordinate point;           ///< The center of the search.
+		float radius;               ///< Sprites further than this are ignored.
+		unsigned int count;         ///< The maximum number of Sprites to find.
+		int type;                   ///< A DRAW_ORDER mask of the Sprites to find.
+		Sprite *exclude;            ///< A Sprite to ignore, usually the one searching.
+		SpritePredicate *predicate; ///< An optional extra condition.
+		vector<Candidate> heap;     ///< The best Sprites so far, furthest on top.
+};
+
+/**\class SpatialIndex
+ * \brief Stores Sprites by their position in the universe.
+ *
+ * \details
+ * The SpriteManager keeps every Sprite in exactly one SpatialIndex.  The
+ * index answers location queries and drives the per-tick Update of the
+ * Sprites in the regions selected by a SpatialUpdateFilter.  The Sprites
+ * are moved after the index's Update, so the index moves them between its
+ * regions during the ReBallance.
+ *
+ * \see QuadrantIndex
+ * \see SpatialHash
+ */
+class SpatialIndex {
+	public:
+		virtual ~SpatialIndex() {}
+
+		virtual void Insert( Sprite *sprite ) = 0;
+		virtual bool Delete( Sprite *sprite ) = 0;
+
+		/// Run Update(L) on the Sprites in the regions that are due, and list them for their native Update.
+		virtual void Update( lua_State *L, const SpatialUpdateFilter& filter, vector<Sprite*> *updated ) = 0;
+		/// Move the Sprites that left their regions, reorganize the regions touched since the last Update and reclaim empty ones.
+		virtual void ReBallance() = 0;
+
+		/// Visit every Sprite of a type whose squared distance from c is less than r squared plus its radar size squared.
+		virtual void ForEachSpriteNear( Coordinate c, float r, int type, SpriteVisitor& visitor ) = 0;
+		void GetSpritesNear( Coordinate c, float r, vector<Sprite*> *nearby, int type = DRAW_ORDER_ALL );
+		unsigned int CountSpritesNear( Coordinate c, float r, int type = DRAW_ORDER_ALL );
+		/// Offer Sprites to the query, nearest regions first, until nothing closer can be found.
+		virtual void GetNearestSprites( NearestQuery& query ) = 0;
+		Sprite* GetNearestSprite( Sprite *obj, float r, int type = DRAW_ORDER_ALL );
+
+		virtual unsigned int Count() = 0;
+		virtual int GetNumRegions() = 0;
+		virtual void GetBoundaries( float *northEdge, float *southEdge, float *eastEdge, float *westEdge ) = 0;
+
+		virtual void Draw( Coordinate focus ) = 0;
+		virtual xmlNodePtr ToNode() = 0;
+};
+
+#endif // __h_spatialindex__
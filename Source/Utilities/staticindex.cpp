@@ -0,0 +1,293 @@
+/**\file			staticindex.cpp
+ * \author			agent (agent@local)
+ * \date			Created: Sunday, October 18, 2026
+ * \date			Modified: Sunday, October 18, 2026
+ * \brief			SpatialIndex for Sprites that do not move.
+ * \details
+ */
+
+#include "includes.h"
+#include "Utilities/log.h"
+#include "Utilities/staticindex.h"
+#include "Graphics/video.h"
+
+/**\class StaticIndex
+ * \brief A SpatialIndex for Planets, Gates and anything else that stays put.
+ *
+ * \details
+ * The Sprites are packed into one vector arranged as a balanced KD-tree: the
+ * median of every range splits it in half, alternating between the x and the
+ * y axis at each level.  There are no nodes or pointers, so the tree is
+ * built with nth_element and searched by halving index ranges.
+ *
+ * The tree is only rebuilt when it is dirty, which happens when a Sprite is
+ * Inserted, Deleted or found to have moved.  In a running game that is once,
+ * after the Planets and Gates are loaded.  Until then every query rebuilds
+ * the tree first, so the index is always correct.
+ *
+ * The Sprites here still need their Update, since Planets create traffic
+ * and Gates send Ships away, but they never have to be moved between regions.
+ *
+ * \see SpriteManager
+ */
+
+/**\brief Orders StaticEntries along the x axis.*/
+static bool compareEntriesX( const StaticEntry& a, const StaticEntry& b ) {
+	return a.x < b.x;
+}
+
+/**\brief Orders StaticEntries along the y axis.*/
+static bool compareEntriesY( const StaticEntry& a, const StaticEntry& b ) {
+	return a.y < b.y;
+}
+
+/**\brief Create an empty StaticIndex.
+ */
+StaticIndex::StaticIndex()
+	:maxRadarSize( 0 )
+	,dirty( false )
+	,northEdge( 0 )
+	,southEdge( 0 )
+	,eastEdge( 0 )
+	,westEdge( 0 )
+{
+}
+
+/**\brief Destroy a StaticIndex.
+ * \details The Sprites are not deleted.
+ */
+StaticIndex::~StaticIndex() {
+}
+
+/**\brief Add a Sprite.  The tree is rebuilt before it is next searched.
+ */
+void StaticIndex::Insert( Sprite *sprite ) {
+	sprites.push_back( sprite );
+	lastUpdates.push_back( 0 );
+	dirty = true;
+}
+
+/**\brief Remove a Sprite.  The tree is rebuilt before it is next searched.
+ * \returns False if the Sprite was not in this index.
+ */
+bool StaticIndex::Delete( Sprite *sprite ) {
+	vector<Sprite*>::iterator found = find( sprites.begin(), sprites.end(), sprite );
+	if( found == sprites.end() ) {
+		LogMsg(WARN, "Sprite %d is not in the StaticIndex.", sprite->GetID() );
+		return false;
+	}
+	size_t slot = found - sprites.begin();
+	sprites[slot] = sprites.back();
+	sprites.pop_back();
+	lastUpdates[slot] = lastUpdates.back();
+	lastUpdates.pop_back();
+	dirty = true;
+	return true;
+}
+
+/**\brief Update the Sprites that are due.
+ * \param updated [out] Each Sprite that was Updated is appended.
+ */
+void StaticIndex::Update( lua_State *L, const SpatialUpdateFilter& filter, vector<Sprite*> *updated ) {
+	// Updates may Add Sprites, so always go back through the vector.
+	size_t count = sprites.size();
+	for( size_t s = 0; s < count; s++ ) {
+		if( filter.IsDue( sprites[s]->GetWorldPosition(), lastUpdates[s] ) ) {
+			lastUpdates[s] = filter.GetTick();
+			sprites[s]->Update( L );
+			updated->push_back( sprites[s] );
+		}
+	}
+}
+
+/**\brief Rebuild the tree if anything has changed.
+ * \details Any Sprite that has moved since the tree was built marks the tree
+ *          dirty.
+ */
+void StaticIndex::ReBallance() {
+	if( !dirty ) {
+		vector<StaticEntry>::iterator entry;
+		for( entry = tree.begin(); entry != tree.end(); ++entry ) {
+			Coordinate pos = entry->sprite->GetWorldPosition();
+			if( pos.GetX() != entry->x || pos.GetY() != entry->y ) {
+				dirty = true;
+				break;
+			}
+		}
+	}
+	if( dirty ) {
+		Build();
+	}
+}
+
+/**\brief Pack every Sprite into the tree and find the edges of the universe.
+ */
+void StaticIndex::Build() {
+	tree.clear();
+	maxRadarSize = 0;
+	northEdge = southEdge = eastEdge = westEdge = 0;
+
+	vector<Sprite*>::iterator i;
+	for( i = sprites.begin(); i != sprites.end(); ++i ) {
+		StaticEntry entry;
+		Coordinate pos = (*i)->GetWorldPosition();
+		entry.x = pos.GetX();
+		entry.y = pos.GetY();
+		entry.drawOrder = (*i)->GetDrawOrder();
+		entry.radarSize = (*i)->GetRadarSize();
+		entry.sprite = *i;
+		tree.push_back( entry );
+
+		if( entry.radarSize > maxRadarSize ) maxRadarSize = entry.radarSize;
+		if( entry.y > northEdge ) northEdge = TO_FLOAT( entry.y );
+		if( entry.y < southEdge ) southEdge = TO_FLOAT( entry.y );
+		if( entry.x > eastEdge )  eastEdge  = TO_FLOAT( entry.x );
+		if( entry.x < westEdge )  westEdge  = TO_FLOAT( entry.x );
+	}
+
+	BuildRange( 0, tree.size(), 0 );
+	dirty = false;
+}
+
+/**\brief Arrange a range of the tree around its median.
+ * \param low The first entry in the range.
+ * \param high One past the last entry in the range.
+ * \param axis 0 to split along x, 1 to split along y.
+ */
+void StaticIndex::BuildRange( size_t low, size_t high, int axis ) {
+	if( high - low < 2 ) return;
+	size_t middle = low + (high - low) / 2;
+	nth_element( tree.begin() + low, tree.begin() + middle, tree.begin() + high,
+		axis == 0 ? compareEntriesX : compareEntriesY );
+	BuildRange( low, middle, 1 - axis );
+	BuildRange( middle + 1, high, 1 - axis );
+}
+
+/**\brief Visit the sprites that are near coordinate.
+ * \param c Coordinate
+ * \param r Radius
+ * \param type A DRAW_ORDER mask of the Sprites to find.
+ * \param visitor Receives each Sprite that was found, in no particular order.
+ */
+void StaticIndex::ForEachSpriteNear( Coordinate c, float r, int type, SpriteVisitor& visitor ) {
+	if( dirty ) Build();
+	// A Sprite counts as near when its distance squared is under r*r plus its radar size squared,
+	// so searching out to r plus the largest radar size finds every one of them.
+	SearchRange( 0, tree.size(), 0, c, r, r + static_cast<float>( maxRadarSize ), type, visitor );
+}
+
+/**\brief Visit the matching Sprites in one range of the tree.
+ * \param reach Ranges further than this along the splitting axis are skipped.
+ */
+void StaticIndex::SearchRange( size_t low, size_t high, int axis, Coordinate c, float r, float reach, int type, SpriteVisitor& visitor ) {
+	if( low >= high ) return;
+	size_t middle = low + (high - low) / 2;
+	const StaticEntry& entry = tree[middle];
+
+	if( entry.drawOrder & type ) {
+		double dx = c.GetX() - entry.x;
+		double dy = c.GetY() - entry.y;
+		if( dx*dx + dy*dy < r*r + entry.radarSize*entry.radarSize ) {
+			visitor.Visit( entry.sprite );
+		}
+	}
+
+	// The lower half is never greater than the median, the upper half never less.
+	double offset = (axis == 0) ? (c.GetX() - entry.x) : (c.GetY() - entry.y);
+	if( offset <= reach ) {
+		SearchRange( low, middle, 1 - axis, c, r, reach, type, visitor );
+	}
+	if( offset >= -reach ) {
+		SearchRange( middle + 1, high, 1 - axis, c, r, reach, type, visitor );
+	}
+}
+
+/**\brief Offer Sprites to the query, the half containing its point first.
+ * \see SpatialIndex::GetNearestSprites
+ */
+void StaticIndex::GetNearestSprites( NearestQuery& query ) {
+	if( dirty ) Build();
+	NearestRange( 0, tree.size(), 0, query );
+}
+
+/**\brief Offer the Sprites in one range of the tree to the query.
+ * \details The far half is only searched when the splitting line is closer
+ *          than the furthest Sprite that the query would still accept.
+ */
+void StaticIndex::NearestRange( size_t low, size_t high, int axis, NearestQuery& query ) {
+	if( low >= high ) return;
+	size_t middle = low + (high - low) / 2;
+	const StaticEntry& entry = tree[middle];
+
+	query.Offer( entry.sprite );
+
+	Coordinate point = query.GetPoint();
+	double offset = (axis == 0) ? (point.GetX() - entry.x) : (point.GetY() - entry.y);
+	if( offset < 0 ) {
+		NearestRange( low, middle, 1 - axis, query );
+		if( offset*offset <= query.GetBound() ) {
+			NearestRange( middle + 1, high, 1 - axis, query );
+		}
+	} else {
+		NearestRange( middle + 1, high, 1 - axis, query );
+		if( offset*offset <= query.GetBound() ) {
+			NearestRange( low, middle, 1 - axis, query );
+		}
+	}
+}
+
+/**\brief Get the universe boundaries
+ * \note Returns the values through the pointer arguments.
+ */
+void StaticIndex::GetBoundaries( float *_northEdge, float *_southEdge, float *_eastEdge, float *_westEdge ) {
+	if( dirty ) Build();
+	*_northEdge = northEdge;
+	*_southEdge = southEdge;
+	*_eastEdge  = eastEdge;
+	*_westEdge  = westEdge;
+}
+
+/**\brief Draw the Sprites around a point.
+ *
+ * (Useful for debugging.)
+ *
+ * \see SpatialHash::Draw
+ */
+void StaticIndex::Draw( Coordinate focus ) {
+	float scale = (Video::GetHalfHeight() > Video::GetHalfWidth() ?
+		static_cast<float>(Video::GetHalfWidth()) : static_cast<float>(Video::GetHalfHeight()) -5);
+
+	vector<Sprite*>::iterator i;
+	for( i = sprites.begin(); i != sprites.end(); ++i ) {
+		Coordinate pos = (*i)->GetWorldPosition() - focus;
+		if( fabs(pos.GetX()) > QUADRANTSIZE || fabs(pos.GetY()) > QUADRANTSIZE ) continue;
+		int posx = static_cast<int>((scale* (float)pos.GetX() / QUADRANTSIZE) + (float)Video::GetHalfWidth());
+		int posy = static_cast<int>((scale* (float)pos.GetY() / QUADRANTSIZE) + (float)Video::GetHalfHeight());
+		Color col = (*i)->GetRadarColor();
+		Video::DrawCircle( posx, posy, static_cast<int>(17.f*(*i)->GetRadarSize()/scale),2, col.r,col.g,col.b );
+	}
+}
+
+/**\brief Generate an XML Node of every Sprite.
+ *
+ * (Useful for debugging.)
+ */
+xmlNodePtr StaticIndex::ToNode() {
+	char buff[256];
+	xmlNodePtr thisNode = xmlNewNode(NULL, BAD_CAST "StaticIndex" );
+
+	vector<Sprite*>::iterator i;
+	for( i = sprites.begin(); i != sprites.end(); ++i ) {
+		xmlNodePtr objNode = xmlNewNode(NULL, BAD_CAST "Sprite" );
+		snprintf(buff, sizeof(buff), "%d", (*i)->GetID() );
+		xmlSetProp( objNode, BAD_CAST "id", BAD_CAST buff );
+		snprintf(buff, sizeof(buff), "%d", (*i)->GetDrawOrder() );
+		xmlSetProp( objNode, BAD_CAST "type", BAD_CAST buff );
+		snprintf(buff, sizeof(buff), "%d", (int) (*i)->GetWorldPosition().GetX() );
+		xmlSetProp( objNode, BAD_CAST "x", BAD_CAST buff );
+		snprintf(buff, sizeof(buff), "%d", (int) (*i)->GetWorldPosition().GetY() );
+		xmlSetProp( objNode, BAD_CAST "y", BAD_CAST buff );
+		xmlAddChild( thisNode, objNode );
+	}
+	return thisNode;
+}
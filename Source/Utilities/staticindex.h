@@ -0,0 +1,62 @@
+/**\file			staticindex.h
+ * \author			agent (agent@local)
+ * \date			Created: Sunday, October 18, 2026
+ * \date			Modified: Sunday, October 18, 2026
+ * \brief			SpatialIndex for Sprites that do not move.
+ * \details
+ */
+
+#ifndef __h_staticindex__
+#define __h_staticindex__
+
+#include "includes.h"
+#include "Utilities/spatialindex.h"
+
+/**\brief One Sprite stored in a StaticIndex.
+ * \details The position and type are copied so that searching the tree
+ *          does not need to touch the Sprites themselves.
+ */
+struct StaticEntry {
+	double x, y;     ///< The position of the Sprite when the tree was built.
+	int drawOrder;   ///< The DRAW_ORDER of the Sprite.
+	int radarSize;   ///< The radar size of the Sprite.
+	Sprite *sprite;  ///< The Sprite.
+};
+
+class StaticIndex : public SpatialIndex {
+	public:
+		StaticIndex();
+		~StaticIndex();
+
+		void Insert( Sprite *sprite );
+		bool Delete( Sprite *sprite );
+
+		void Update( lua_State *L, const SpatialUpdateFilter& filter, vector<Sprite*> *updated );
+		void ReBallance();
+
+		void ForEachSpriteNear( Coordinate c, float r, int type, SpriteVisitor& visitor );
+		void GetNearestSprites( NearestQuery& query );
+
+		unsigned int Count() { return sprites.size(); }
+		int GetNumRegions() { return tree.size(); }
+		void GetBoundaries( float *northEdge, float *southEdge, float *eastEdge, float *westEdge );
+
+		void Draw( Coordinate focus );
+		xmlNodePtr ToNode();
+
+	private:
+		void Build();
+		void BuildRange( size_t low, size_t high, int axis );
+		void SearchRange( size_t low, size_t high, int axis, Coordinate c, float r, float reach, int type, SpriteVisitor& visitor );
+		void NearestRange( size_t low, size_t high, int axis, NearestQuery& query );
+
+		vector<Sprite*> sprites;    ///< Every Sprite in the index, in no particular order.
+		vector<Uint32> lastUpdates; ///< The SpatialUpdateFilter tick when each Sprite was last Updated, or 0 for never.
+		vector<StaticEntry> tree;   ///< A balanced KD-tree.  The median of each range is its root.
+		int maxRadarSize;           ///< The largest radar size in the tree.  Searches are widened by this much.
+		bool dirty;                 ///< Set when the tree no longer matches the Sprites.
+
+		float northEdge, southEdge, eastEdge, westEdge; ///< The Edges of the universe
+};
+
+#endif // __h_staticindex__
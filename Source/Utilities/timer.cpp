@@ -10,6 +10,12 @@
 #include "common.h"
 #include "Utilities/timer.h"
 
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+
 /**\class Timer
  * \brief Timer class. */
 
@@ -43,6 +49,17 @@ int Timer::Update( void ) {
 	return i;
 }
 
+/**\brief Advance the game clock by exactly one logical frame.
+ * \details This replaces Update when the Simulation runs without real time,
+ *          so that every tick covers the same amount of game time no matter
+ *          how quickly it was computed.
+ */
+void Timer::Step( void ) {
+	lastLoopLength = static_cast<Uint32>( 1000.0 / Timer::logicFPS );
+	lastLoopTick += lastLoopLength;
+	virtualTime += 1.0;
+}
+
 Uint32 Timer::GetTicks( void )
 {
 	return( lastLoopTick );
@@ -58,6 +75,25 @@ Uint32 Timer::GetRealTicks( void )
 	return SDL_GetTicks();
 }
 
+/** \brief Get a high resolution real-time clock.
+ *  \details Only the difference between two calls is meaningful.  Use this
+ *  to measure how long something took; SDL_GetTicks is too coarse for that.
+ */
+Uint64 Timer::GetMicroseconds( void )
+{
+#ifdef _WIN32
+	LARGE_INTEGER frequency, counter;
+	QueryPerformanceFrequency( &frequency );
+	QueryPerformanceCounter( &counter );
+	return static_cast<Uint64>( counter.QuadPart / frequency.QuadPart ) * 1000000
+		+ static_cast<Uint64>( counter.QuadPart % frequency.QuadPart ) * 1000000 / frequency.QuadPart;
+#else
+	struct timeval now;
+	gettimeofday( &now, NULL );
+	return static_cast<Uint64>( now.tv_sec ) * 1000000 + now.tv_usec;
+#endif
+}
+
 void Timer::Delay( int waitMS ) {
 //#ifdef EPIAR_CAP_FRAME
 //	Uint32 ticksElapsed = SDL_GetTicks() - lastLoopTick;
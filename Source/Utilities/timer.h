@@ -17,9 +17,11 @@ class Timer {
 	public:
 		static void Initialize( void );
 		static int Update( void );
+		static void Step( void );
 		static void Delay( int waitMS );
 		static Uint32 GetTicks( void );
 		static Uint32 GetRealTicks( void );
+		static Uint64 GetMicroseconds( void );
 		
 		static float GetDelta( void );
 
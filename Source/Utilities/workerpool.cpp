@@ -0,0 +1,151 @@
+/**\file			workerpool.cpp
+ * \author			agent (agent@local)
+ * \date			Created: Sunday, October 18, 2026
+ * \date			Modified: Sunday, October 18, 2026
+ * \brief			Runs a task over a range of items on several threads.
+ * \details
+ */
+
+#include "includes.h"
+#include "Utilities/log.h"
+#include "Utilities/workerpool.h"
+
+/**\class WorkerPool
+ * \brief A fixed set of threads that share the items of a task.
+ *
+ * \details
+ * The items are handed out in chunks.  Every worker, including the thread
+ * that called Run, keeps claiming the next unclaimed chunk until none are
+ * left, so a worker that finishes early takes over the chunks that a busy
+ * one hasn't reached.  Run returns once every item has been processed.
+ *
+ * The threads sleep between tasks.  A task too small to fill more than one
+ * chunk is Run directly on the calling thread without waking them.
+ *
+ * \see SpriteManager::Update
+ */
+
+/**\brief Start the threads.
+ * \param numThreads The number of threads to start.  0 Runs every task on the calling thread.
+ */
+WorkerPool::WorkerPool( unsigned int numThreads )
+	:task( NULL )
+	,count( 0 )
+	,chunkSize( 1 )
+	,nextItem( 0 )
+	,generation( 0 )
+	,working( 0 )
+	,quit( false )
+{
+	lock = SDL_CreateMutex();
+	wake = SDL_CreateCond();
+	done = SDL_CreateCond();
+
+	// The threads keep pointers into the vector, so it must not grow after this.
+	threads.resize( numThreads );
+	for( unsigned int t = 0; t < numThreads; t++ ) {
+		threads[t].pool = this;
+		threads[t].worker = t + 1;
+		threads[t].thread = SDL_CreateThread( ThreadMain, &threads[t] );
+		if( threads[t].thread == NULL ) {
+			LogMsg(ERR, "Could not start worker thread %u: %s", t + 1, SDL_GetError() );
+			threads.resize( t );
+			break;
+		}
+	}
+}
+
+/**\brief Stop the threads.
+ */
+WorkerPool::~WorkerPool() {
+	SDL_mutexP( lock );
+	quit = true;
+	SDL_CondBroadcast( wake );
+	SDL_mutexV( lock );
+
+	vector<WorkerThread>::iterator t;
+	for( t = threads.begin(); t != threads.end(); ++t ) {
+		SDL_WaitThread( t->thread, NULL );
+	}
+
+	SDL_DestroyCond( done );
+	SDL_DestroyCond( wake );
+	SDL_DestroyMutex( lock );
+}
+
+/**\brief Process every item of a task.
+ * \param _task The work to do.
+ * \param _count The number of items.
+ * \param _chunkSize The number of items handed to a worker at a time.
+ */
+void WorkerPool::Run( WorkerTask *_task, unsigned int _count, unsigned int _chunkSize ) {
+	if( _chunkSize < 1 ) _chunkSize = 1;
+	if( threads.empty() || _count <= _chunkSize ) {
+		_task->Run( 0, _count, 0 );
+		return;
+	}
+
+	SDL_mutexP( lock );
+	task = _task;
+	count = _count;
+	chunkSize = _chunkSize;
+	nextItem = 0;
+	working = threads.size();
+	generation++;
+	SDL_CondBroadcast( wake );
+	SDL_mutexV( lock );
+
+	Work( 0 );
+
+	SDL_mutexP( lock );
+	while( working > 0 ) {
+		SDL_CondWait( done, lock );
+	}
+	task = NULL;
+	SDL_mutexV( lock );
+}
+
+/**\brief Claim and process chunks until there are none left.
+ * \param worker The number passed to WorkerTask::Run.
+ */
+void WorkerPool::Work( unsigned int worker ) {
+	for(;;) {
+		SDL_mutexP( lock );
+		unsigned int begin = nextItem;
+		unsigned int end = (count - begin > chunkSize) ? begin + chunkSize : count;
+		nextItem = end;
+		SDL_mutexV( lock );
+
+		if( begin >= end ) return;
+		task->Run( begin, end, worker );
+	}
+}
+
+/**\brief The loop run by each thread.
+ * \param data The WorkerThread.
+ */
+int WorkerPool::ThreadMain( void *data ) {
+	WorkerThread *self = static_cast<WorkerThread*>( data );
+	WorkerPool *pool = self->pool;
+	unsigned int seen = 0;
+
+	SDL_mutexP( pool->lock );
+	for(;;) {
+		while( !pool->quit && pool->generation == seen ) {
+			SDL_CondWait( pool->wake, pool->lock );
+		}
+		if( pool->quit ) break;
+		seen = pool->generation;
+
+		SDL_mutexV( pool->lock );
+		pool->Work( self->worker );
+		SDL_mutexP( pool->lock );
+
+		pool->working--;
+		if( pool->working == 0 ) {
+			SDL_CondSignal( pool->done );
+		}
+	}
+	SDL_mutexV( pool->lock );
+	return 0;
+}
@@ -0,0 +1,65 @@
+/**\file			workerpool.h
+ * \author			agent (agent@local)
+ * \date			Created: Sunday, October 18, 2026
+ * \date			Modified: Sunday, October 18, 2026
+ * \brief			Runs a task over a range of items on several threads.
+ * \details
+ */
+
+#ifndef __h_workerpool__
+#define __h_workerpool__
+
+#include "includes.h"
+
+/**\class WorkerTask
+ * \brief The work done by a WorkerPool.
+ * \details Run is called from several threads at once, each time with a
+ *          different range of items.  It must not touch anything that
+ *          another item's Run could be changing.
+ */
+class WorkerTask {
+	public:
+		virtual ~WorkerTask() {}
+		/// Process the items from begin up to (but not including) end.  The calling thread is worker 0.
+		virtual void Run( unsigned int begin, unsigned int end, unsigned int worker ) = 0;
+};
+
+class WorkerPool;
+
+/**\brief One thread of a WorkerPool.
+ */
+struct WorkerThread {
+	WorkerPool *pool;     ///< The pool that owns this thread.
+	unsigned int worker;  ///< The number passed to WorkerTask::Run.
+	SDL_Thread *thread;   ///< The SDL thread.
+};
+
+class WorkerPool {
+	public:
+		WorkerPool( unsigned int numThreads );
+		~WorkerPool();
+
+		/// The number of threads that Run a task, counting the calling thread.
+		unsigned int GetNumWorkers() const { return threads.size() + 1; }
+
+		void Run( WorkerTask *task, unsigned int count, unsigned int chunkSize );
+
+	private:
+		static int ThreadMain( void *data );
+		void Work( unsigned int worker );
+
+		vector<WorkerThread> threads; ///< The threads started for this pool.
+		SDL_mutex *lock;              ///< Guards everything below.
+		SDL_cond *wake;               ///< Signalled when there is a new task, or the pool is closing.
+		SDL_cond *done;               ///< Signalled when the last thread has finished the task.
+
+		WorkerTask *task;             ///< The task being Run, or NULL.
+		unsigned int count;           ///< The number of items in the task.
+		unsigned int chunkSize;       ///< The number of items claimed at a time.
+		unsigned int nextItem;        ///< The first item that nobody has claimed yet.
+		unsigned int generation;      ///< Counts the tasks, so that threads can tell a new one from the last.
+		unsigned int working;         ///< The threads that haven't finished the task yet.
+		bool quit;                    ///< Set when the threads should exit.
+};
+
+#endif // __h_workerpool__
@@ -21,6 +21,7 @@
 #include "Utilities/filesystem.h"
 #include "Utilities/log.h"
 #include "Utilities/lua.h"
+#include "Utilities/scriptprofiler.h"
 #include "Utilities/xml.h"
 #include "Utilities/timer.h"
 
@@ -33,6 +34,9 @@ XMLFile *skinfile = NULL;
 // main font used throughout the game
 Font *SansSerif = NULL, *BitType = NULL, *Serif = NULL, *Mono = NULL;
 ArgParser *argparser = NULL;
+// when set, the simulation is run this many ticks without a display
+Uint32 headlessTicks = 0;
+string headlessSimulation = "default";
 
 void Main_OS                ( int argc, char **argv ); ///< Run OS Specific setup code
 void Main_Load_Settings     (); ///< Load the settings files
@@ -40,6 +44,7 @@ void Main_Init_Singletons   (); ///< Initialize global Singletons
 void Main_Parse_Args        ( int argc, char **argv ); ///< Parse Command Line Arguments
 void Main_Log_Environment   ( void ); ///< Record Environment variables
 void Main_Close_Singletons  ( void ); ///< Close global Singletons
+int  Main_Headless          ( void ); ///< Benchmark the Simulation without a display
 
 /**Main
  * \return 0 always
@@ -59,6 +64,11 @@ int main( int argc, char **argv ) {
 	Main_Parse_Args( argc, argv );
 	Main_Log_Environment();
 
+	// Benchmark the Simulation instead
+	if( headlessTicks > 0 ) {
+		return Main_Headless();
+	}
+
 	// THE GAME
 	Main_Init_Singletons();
 	Menu::Main_Menu();
@@ -147,6 +157,20 @@ void Main_Load_Settings() {
 	Options::AddDefault( "options/simulation/automatic-load", 0 );
 	Options::AddDefault( "options/simulation/random-universe", 0 );
 	Options::AddDefault( "options/simulation/random-seed", 0 );
+	Options::AddDefault( "options/simulation/spatial-index", "quadtree" ); // "quadtree" or "hash"
+	Options::AddDefault( "options/simulation/spatial-hash-cellsize", 512.0f );
+	Options::AddDefault( "options/simulation/lod", 1 ); // 0 updates everything every tick
+	Options::AddDefault( "options/simulation/lod-budget", 5000 ); // microseconds per tick for the middle and distant tiers
+	Options::AddDefault( "options/simulation/lod-near-bands", 1 ); // updated every tick
+	Options::AddDefault( "options/simulation/lod-middle-bands", 3 );
+	Options::AddDefault( "options/simulation/lod-middle-period", 4 );
+	Options::AddDefault( "options/simulation/lod-far-bands", 6 );
+	Options::AddDefault( "options/simulation/lod-far-period", 15 );
+	Options::AddDefault( "options/simulation/lod-distant-period", 60 );
+	Options::AddDefault( "options/simulation/update-threads", 2 ); // worker threads for moving Sprites, 0 for none
+	Options::AddDefault( "options/simulation/ai-think-interval", 1 ); // ticks between AI decisions in states without a ThinkIntervals entry
+	Options::AddDefault( "options/simulation/ai-think-budget", 4000 ); // microseconds per tick for AI decisions, 0 for no limit
+	Options::AddDefault( "options/simulation/ai-batch", 1 ); // decide AI states that have a Batch version with one Lua call per State Machine
 
 	// Timing
 	Options::AddDefault( "options/timing/screen-swap", 0 ); // FIXME, 0=disabled until the transition is better
@@ -159,6 +183,10 @@ void Main_Load_Settings() {
 	Options::AddDefault( "options/development/ships-worldmap", 0 );
 	Options::AddDefault( "options/development/debug-ai", 0 );
 	Options::AddDefault( "options/development/debug-ui", 0 );
+	Options::AddDefault( "options/development/profiler", 0 ); // 1 times each phase of every frame from the start
+	Options::AddDefault( "options/development/profiler-frames", 300 ); // frames remembered by the profiler
+	Options::AddDefault( "options/development/ai-profiler", 0 ); // 1 measures each AI state and Mission function from the start
+	Options::AddDefault( "options/development/ai-profile-file", "ai-profile.csv" ); // where those costs are saved on exit
 
 	// Allow the Options to be used
 	Options::Unlock();
@@ -236,6 +264,7 @@ void Main_Init_Singletons() {
  */
 void Main_Close_Singletons( void ) {
 	Options::Save();
+	ScriptProfiler::Save();
 
 	// free the main font files
 	delete SansSerif;
@@ -253,6 +282,29 @@ void Main_Close_Singletons( void ) {
 	Log::Instance().Close();
 }
 
+/** \details
+ *  Runs the Simulation for headlessTicks as fast as possible and prints how
+ *  fast it was.  Nothing that needs a display, audio or the UI is touched, so
+ *  this works on machines without any of them.  The options are not saved.
+ *  \return 0 if the Simulation ran, 1 otherwise
+ */
+int Main_Headless( void ) {
+	if( !Video::InitializeHeadless() ) {
+		return( 1 );
+	}
+	Timer::Initialize();
+	srand ( time(NULL) );
+
+	bool ran = Menu::Headless( headlessSimulation, headlessTicks );
+
+	LogMsg(INFO, "Epiar shutting down." );
+	ScriptProfiler::Save();
+	Filesystem::Close();
+	Log::Instance().Close();
+
+	return( ran ? 0 : 1 );
+}
+
 /** \details
  *  This processes all of the command line arguments using the ArgParser. As a
  *  general rule there are two kinds of Arguments:
@@ -284,6 +336,9 @@ void Main_Parse_Args( int argc, char **argv ) {
 	argparser->SetOpt(VALUEOPT, "log-msg",       "Filter log messages by string content.");
 
 	argparser->SetOpt(LONGOPT, "restore-defaults", "Restore options to default values.");
+	argparser->SetOpt(LONGOPT, "headless",       "Run the simulation without a display and print how fast it ran.");
+	argparser->SetOpt(VALUEOPT, "ticks",         "Number of ticks to run a headless simulation. (Default 1000)");
+	argparser->SetOpt(VALUEOPT, "simulation",    "Simulation to run headless. (Default 'default')");
 
 #ifdef EPIAR_COMPILE_TESTS
 	argparser->SetOpt(VALUEOPT, "run-test",      "Run specified test");
@@ -348,6 +403,19 @@ void Main_Parse_Args( int argc, char **argv ) {
 	if("" != msgfilt) Log::Instance().SetMsgFilter(msgfilt);
 	if("" != loglvl)  Log::Instance().SetLevel( loglvl );
 
+	if ( argparser->HaveLong("headless") ) {
+		string ticks = argparser->HaveValue("ticks");
+		string simulation = argparser->HaveValue("simulation");
+		headlessTicks = ticks.empty() ? 1000 : convertTo<Uint32>( ticks );
+		if( headlessTicks == 0 ) {
+			printf("\nThe number of ticks must be a positive number.\n" );
+			exit( 1 );
+		}
+		if( !simulation.empty() ) {
+			headlessSimulation = simulation;
+		}
+	}
+
 	// Print unused options.
 	list<string> unused = argparser->GetUnused();
 	list<string>::iterator it;
@@ -122,6 +122,26 @@ bool Menu::AutoLoad()
 	return false;
 }
 
+/** Run a Simulation without a display to measure how fast it is
+ * \note Only the Timer and a headless Video need to be initialized.
+ * \returns true if the Simulation ran.
+ */
+bool Menu::Headless( string simName, Uint32 ticks )
+{
+	LogMsg(INFO,"Running the Simulation '%s' for %u ticks without a display.", simName.c_str(), ticks );
+	if( !simulation.Load( simName ) )
+	{
+		LogMsg(ERR,"Failed to load the Simulation '%s' successfully", simName.c_str() );
+		return false;
+	}
+	if( !simulation.SetupToRun() )
+	{
+		LogMsg(ERR,"Failed to setup the Simulation '%s' successfully.", simName.c_str() );
+		return false;
+	}
+	return simulation.RunHeadless( ticks );
+}
+
 /** Create the Basic Main Menu
  *  \details The Splash Screen is random.
  */
@@ -17,6 +17,7 @@
 class Menu {
 	public:
 	static void Main_Menu( void ); // Run the Main Menu
+	static bool Headless( string simName, Uint32 ticks ); // Run a Simulation without a display
 
 	private:
 	static bool quitSignal;